@@ -52,6 +52,57 @@ private Q_SLOTS:
         QCOMPARE(vac.rawData(), readFile(u"divoc/partial-vaccination.bin"));
         QCOMPARE(KHealthCertificate::relevantUntil(vac), QDateTime({2022, 7, 16}, {0, 0}));
     }
+
+    void testArchive()
+    {
+        // uncompressed, additional entries and a different file name for the credential
+        const auto data = readFile(u"divoc/partial-vaccination-stored.bin");
+        auto cert = KHealthCertificateParser::parse(data);
+        QCOMPARE(cert.userType(), qMetaTypeId<KVaccinationCertificate>());
+        auto vac = cert.value<KVaccinationCertificate>();
+        QCOMPARE(vac.name(), QLatin1String("Katie Dragon"));
+        QCOMPARE(vac.certificateId(), QLatin1String("987654321098"));
+        QCOMPARE(vac.rawData(), data);
+
+        // truncated or corrupted archives
+        const auto deflated = readFile(u"divoc/partial-vaccination.bin");
+        QVERIFY(KHealthCertificateParser::parse(deflated.left(deflated.size() - 1)).isNull());
+        QVERIFY(KHealthCertificateParser::parse(deflated.left(deflated.size() / 2)).isNull());
+        auto corrupted = deflated;
+        corrupted[100] = ~corrupted[100];
+        QVERIFY(KHealthCertificateParser::parse(corrupted).isNull());
+    }
+
+    void testParseLimits()
+    {
+        const auto data = readFile(u"divoc/partial-vaccination.bin");
+        KHealthCertificateParser::ParseLimits limits;
+        KHealthCertificateParser::ParseOutcome outcome;
+        auto cert = KHealthCertificateParser::parse(data, limits, &outcome);
+        QCOMPARE(cert.userType(), qMetaTypeId<KVaccinationCertificate>());
+        QVERIFY(outcome == KHealthCertificateParser::ParseOutcome::Success);
+
+        limits.maximumInputSize = data.size() - 1;
+        cert = KHealthCertificateParser::parse(data, limits, &outcome);
+        QVERIFY(cert.isNull());
+        QVERIFY(outcome == KHealthCertificateParser::ParseOutcome::LimitExceeded);
+
+        limits = {};
+        limits.maximumDecompressedSize = 1024;
+        cert = KHealthCertificateParser::parse(data, limits, &outcome);
+        QVERIFY(cert.isNull());
+        QVERIFY(outcome == KHealthCertificateParser::ParseOutcome::LimitExceeded);
+
+        limits = {};
+        limits.maximumRdfQuadCount = 8;
+        cert = KHealthCertificateParser::parse(data, limits, &outcome);
+        QVERIFY(cert.isNull());
+        QVERIFY(outcome == KHealthCertificateParser::ParseOutcome::LimitExceeded);
+
+        cert = KHealthCertificateParser::parse("not a certificate", {}, &outcome);
+        QVERIFY(cert.isNull());
+        QVERIFY(outcome == KHealthCertificateParser::ParseOutcome::UnsupportedInput);
+    }
 };
 
 QTEST_APPLESS_MAIN(DivocParserTest)
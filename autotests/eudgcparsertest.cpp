@@ -5,9 +5,12 @@
 */
 
 #include <QFile>
+#include <QStandardPaths>
 #include <QTest>
 
+#include <KHealthCertificateMetrics>
 #include <KHealthCertificateParser>
+#include <KHealthCertificateParserSession>
 #include <KRecoveryCertificate>
 #include <KTestCertificate>
 #include <KVaccinationCertificate>
@@ -24,6 +27,11 @@ class EuDgcParserTest : public QObject
 {
     Q_OBJECT
 private:
+    static QString verificationCacheFile()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/khealthcertificate/verification-cache");
+    }
+
     QByteArray readFile(QStringView fileName) const
     {
         QFile f(QLatin1String(SOURCE_DIR "/data/") + fileName);
@@ -34,6 +42,13 @@ private:
     }
 
 private Q_SLOTS:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        // start without any previous verification results
+        QFile::remove(verificationCacheFile());
+    }
+
     void testVaccinationCertificate()
     {
         auto cert = KHealthCertificateParser::parse(readFile(u"eu-dgc/full-vaccination.txt"));
@@ -152,6 +167,112 @@ private Q_SLOTS:
         QCOMPARE(test.rawData(), readFile(u"eu-dgc/recovery.txt"));
         QCOMPARE(KHealthCertificate::relevantUntil(test), QDateTime({2021, 6, 15}, {}));
     }
+
+    void testTypedResult()
+    {
+        const auto cert = KHealthCertificateParser::parseCertificate(readFile(u"eu-dgc/recovery.txt"));
+        QVERIFY(std::holds_alternative<KRecoveryCertificate>(cert));
+        const auto &rec = std::get<KRecoveryCertificate>(cert);
+        QCOMPARE(rec.name(), QLatin1String("Erika Mustermann"));
+        QCOMPARE(rec.signatureState(), KHealthCertificate::ValidSignature);
+        QCOMPARE(KHealthCertificate::relevantUntil(rec), QDateTime({2021, 6, 15}, {}));
+
+        const auto var = KHealthCertificateParser::toVariant(cert);
+        QCOMPARE(var.userType(), qMetaTypeId<KRecoveryCertificate>());
+        QCOMPARE(var.value<KRecoveryCertificate>().rawData(), rec.rawData());
+
+        KHealthCertificateParser::ParseOutcome outcome = KHealthCertificateParser::ParseOutcome::Success;
+        const auto invalid = KHealthCertificateParser::parseCertificate("HC1:NCFOXN", {}, &outcome);
+        QVERIFY(std::holds_alternative<std::monostate>(invalid));
+        QCOMPARE(outcome, KHealthCertificateParser::ParseOutcome::UnsupportedInput);
+        QVERIFY(KHealthCertificateParser::toVariant(invalid).isNull());
+    }
+
+    void testSession()
+    {
+        KHealthCertificateParserSession session;
+        const auto vacCert = KHealthCertificateParser::parse(session, readFile(u"eu-dgc/full-vaccination.txt"));
+        QCOMPARE(vacCert.userType(), qMetaTypeId<KVaccinationCertificate>());
+
+        // results of previous parse operations must not be affected by reusing the session
+        KHealthCertificateParser::ParseOutcome outcome = KHealthCertificateParser::ParseOutcome::UnsupportedInput;
+        const auto testCert = KHealthCertificateParser::parse(session, readFile(u"eu-dgc/negative-test.txt"), &outcome);
+        QCOMPARE(outcome, KHealthCertificateParser::ParseOutcome::Success);
+        QCOMPARE(testCert.userType(), qMetaTypeId<KTestCertificate>());
+        const auto recCert = KHealthCertificateParser::parse(session, readFile(u"eu-dgc/recovery.txt"));
+        QCOMPARE(recCert.userType(), qMetaTypeId<KRecoveryCertificate>());
+
+        const auto vac = vacCert.value<KVaccinationCertificate>();
+        QCOMPARE(vac.name(), QLatin1String("Erika Mustermann"));
+        QCOMPARE(vac.dose(), 2);
+        QCOMPARE(vac.signatureState(), KHealthCertificate::ValidSignature);
+        QCOMPARE(vac.rawData(), readFile(u"eu-dgc/full-vaccination.txt"));
+        const auto test = testCert.value<KTestCertificate>();
+        QCOMPARE(test.result(), KTestCertificate::Negative);
+        QCOMPARE(test.signatureState(), KHealthCertificate::ValidSignature);
+        QCOMPARE(recCert.value<KRecoveryCertificate>().dateOfPositiveTest(), QDate(2021, 1, 10));
+
+        // invalid input doesn't break the session for subsequent use
+        QVERIFY(KHealthCertificateParser::parse(session, "HC1:NCFOXN").isNull());
+        QCOMPARE(KHealthCertificateParser::parse(session, readFile(u"eu-dgc/full-vaccination.txt")).value<KVaccinationCertificate>().certificateId(), vac.certificateId());
+
+        // limits of the session apply
+        KHealthCertificateParser::ParseLimits limits;
+        limits.maximumDecompressedSize = 16;
+        KHealthCertificateParserSession limitedSession(limits);
+        QVERIFY(KHealthCertificateParser::parse(limitedSession, readFile(u"eu-dgc/full-vaccination.txt"), &outcome).isNull());
+        QCOMPARE(outcome, KHealthCertificateParser::ParseOutcome::LimitExceeded);
+    }
+
+    void testInternedValues()
+    {
+        const auto vac1 = KHealthCertificateParser::parse(readFile(u"eu-dgc/full-vaccination.txt")).value<KVaccinationCertificate>();
+        const auto vac2 = KHealthCertificateParser::parse(readFile(u"eu-dgc/partial-vaccination.txt")).value<KVaccinationCertificate>();
+        QCOMPARE(vac1.vaccine(), vac2.vaccine());
+        QCOMPARE(vac1.country(), vac2.country());
+
+        // repeated field values share their data
+        QCOMPARE(vac1.vaccine().constData(), vac2.vaccine().constData());
+        QCOMPARE(vac1.manufacturer().constData(), vac2.manufacturer().constData());
+        QCOMPARE(vac1.disease().constData(), vac2.disease().constData());
+        QCOMPARE(vac1.country().constData(), vac2.country().constData());
+        // free text and personal data isn't pooled
+        QCOMPARE(vac1.certificateIssuer(), vac2.certificateIssuer());
+        QVERIFY(vac1.certificateIssuer().constData() != vac2.certificateIssuer().constData());
+        QCOMPARE(vac1.name(), vac2.name());
+        QVERIFY(vac1.name().constData() != vac2.name().constData());
+    }
+
+    void testVerificationCache()
+    {
+        const auto data = readFile(u"eu-dgc/full-vaccination.txt");
+        auto before = KHealthCertificateMetrics::snapshot();
+        QCOMPARE(KHealthCertificateParser::parse(data).value<KVaccinationCertificate>().signatureState(), KHealthCertificate::ValidSignature);
+        auto after = KHealthCertificateMetrics::snapshot();
+        QCOMPARE(after.verificationCacheHits + after.verificationCacheMisses - before.verificationCacheHits - before.verificationCacheMisses, 1ull);
+
+        // the result is reused and persisted
+        before = after;
+        QCOMPARE(KHealthCertificateParser::parse(data).value<KVaccinationCertificate>().signatureState(), KHealthCertificate::ValidSignature);
+        after = KHealthCertificateMetrics::snapshot();
+        QCOMPARE(after.verificationCacheHits - before.verificationCacheHits, 1ull);
+        QCOMPARE(after.verificationCacheMisses - before.verificationCacheMisses, 0ull);
+        QFile cacheFile(verificationCacheFile());
+        QVERIFY(cacheFile.exists());
+        QVERIFY(cacheFile.size() >= 4 + 32 + 32);
+
+        // verification results are only reused for identical input
+        auto modified = data;
+        modified[modified.size() - 5] = modified[modified.size() - 5] == 'A' ? 'B' : 'A';
+        QVERIFY(KHealthCertificateParser::parse(modified).value<KVaccinationCertificate>().signatureState() != KHealthCertificate::ValidSignature);
+
+        // cache hits still count against the crypto operation limit
+        KHealthCertificateParser::ParseLimits limits;
+        limits.maximumCryptoOperations = 0;
+        KHealthCertificateParser::ParseOutcome outcome = KHealthCertificateParser::ParseOutcome::Success;
+        KHealthCertificateParser::parseCertificate(data, limits, &outcome);
+        QCOMPARE(outcome, KHealthCertificateParser::ParseOutcome::LimitExceeded);
+    }
 };
 
 QTEST_GUILESS_MAIN(EuDgcParserTest)
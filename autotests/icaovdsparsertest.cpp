@@ -78,6 +78,58 @@ private Q_SLOTS:
         QCOMPARE(vac.rawData(), QJsonDocument::fromJson(readFile(u"icao/jpn-triple-vaccine.txt")).toJson(QJsonDocument::Compact));
     }
 
+    void testCanonicalization()
+    {
+        // signed content in non-canonical form: different member order, escapes and number formatting
+        auto data = readFile(u"icao/jpn-triple-vaccine.txt");
+        const auto hdrBegin = data.indexOf("\"is\"");
+        const auto hdrEnd = data.indexOf('}', hdrBegin);
+        QVERIFY(hdrBegin > 0 && hdrEnd > hdrBegin);
+        data.replace(hdrBegin, hdrEnd - hdrBegin, R"("v" : 1.0E0, "t":"icao\u002evacc",   "is": "\u004aPN")");
+
+        auto cert = KHealthCertificateParser::parse(data);
+        QCOMPARE(cert.userType(), qMetaTypeId<KVaccinationCertificate>());
+        auto vac = cert.value<KVaccinationCertificate>();
+        QCOMPARE(vac.name(), QLatin1String("MIYAKE SHOTA"));
+        QCOMPARE(vac.signatureState(), KHealthCertificate::ValidSignature);
+
+        // modified content
+        data.replace("MIYAKE", "MIYAKO");
+        cert = KHealthCertificateParser::parse(data);
+        QCOMPARE(cert.value<KVaccinationCertificate>().signatureState(), KHealthCertificate::InvalidSignature);
+    }
+
+    void testAmbiguousSignedContent()
+    {
+        const auto data = readFile(u"icao/jpn-triple-vaccine.txt");
+        const auto dataBegin = data.indexOf("\"data\"");
+        const auto sigBegin = data.indexOf("\"sig\"");
+        QVERIFY(dataBegin > 0 && sigBegin > dataBegin);
+        const auto signedMember = data.mid(dataBegin, sigBegin - dataBegin);
+        auto forgedMember = signedMember;
+        forgedMember.replace("MIYAKE", "MIYAKO");
+
+        // escaped member name next to the signed one
+        auto escapedForged = forgedMember;
+        escapedForged.replace("\"data\"", "\"d\\u0061ta\"");
+        const QByteArray escapedNames[] = { escapedForged + signedMember, signedMember + escapedForged };
+        for (const auto &forged : escapedNames) {
+            auto modified = data;
+            modified.replace(dataBegin, sigBegin - dataBegin, forged);
+            const auto cert = KHealthCertificateParser::parse(modified);
+            QVERIFY(cert.value<KVaccinationCertificate>().signatureState() != KHealthCertificate::ValidSignature);
+        }
+
+        // duplicated member name
+        const QByteArray duplicatedNames[] = { forgedMember + signedMember, signedMember + forgedMember };
+        for (const auto &forged : duplicatedNames) {
+            auto modified = data;
+            modified.replace(dataBegin, sigBegin - dataBegin, forged);
+            const auto cert = KHealthCertificateParser::parse(modified);
+            QVERIFY(cert.value<KVaccinationCertificate>().signatureState() != KHealthCertificate::ValidSignature);
+        }
+    }
+
     void testTestCertificate()
     {
         auto cert = KHealthCertificateParser::parse(readFile(u"icao/test.txt"));
@@ -97,6 +149,28 @@ private Q_SLOTS:
         QCOMPARE(test.signatureState(), KHealthCertificate::InvalidSignature);
         QCOMPARE(test.rawData(), readFile(u"icao/test.txt"));
     }
+
+    void testParseLimits()
+    {
+        const auto data = readFile(u"icao/jpn-triple-vaccine.txt");
+        KHealthCertificateParser::ParseLimits limits;
+        KHealthCertificateParser::ParseOutcome outcome;
+        auto cert = KHealthCertificateParser::parse(data, limits, &outcome);
+        QCOMPARE(cert.userType(), qMetaTypeId<KVaccinationCertificate>());
+        QCOMPARE(cert.value<KVaccinationCertificate>().signatureState(), KHealthCertificate::ValidSignature);
+        QVERIFY(outcome == KHealthCertificateParser::ParseOutcome::Success);
+
+        limits.maximumCryptoOperations = 0;
+        cert = KHealthCertificateParser::parse(data, limits, &outcome);
+        QVERIFY(cert.isNull());
+        QVERIFY(outcome == KHealthCertificateParser::ParseOutcome::LimitExceeded);
+
+        limits = {};
+        limits.maximumNestingDepth = 2;
+        cert = KHealthCertificateParser::parse(data, limits, &outcome);
+        QVERIFY(cert.isNull());
+        QVERIFY(outcome == KHealthCertificateParser::ParseOutcome::LimitExceeded);
+    }
 };
 
 QTEST_APPLESS_MAIN(IcaoVdsParserTest)
@@ -0,0 +1,110 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include <QAbstractItemModelTester>
+#include <QFile>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <KHealthCertificate>
+#include <KHealthCertificateModel>
+#include <KTestCertificate>
+#include <KVaccinationCertificate>
+
+void initLocale()
+{
+    qputenv("LC_ALL", "en_US.utf-8");
+    qputenv("TZ", "UTC");
+}
+
+Q_CONSTRUCTOR_FUNCTION(initLocale)
+
+class KHealthCertificateModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    static QString verificationCacheFile()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/khealthcertificate/verification-cache");
+    }
+
+    QByteArray readFile(QStringView fileName) const
+    {
+        QFile f(QLatin1String(SOURCE_DIR "/data/") + fileName);
+        if (!f.open(QFile::ReadOnly)) {
+            qCritical() << f.errorString() << f.fileName();
+        }
+        return f.readAll();
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        QFile::remove(verificationCacheFile());
+    }
+
+    void testModel()
+    {
+        KHealthCertificateModel model;
+        QAbstractItemModelTester modelTester(&model);
+        QSignalSpy loadingSpy(&model, &KHealthCertificateModel::loadingChanged);
+        QSignalSpy dataChangedSpy(&model, &QAbstractItemModel::dataChanged);
+
+        model.addCertificates({
+            readFile(u"eu-dgc/negative-test.txt"),
+            "not a certificate",
+            readFile(u"eu-dgc/full-vaccination.txt"),
+            readFile(u"eu-dgc/recovery.txt"),
+        });
+        QVERIFY(model.isLoading());
+        QCOMPARE(loadingSpy.size(), 1);
+
+        QVERIFY(loadingSpy.wait());
+        QVERIFY(!model.isLoading());
+        QCOMPARE(model.rowCount(), 3);
+
+        // most relevant first
+        QCOMPARE(model.index(0, 0).data(KHealthCertificateModel::CertificateTypeRole).value<KHealthCertificate::CertificateType>(), KHealthCertificate::Vaccination);
+        QCOMPARE(model.index(0, 0).data(KHealthCertificateModel::RelevantUntilRole).toDateTime(), QDateTime({2022, 1, 28}, {7, 47, 53}));
+        QCOMPARE(model.index(1, 0).data(KHealthCertificateModel::CertificateTypeRole).value<KHealthCertificate::CertificateType>(), KHealthCertificate::Recovery);
+        QCOMPARE(model.index(2, 0).data(KHealthCertificateModel::CertificateTypeRole).value<KHealthCertificate::CertificateType>(), KHealthCertificate::Test);
+        QCOMPARE(model.index(2, 0).data(Qt::DisplayRole).toString(), QLatin1String("Erika Mustermann"));
+        QCOMPARE(model.index(2, 0).data(KHealthCertificateModel::RawDataRole).toByteArray(), readFile(u"eu-dgc/negative-test.txt"));
+        QCOMPARE(model.index(2, 0).data(KHealthCertificateModel::CertificateRole).userType(), qMetaTypeId<KTestCertificate>());
+
+        // signatures are verified afterwards
+        QTRY_COMPARE(dataChangedSpy.size(), 3);
+        for (int i = 0; i < model.rowCount(); ++i) {
+            QCOMPARE(model.index(i, 0).data(KHealthCertificateModel::SignatureStateRole).value<KHealthCertificate::SignatureValidation>(), KHealthCertificate::ValidSignature);
+        }
+        QCOMPARE(model.index(0, 0).data(KHealthCertificateModel::CertificateRole).value<KVaccinationCertificate>().signatureState(), KHealthCertificate::ValidSignature);
+
+        model.removeCertificate(1);
+        QCOMPARE(model.rowCount(), 2);
+        model.clear();
+        QCOMPARE(model.rowCount(), 0);
+
+        // removing certificates still being processed
+        QSignalSpy rowsInsertedSpy(&model, &QAbstractItemModel::rowsInserted);
+        model.addCertificate(readFile(u"eu-dgc/full-vaccination.txt"));
+        model.clear();
+        QVERIFY(!model.isLoading());
+        QCOMPARE(model.rowCount(), 0);
+
+        // the discarded job was queued before this one, so its result would have arrived before this one is fully processed
+        dataChangedSpy.clear();
+        model.addCertificate(readFile(u"eu-dgc/negative-test.txt"));
+        QVERIFY(dataChangedSpy.wait());
+        QCOMPARE(rowsInsertedSpy.size(), 1);
+        QCOMPARE(model.rowCount(), 1);
+        QCOMPARE(model.index(0, 0).data(KHealthCertificateModel::CertificateTypeRole).value<KHealthCertificate::CertificateType>(), KHealthCertificate::Test);
+    }
+};
+
+QTEST_GUILESS_MAIN(KHealthCertificateModelTest)
+
+#include "khealthcertificatemodeltest.moc"
@@ -0,0 +1,246 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <KHealthCertificateParser>
+#include <KHealthCertificateSerializer>
+#include <KHealthCertificateStore>
+#include <KRecoveryCertificate>
+#include <KTestCertificate>
+#include <KVaccinationCertificate>
+
+void initLocale()
+{
+    qputenv("LC_ALL", "en_US.utf-8");
+    qputenv("TZ", "UTC");
+}
+
+Q_CONSTRUCTOR_FUNCTION(initLocale)
+
+class KHealthCertificateStoreTest : public QObject
+{
+    Q_OBJECT
+private:
+    static QString verificationCacheFile()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/khealthcertificate/verification-cache");
+    }
+
+    QByteArray readFile(QStringView fileName) const
+    {
+        QFile f(QLatin1String(SOURCE_DIR "/data/") + fileName);
+        if (!f.open(QFile::ReadOnly)) {
+            qCritical() << f.errorString() << f.fileName();
+        }
+        return f.readAll();
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        QFile::remove(verificationCacheFile());
+    }
+
+    void testSerializer()
+    {
+        const auto vacCert = KHealthCertificateParser::parseCertificate(readFile(u"eu-dgc/full-vaccination.txt"));
+        QVERIFY(std::holds_alternative<KVaccinationCertificate>(vacCert));
+        auto data = KHealthCertificateSerializer::serialize(vacCert);
+        QVERIFY(!data.isEmpty());
+
+        QByteArray trustStoreVersion;
+        auto cert = KHealthCertificateSerializer::deserialize(data, &trustStoreVersion);
+        QCOMPARE(trustStoreVersion, KHealthCertificateParser::trustStoreVersion());
+        QVERIFY(std::holds_alternative<KVaccinationCertificate>(cert));
+        const auto &vacIn = std::get<KVaccinationCertificate>(vacCert);
+        const auto &vac = std::get<KVaccinationCertificate>(cert);
+        QCOMPARE(vac.name(), vacIn.name());
+        QCOMPARE(vac.dateOfBirth(), vacIn.dateOfBirth());
+        QCOMPARE(vac.date(), vacIn.date());
+        QCOMPARE(vac.disease(), vacIn.disease());
+        QCOMPARE(vac.vaccineType(), vacIn.vaccineType());
+        QCOMPARE(vac.vaccine(), vacIn.vaccine());
+        QCOMPARE(vac.vaccineUrl(), vacIn.vaccineUrl());
+        QCOMPARE(vac.manufacturer(), vacIn.manufacturer());
+        QCOMPARE(vac.dose(), 2);
+        QCOMPARE(vac.totalDoses(), 2);
+        QCOMPARE(vac.country(), QLatin1String("DE"));
+        QCOMPARE(vac.certificateIssuer(), vacIn.certificateIssuer());
+        QCOMPARE(vac.certificateId(), vacIn.certificateId());
+        QCOMPARE(vac.certificateIssueDate(), QDateTime({2021, 5, 29}, {19, 21, 13}));
+        QCOMPARE(vac.certificateExpiryDate(), QDateTime({2022, 1, 28}, {7, 47, 53}));
+        QCOMPARE(vac.signatureState(), KHealthCertificate::ValidSignature);
+        QCOMPARE(vac.rawData(), readFile(u"eu-dgc/full-vaccination.txt"));
+
+        const auto testCert = KHealthCertificateParser::parseCertificate(readFile(u"eu-dgc/negative-test.txt"));
+        cert = KHealthCertificateSerializer::deserialize(KHealthCertificateSerializer::serialize(testCert));
+        QVERIFY(std::holds_alternative<KTestCertificate>(cert));
+        const auto &testIn = std::get<KTestCertificate>(testCert);
+        const auto &test = std::get<KTestCertificate>(cert);
+        QCOMPARE(test.testType(), testIn.testType());
+        QCOMPARE(test.testName(), testIn.testName());
+        QCOMPARE(test.testUrl(), testIn.testUrl());
+        QCOMPARE(test.result(), KTestCertificate::Negative);
+        QCOMPARE(test.resultString(), testIn.resultString());
+        QCOMPARE(test.testCenter(), testIn.testCenter());
+        QCOMPARE(test.date(), testIn.date());
+        QCOMPARE(test.signatureState(), KHealthCertificate::ValidSignature);
+
+        const auto recCert = KHealthCertificateParser::parseCertificate(readFile(u"eu-dgc/recovery.txt"));
+        cert = KHealthCertificateSerializer::deserialize(KHealthCertificateSerializer::serialize(recCert));
+        QVERIFY(std::holds_alternative<KRecoveryCertificate>(cert));
+        const auto &rec = std::get<KRecoveryCertificate>(cert);
+        QCOMPARE(rec.dateOfPositiveTest(), QDate(2021, 1, 10));
+        QCOMPARE(rec.validFrom(), std::get<KRecoveryCertificate>(recCert).validFrom());
+        QCOMPARE(rec.validUntil(), std::get<KRecoveryCertificate>(recCert).validUntil());
+
+        // invalid input
+        QVERIFY(KHealthCertificateSerializer::serialize(std::monostate()).isEmpty());
+        QVERIFY(std::holds_alternative<std::monostate>(KHealthCertificateSerializer::deserialize({})));
+        QVERIFY(std::holds_alternative<std::monostate>(KHealthCertificateSerializer::deserialize("garbage")));
+        data.chop(16);
+        QVERIFY(std::holds_alternative<std::monostate>(KHealthCertificateSerializer::deserialize(data)));
+    }
+
+    void testStore()
+    {
+        QTemporaryDir dir;
+        const auto fileName = dir.filePath(QStringLiteral("wallet"));
+        const auto vacData = readFile(u"eu-dgc/full-vaccination.txt");
+        const auto testData = readFile(u"eu-dgc/negative-test.txt");
+        const auto recData = readFile(u"eu-dgc/recovery.txt");
+
+        {
+            KHealthCertificateStore store(fileName);
+            QVERIFY(store.open());
+            QCOMPARE(store.count(), 0);
+            QVERIFY(std::holds_alternative<KVaccinationCertificate>(store.addRawData(vacData)));
+            QVERIFY(store.add(KHealthCertificateParser::parseCertificate(testData)));
+            QVERIFY(std::holds_alternative<KRecoveryCertificate>(store.addRawData(recData)));
+            QCOMPARE(store.count(), 3);
+
+            // duplicates are ignored
+            QVERIFY(std::holds_alternative<KVaccinationCertificate>(store.addRawData(vacData)));
+            QCOMPARE(store.count(), 3);
+            // invalid input is rejected
+            QVERIFY(std::holds_alternative<std::monostate>(store.addRawData("HC1:NCFOXN")));
+            QVERIFY(!store.add(std::monostate()));
+            QCOMPARE(store.count(), 3);
+            QCOMPARE(store.refresh(), 0);
+        }
+
+        {
+            KHealthCertificateStore store(fileName);
+            QVERIFY(store.open());
+            QCOMPARE(store.count(), 3);
+            QVERIFY(std::holds_alternative<KVaccinationCertificate>(store.certificate(0)));
+            QVERIFY(std::holds_alternative<KTestCertificate>(store.certificate(1)));
+            QVERIFY(std::holds_alternative<KRecoveryCertificate>(store.certificate(2)));
+            QVERIFY(std::holds_alternative<std::monostate>(store.certificate(3)));
+
+            const auto cert = store.findByRawData(testData);
+            QVERIFY(std::holds_alternative<KTestCertificate>(cert));
+            QCOMPARE(std::get<KTestCertificate>(cert).signatureState(), KHealthCertificate::ValidSignature);
+            QCOMPARE(std::get<KTestCertificate>(cert).rawData(), testData);
+
+            const auto recId = std::get<KRecoveryCertificate>(store.certificate(2)).certificateId();
+            QVERIFY(std::holds_alternative<KRecoveryCertificate>(store.findByCertificateId(recId)));
+            QVERIFY(std::holds_alternative<std::monostate>(store.findByCertificateId(QStringLiteral("URN:UVCI:unknown"))));
+
+            QVERIFY(store.remove(1));
+            QCOMPARE(store.count(), 2);
+            QVERIFY(std::holds_alternative<std::monostate>(store.findByRawData(testData)));
+        }
+
+        // simulate an interrupted write
+        {
+            QFile f(fileName);
+            QVERIFY(f.open(QFile::Append));
+            f.write("\x80\0\0\0\0", 5);
+        }
+
+        {
+            KHealthCertificateStore store(fileName);
+            QVERIFY(store.open());
+            QCOMPARE(store.count(), 2);
+            QVERIFY(std::holds_alternative<KVaccinationCertificate>(store.certificate(0)));
+            QVERIFY(std::holds_alternative<KRecoveryCertificate>(store.certificate(1)));
+            QVERIFY(std::holds_alternative<std::monostate>(store.findByRawData(testData)));
+            QVERIFY(std::holds_alternative<KTestCertificate>(store.addRawData(testData)));
+            QCOMPARE(store.count(), 3);
+        }
+
+        // same for a corrupted size field pointing past the end of the file
+        {
+            const auto copyName = dir.filePath(QStringLiteral("wallet-size"));
+            QVERIFY(QFile::copy(fileName, copyName));
+            QFile f(copyName);
+            QVERIFY(f.open(QFile::ReadWrite));
+            QVERIFY(f.seek(8));
+            f.write("\0\0\x0f\0", 4);
+            f.close();
+            const auto size = QFileInfo(copyName).size();
+            KHealthCertificateStore store(copyName);
+            QVERIFY(!store.open());
+            QVERIFY(!store.errorString().isEmpty());
+            QCOMPARE(QFileInfo(copyName).size(), size);
+        }
+
+        // certificates not matching their raw data digest are ignored
+        {
+            const auto copyName = dir.filePath(QStringLiteral("wallet-digest"));
+            QVERIFY(QFile::copy(fileName, copyName));
+            QFile f(copyName);
+            QVERIFY(f.open(QFile::ReadWrite));
+            auto content = f.readAll();
+            const auto rawDataOffset = content.lastIndexOf(testData);
+            QVERIFY(rawDataOffset > 0);
+            content[rawDataOffset + testData.size() / 2] = content[rawDataOffset + testData.size() / 2] == 'A' ? 'B' : 'A';
+            QVERIFY(f.seek(0));
+            f.write(content);
+            f.close();
+            KHealthCertificateStore store(copyName);
+            QVERIFY(store.open());
+            QCOMPARE(store.count(), 3);
+            QVERIFY(std::holds_alternative<std::monostate>(store.findByRawData(testData)));
+            QVERIFY(std::holds_alternative<KVaccinationCertificate>(store.findByRawData(vacData)));
+        }
+
+        // corruption in the middle of the file doesn't discard the records behind it
+        {
+            QFile f(fileName);
+            QVERIFY(f.open(QFile::ReadWrite));
+            const auto size = f.size();
+            QVERIFY(f.seek(8));
+            f.write("\x08\0\0\0", 4);
+            f.close();
+            KHealthCertificateStore store(fileName);
+            QVERIFY(!store.open());
+            QVERIFY(!store.errorString().isEmpty());
+            QCOMPARE(store.count(), 0);
+            QCOMPARE(QFileInfo(fileName).size(), size);
+        }
+
+        // not a store file
+        {
+            QFile f(dir.filePath(QStringLiteral("garbage")));
+            QVERIFY(f.open(QFile::WriteOnly));
+            f.write("garbage");
+        }
+        KHealthCertificateStore store(dir.filePath(QStringLiteral("garbage")));
+        QVERIFY(!store.open());
+        QVERIFY(!store.errorString().isEmpty());
+    }
+};
+
+QTEST_GUILESS_MAIN(KHealthCertificateStoreTest)
+
+#include "khealthcertificatestoretest.moc"
@@ -51,6 +51,17 @@ private Q_SLOTS:
 
         QCOMPARE(KHealthCertificate::relevantUntil(t), QDateTime({2021, 7, 29}, {13, 0}, QTimeZone("Europe/Amsterdam")));
     }
+
+    void testParseLimits()
+    {
+        const auto data = readFile(u"nl-coronacheck/sample-one-day.txt");
+        KHealthCertificateParser::ParseLimits limits;
+        limits.maximumBignumDigits = 256;
+        KHealthCertificateParser::ParseOutcome outcome;
+        const auto cert = KHealthCertificateParser::parse(data, limits, &outcome);
+        QVERIFY(cert.isNull());
+        QVERIFY(outcome == KHealthCertificateParser::ParseOutcome::LimitExceeded);
+    }
 };
 
 QTEST_APPLESS_MAIN(NlCoronaCheckParserTest)
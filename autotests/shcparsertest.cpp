@@ -6,7 +6,10 @@
 #include <QFile>
 #include <QTest>
 
+#include <KHealthCertificateChunkAssembler>
+#include <KHealthCertificateMetrics>
 #include <KHealthCertificateParser>
+#include <KHealthCertificatePipeline>
 #include <KVaccinationCertificate>
 
 void initLocale()
@@ -52,6 +55,212 @@ private Q_SLOTS:
         QCOMPARE(vac.vaccinationState(), KVaccinationCertificate::Vaccinated);
         QCOMPARE(vac.rawData(), readFile(u"shc/example-00-f-qr-code-numeric-value-0.txt"));
     }
+
+    void testLargeBundle()
+    {
+        // unsigned SHC with a large number of immunizations, and members in unusual order
+        QByteArray entries = R"({"resource":{"name":[{"family":"Anyperson","given":["Jane","C."]}],"birthDate":"1960-01-20","resourceType":"Patient"}})";
+        for (int i = 0; i < 40; ++i) {
+            entries += R"(,{"fullUrl":"resource:)" + QByteArray::number(i + 1) + R"(","resource":{"vaccineCode":{"coding":[{"code":"207","system":"http://hl7.org/fhir/sid/cvx"}]},"occurrenceDateTime":")"
+                + QDate(2021, 1, 1).addDays(i).toString(Qt::ISODate).toUtf8() + R"(","status":"completed","lotNumber":"0000\"1","resourceType":"Immunization"}})";
+        }
+        const QByteArray payload = R"({"vc":{"credentialSubject":{"fhirBundle":{"entry":[)" + entries + R"(],"resourceType":"Bundle"},"fhirVersion":"4.0.1"},"type":["https://smarthealth.cards#health-card","https://smarthealth.cards#immunization"]},"nbf":1632261134,"iss":"https://example.org/issuer"})";
+        const QByteArray jws = QByteArray(R"({"alg":"ES256","kid":"none"})").toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals)
+            + '.' + payload.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals) + ".AAAA";
+
+        QByteArray data("shc:/");
+        for (const auto c : jws) {
+            data += QByteArray::number(c - 45).rightJustified(2, '0');
+        }
+
+        auto cert = KHealthCertificateParser::parse(data);
+        QCOMPARE(cert.userType(), qMetaTypeId<KVaccinationCertificate>());
+        auto vac = cert.value<KVaccinationCertificate>();
+        QCOMPARE(vac.name(), QLatin1String("Jane C. Anyperson"));
+        QCOMPARE(vac.dateOfBirth(), QDate(1960, 1, 20));
+        QCOMPARE(vac.dose(), 40);
+        QCOMPARE(vac.date(), QDate(2021, 2, 9));
+        QCOMPARE(vac.disease(), QLatin1String("COVID-19"));
+        QCOMPARE(vac.manufacturer(), QLatin1String("Moderna US, Inc."));
+        QCOMPARE(vac.certificateIssuer(), QLatin1String("https://example.org/issuer"));
+        QCOMPARE(vac.certificateIssueDate(), QDateTime::fromSecsSinceEpoch(1632261134));
+        QCOMPARE(vac.signatureState(), KHealthCertificate::UnknownSignature);
+
+        const auto before = KHealthCertificateMetrics::snapshot().formats[KHealthCertificatePipeline::SmartHealthCard];
+        KHealthCertificatePipeline pipeline(data);
+        QVERIFY(pipeline.verifySignature());
+        QCOMPARE(pipeline.diagnostics().stage, KHealthCertificatePipeline::SignatureVerification);
+        QCOMPARE(pipeline.diagnostics().reason, KHealthCertificatePipeline::UnknownSigningKey);
+        const auto after = KHealthCertificateMetrics::snapshot().formats[KHealthCertificatePipeline::SmartHealthCard];
+        QCOMPARE(after.signatureFailureReasons[KHealthCertificatePipeline::UnknownSigningKey] - before.signatureFailureReasons[KHealthCertificatePipeline::UnknownSigningKey], 1ull);
+        QCOMPARE(after.signatureFailureReasons[KHealthCertificatePipeline::UnsupportedSignatureAlgorithm] - before.signatureFailureReasons[KHealthCertificatePipeline::UnsupportedSignatureAlgorithm], 0ull);
+
+        // truncated payload
+        data.chop(200);
+        QVERIFY(KHealthCertificateParser::parse(data).isNull());
+    }
+
+    void testInvalidInput()
+    {
+        const auto data = readFile(u"shc/example-00-f-qr-code-numeric-value-0.txt");
+        QVERIFY(KHealthCertificateParser::parse(data.left(data.size() - 1)).isNull()); // odd number of digits
+        auto invalid = data;
+        invalid[100] = 'x';
+        QVERIFY(KHealthCertificateParser::parse(invalid).isNull());
+        invalid = data;
+        invalid[100] = '9'; // digit pair out of range
+        invalid[101] = '9';
+        QVERIFY(KHealthCertificateParser::parse(invalid).isNull());
+        QVERIFY(KHealthCertificateParser::parse("shc:/").isNull());
+    }
+
+    void testPipeline()
+    {
+        const auto data = readFile(u"shc/example-00-f-qr-code-numeric-value-0.txt");
+        KHealthCertificatePipeline pipeline(data);
+        QCOMPARE(pipeline.stage(), KHealthCertificatePipeline::NoStage);
+        QCOMPARE(pipeline.detectFormat(), KHealthCertificatePipeline::SmartHealthCard);
+        QCOMPARE(pipeline.stage(), KHealthCertificatePipeline::FormatDetection);
+
+        QVERIFY(pipeline.parseEnvelope());
+        QCOMPARE(pipeline.stage(), KHealthCertificatePipeline::EnvelopeParsing);
+        QVERIFY(pipeline.transportDecodedData().startsWith("eyJ"));
+        QCOMPARE(pipeline.decompressedData(), pipeline.transportDecodedData());
+        QVERIFY(pipeline.payload().startsWith("{"));
+        QCOMPARE(pipeline.keyId(), QByteArray("3Kfdg-XwP-7gXyywtUfUADwBumDOPKMQx-iELL11W9s"));
+        QVERIFY(pipeline.certificate().isNull());
+
+        QVERIFY(pipeline.mapPayload());
+        auto vac = pipeline.certificate().value<KVaccinationCertificate>();
+        QCOMPARE(vac.name(), QLatin1String("John B. Anyperson"));
+        QCOMPARE(vac.signatureState(), KHealthCertificate::UncheckedSignature);
+
+        QVERIFY(pipeline.verifySignature());
+        QCOMPARE(pipeline.stage(), KHealthCertificatePipeline::SignatureVerification);
+        QVERIFY(!pipeline.hasError());
+        QCOMPARE(pipeline.outcome(), KHealthCertificateParser::ParseOutcome::Success);
+        vac = pipeline.certificate().value<KVaccinationCertificate>();
+        QCOMPARE(vac.signatureState(), KHealthCertificate::ValidSignature);
+        QCOMPARE(vac.rawData(), data);
+        QCOMPARE(pipeline.diagnostics().stage, KHealthCertificatePipeline::NoStage);
+        QCOMPARE(pipeline.diagnostics().reason, KHealthCertificatePipeline::NoReason);
+
+        // failure stops processing at the failed stage
+        KHealthCertificatePipeline invalid(data.left(data.size() - 1));
+        QVERIFY(!invalid.verifySignature());
+        QVERIFY(invalid.hasError());
+        QCOMPARE(invalid.stage(), KHealthCertificatePipeline::FormatDetection);
+        QCOMPARE(invalid.outcome(), KHealthCertificateParser::ParseOutcome::UnsupportedInput);
+        QCOMPARE(invalid.diagnostics().stage, KHealthCertificatePipeline::TransportDecoding);
+        QCOMPARE(invalid.diagnostics().reason, KHealthCertificatePipeline::InvalidTransportEncoding);
+        QVERIFY(invalid.certificate().isNull());
+
+        KHealthCertificatePipeline unknown("not a certificate");
+        QVERIFY(!unknown.verifySignature());
+        QCOMPARE(unknown.diagnostics().stage, KHealthCertificatePipeline::FormatDetection);
+        QCOMPARE(unknown.diagnostics().reason, KHealthCertificatePipeline::UnrecognizedFormat);
+    }
+
+    void testMetrics()
+    {
+        const auto before = KHealthCertificateMetrics::snapshot().formats[KHealthCertificatePipeline::SmartHealthCard];
+        const auto data = readFile(u"shc/example-00-f-qr-code-numeric-value-0.txt");
+        QVERIFY(!KHealthCertificateParser::parse(data).isNull());
+        QVERIFY(KHealthCertificateParser::parse(data.left(data.size() - 1)).isNull());
+
+        const auto after = KHealthCertificateMetrics::snapshot().formats[KHealthCertificatePipeline::SmartHealthCard];
+        const auto &decodingBefore = before.stages[KHealthCertificatePipeline::TransportDecoding];
+        const auto &decodingAfter = after.stages[KHealthCertificatePipeline::TransportDecoding];
+        QCOMPARE(decodingAfter.count - decodingBefore.count, 2ull);
+        QCOMPARE(decodingAfter.failures - decodingBefore.failures, 1ull);
+        QCOMPARE(after.stages[KHealthCertificatePipeline::SignatureVerification].count - before.stages[KHealthCertificatePipeline::SignatureVerification].count, 1ull);
+        QVERIFY(after.stages[KHealthCertificatePipeline::SignatureVerification].latencyPercentile(0.99) > 0);
+        QCOMPARE(after.outcomes[int(KHealthCertificateParser::ParseOutcome::Success)] - before.outcomes[int(KHealthCertificateParser::ParseOutcome::Success)], 1ull);
+        QCOMPARE(after.outcomes[int(KHealthCertificateParser::ParseOutcome::UnsupportedInput)] - before.outcomes[int(KHealthCertificateParser::ParseOutcome::UnsupportedInput)], 1ull);
+        QCOMPARE(after.signatureStates[KHealthCertificate::ValidSignature] - before.signatureStates[KHealthCertificate::ValidSignature], 1ull);
+
+        // percentiles round up to the next sample
+        KHealthCertificateMetrics::StageStatistics stats;
+        stats.latencyHistogram[1] = 9;
+        stats.latencyHistogram[5] = 1;
+        QCOMPARE(stats.latencyPercentile(0.5), 2);
+        QCOMPARE(stats.latencyPercentile(0.9), 2);
+        QCOMPARE(stats.latencyPercentile(0.99), 32);
+        QCOMPARE(stats.latencyPercentile(1.0), 32);
+    }
+
+    void testChunkedCertificate()
+    {
+        const auto data = readFile(u"shc/example-00-f-qr-code-numeric-value-0.txt");
+        QVERIFY(!KHealthCertificateChunkAssembler::isChunk(data));
+
+        // split into three chunks, as done in the SHC spec examples
+        const auto numeric = data.mid(5);
+        const QByteArray chunks[] = {
+            "shc:/1/3/" + numeric.mid(0, 516),
+            "shc:/2/3/" + numeric.mid(516, 514),
+            "shc:/3/3/" + numeric.mid(1030),
+        };
+        for (const auto &chunk : chunks) {
+            QVERIFY(KHealthCertificateChunkAssembler::isChunk(chunk));
+            QVERIFY(KHealthCertificateParser::parse(chunk).isNull());
+        }
+        QVERIFY(!KHealthCertificateChunkAssembler::isChunk("shc:/4/3/1234"));
+        QVERIFY(!KHealthCertificateChunkAssembler::isChunk("shc:/0/3/1234"));
+
+        KHealthCertificateChunkAssembler assembler;
+        QCOMPARE(assembler.chunkCount(), 0);
+        QVERIFY(assembler.addChunk(chunks[2]).isNull());
+        QCOMPARE(assembler.chunkCount(), 3);
+        QCOMPARE(assembler.receivedChunkCount(), 1);
+        QVERIFY(assembler.addChunk(chunks[0]).isNull());
+        QVERIFY(assembler.addChunk(chunks[0]).isNull());
+        QCOMPARE(assembler.receivedChunkCount(), 2);
+
+        auto cert = assembler.addChunk(chunks[1]);
+        QCOMPARE(cert.userType(), qMetaTypeId<KVaccinationCertificate>());
+        QCOMPARE(assembler.chunkCount(), 0);
+        auto vac = cert.value<KVaccinationCertificate>();
+        QCOMPARE(vac.name(), QLatin1String("John B. Anyperson"));
+        QCOMPARE(vac.signatureState(), KHealthCertificate::ValidSignature);
+        QCOMPARE(vac.rawData(), data);
+
+        // non-chunked input is passed through
+        cert = assembler.addChunk(data);
+        QCOMPARE(cert.userType(), qMetaTypeId<KVaccinationCertificate>());
+
+        // conflicting content restarts the assembly
+        QVERIFY(assembler.addChunk(chunks[0]).isNull());
+        QVERIFY(assembler.addChunk(chunks[1]).isNull());
+        QVERIFY(assembler.addChunk("shc:/1/3/" + numeric.mid(2, 516)).isNull());
+        QCOMPARE(assembler.receivedChunkCount(), 1);
+        assembler.clear();
+        QCOMPARE(assembler.chunkCount(), 0);
+        QCOMPARE(assembler.receivedChunkCount(), 0);
+
+        // parse limits apply to each chunk and to the assembled certificate
+        KHealthCertificateParser::ParseLimits limits;
+        limits.maximumInputSize = 600;
+        KHealthCertificateChunkAssembler limitedAssembler(limits);
+        QVERIFY(limitedAssembler.addChunk(chunks[0]).isNull());
+        QCOMPARE(limitedAssembler.receivedChunkCount(), 1);
+        QVERIFY(limitedAssembler.addChunk(chunks[1]).isNull());
+        QCOMPARE(limitedAssembler.chunkCount(), 0);
+        QCOMPARE(limitedAssembler.receivedChunkCount(), 0);
+        limits.maximumInputSize = 100;
+        KHealthCertificateChunkAssembler tinyAssembler(limits);
+        QVERIFY(tinyAssembler.addChunk(chunks[0]).isNull());
+        QCOMPARE(tinyAssembler.receivedChunkCount(), 0);
+
+        // the assembled certificate goes through the regular processing pipeline
+        const auto before = KHealthCertificateMetrics::snapshot().formats[KHealthCertificatePipeline::SmartHealthCard];
+        for (const auto &chunk : chunks) {
+            cert = assembler.addChunk(chunk);
+        }
+        QCOMPARE(cert.userType(), qMetaTypeId<KVaccinationCertificate>());
+        const auto after = KHealthCertificateMetrics::snapshot().formats[KHealthCertificatePipeline::SmartHealthCard];
+        QCOMPARE(after.outcomes[int(KHealthCertificateParser::ParseOutcome::Success)] - before.outcomes[int(KHealthCertificateParser::ParseOutcome::Success)], 1ull);
+    }
 };
 
 QTEST_APPLESS_MAIN(ShcParserTest)
@@ -14,19 +14,16 @@
 
 #include <iostream>
 
-static void dumpGadget(const QVariant &gadget)
+template <typename T>
+static void dumpGadget(const T &gadget)
 {
-    const auto mo = QMetaType(gadget.userType()).metaObject();
-    if (!mo) {
-        return;
-    }
-
+    const auto mo = &T::staticMetaObject;
     for (auto i = 0; i < mo->propertyCount(); ++i) {
         const auto prop = mo->property(i);
         if (!prop.isStored()) {
             continue;
         }
-        const auto value = prop.readOnGadget(gadget.constData());
+        const auto value = prop.readOnGadget(&gadget);
         std::cout << " " << prop.name() << ": " << qPrintable(value.toString()) << std::endl;
     }
 }
@@ -38,20 +35,22 @@ int main(int argc, char **argv)
     QFile in;
     in.open(stdin, QFile::ReadOnly);
 
-    const auto cert = KHealthCertificateParser::parse(in.readAll());
-    if (cert.isNull()) {
+    const auto cert = KHealthCertificateParser::parseCertificate(in.readAll());
+    if (std::holds_alternative<std::monostate>(cert)) {
         std::cout << "unable to parse input" << std::endl;
         return 1;
     }
 
-    if (cert.userType() == qMetaTypeId<KVaccinationCertificate>()) {
+    if (const auto vac = std::get_if<KVaccinationCertificate>(&cert)) {
         std::cout << "Vaccination certificate:" << std::endl;
-    } else if (cert.userType() == qMetaTypeId<KTestCertificate>()) {
+        dumpGadget(*vac);
+    } else if (const auto test = std::get_if<KTestCertificate>(&cert)) {
         std::cout << "Test certificate:" << std::endl;
-    } else if (cert.userType() == qMetaTypeId<KRecoveryCertificate>()) {
+        dumpGadget(*test);
+    } else if (const auto rec = std::get_if<KRecoveryCertificate>(&cert)) {
         std::cout << "Recovery certificate:" << std::endl;
+        dumpGadget(*rec);
     }
-    dumpGadget(cert);
 
     return 0;
 }
@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "divockeyregistry_p.h"
+#include "logging.h"
+
+#include <QFile>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+
+// verification methods and issuers of known DIVOC deployments
+static struct {
+    const char *verificationMethod;
+    const char *issuer;
+    const char *filePath;
+} constexpr const divoc_key_table[] = {
+    { "did:india", "https://cowin.gov.in/", ":/org.kde.khealthcertificate/divoc/did-india.pem" },
+};
+
+DivocKeyRegistry::DivocKeyRegistry()
+{
+    for (const auto &k : divoc_key_table) {
+        QFile pemFile(QLatin1String(k.filePath));
+        if (!pemFile.open(QFile::ReadOnly)) {
+            qCWarning(Log) << "unable to load public key file:" << pemFile.errorString();
+            continue;
+        }
+
+        const auto pemData = pemFile.readAll();
+        const openssl::bio_ptr bio(BIO_new_mem_buf(pemData.constData(), pemData.size()));
+        openssl::evp_pkey_ptr evp(PEM_read_bio_PUBKEY(bio.get(), nullptr, nullptr, nullptr));
+        if (!evp) {
+            qCWarning(Log) << "Failed to read public key." << pemFile.fileName() << ERR_error_string(ERR_get_error(), nullptr);
+            continue;
+        }
+
+        m_keyIndex.insert(QLatin1String(k.verificationMethod), evp.get());
+        m_keyIndex.insert(QLatin1String(k.issuer), evp.get());
+        m_keys.push_back(std::move(evp));
+    }
+}
+
+const DivocKeyRegistry& DivocKeyRegistry::instance()
+{
+    static const DivocKeyRegistry s_registry;
+    return s_registry;
+}
+
+EVP_PKEY* DivocKeyRegistry::publicKey(const QString &verificationMethod, const QString &issuer)
+{
+    const auto &registry = instance();
+    auto it = registry.m_keyIndex.constFind(verificationMethod);
+    if (it != registry.m_keyIndex.constEnd()) {
+        return it.value();
+    }
+    it = registry.m_keyIndex.constFind(issuer);
+    if (it != registry.m_keyIndex.constEnd()) {
+        return it.value();
+    }
+
+    qCDebug(Log) << "no public key found for DIVOC verification method" << verificationMethod << "or issuer" << issuer;
+    return nullptr;
+}
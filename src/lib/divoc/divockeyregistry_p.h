@@ -0,0 +1,37 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef DIVOCKEYREGISTRY_P_H
+#define DIVOCKEYREGISTRY_P_H
+
+#include "openssl/opensslpp_p.h"
+
+#include <QHash>
+#include <QString>
+
+#include <vector>
+
+/** Public keys of known DIVOC issuers.
+ *  Keys are loaded and parsed once on first use and kept for the entire
+ *  lifetime of the application, lookups don't involve any I/O or parsing.
+ */
+class DivocKeyRegistry
+{
+public:
+    /** Returns the public key for the proof verification method @p verificationMethod,
+     *  or if that is not known, the one for @p issuer.
+     *  The returned key is owned by the registry.
+     */
+    static EVP_PKEY* publicKey(const QString &verificationMethod, const QString &issuer);
+
+private:
+    explicit DivocKeyRegistry();
+    static const DivocKeyRegistry& instance();
+
+    std::vector<openssl::evp_pkey_ptr> m_keys;
+    QHash<QString, EVP_PKEY*> m_keyIndex;
+};
+
+#endif // DIVOCKEYREGISTRY_P_H
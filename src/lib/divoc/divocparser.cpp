@@ -6,10 +6,12 @@
 #include "divocparser_p.h"
 #include "jwsverifier_p.h"
 #include "kvaccinationcertificate.h"
+#include "stringpool_p.h"
+#include "zip/zipreader_p.h"
 
 #include <QByteArray>
-#include <QJsonDocument>
 #include <QJsonArray>
+#include <QJsonObject>
 #include <QVariant>
 
 void DivocParser::init()
@@ -17,21 +19,48 @@ void DivocParser::init()
     Q_INIT_RESOURCE(divoc_data);
 }
 
-QVariant DivocParser::parse(const QByteArray &data)
+// DIVOC archives contain a single JSON-LD credential, usually named certificate.json
+static bool isCredentialName(QByteArrayView name)
 {
-    QJsonParseError error;
-    const auto doc = QJsonDocument::fromJson(data, &error);
-    if (error.error != QJsonParseError::NoError) {
-        return {};
+    return name == "certificate.json" || name.endsWith("/certificate.json");
+}
+
+static bool isCredentialContent(const QByteArray &content)
+{
+    const auto trimmed = QByteArrayView(content).trimmed();
+    return trimmed.startsWith('{') && trimmed.contains("\"credentialSubject\"");
+}
+
+QByteArray DivocParser::unpack(const QByteArray &data)
+{
+    if (!ZipReader::isZip(data)) {
+        return data;
     }
 
+    const ZipReader zip(data);
+    for (qsizetype i = 0; i < zip.entryCount(); ++i) {
+        if (isCredentialName(zip.entryName(i))) {
+            return zip.entryData(i);
+        }
+    }
+    for (qsizetype i = 0; i < zip.entryCount(); ++i) {
+        const auto content = zip.entryData(i);
+        if (isCredentialContent(content)) {
+            return content;
+        }
+    }
+    return {};
+}
+
+KHealthCertificateParser::Certificate DivocParser::parseCredential(const QJsonObject &doc, const QByteArray &rawData)
+{
     // TODO check this is actually a VerifiableCredential structure
     // TODO check the types on the subobjects we use
 
     KVaccinationCertificate cert;
-    const auto subject = doc.object().value(QLatin1String("credentialSubject")).toObject();
+    const auto subject = doc.value(QLatin1String("credentialSubject")).toObject();
     cert.setName(subject.value(QLatin1String("name")).toString());
-    const auto evidences = doc.object().value(QLatin1String("evidence")).toArray();
+    const auto evidences = doc.value(QLatin1String("evidence")).toArray();
     if (evidences.isEmpty()) {
         return {};
     }
@@ -45,14 +74,20 @@ QVariant DivocParser::parse(const QByteArray &data)
 
     const auto facility = evidence.value(QLatin1String("facility")).toObject();
     const auto address = facility.value(QLatin1String("address")).toObject();
-    cert.setCountry(address.value(QLatin1String("addressCountry")).toString());
+    cert.setCountry(StringPool::intern(address.value(QLatin1String("addressCountry")).toString()));
 
     cert.setCertificateId(evidence.value(QLatin1String("certificateId")).toString());
-    cert.setCertificateIssuer(doc.object().value(QLatin1String("issuer")).toString());
-    cert.setCertificateIssueDate(QDateTime::fromString(doc.object().value(QLatin1String("issuanceDate")).toString(), Qt::ISODate));
-
-    JwsVerifier verifier(doc.object());
-    cert.setSignatureState(verifier.verify() ? KHealthCertificate::ValidSignature : KHealthCertificate::InvalidSignature);
+    cert.setCertificateIssuer(doc.value(QLatin1String("issuer")).toString());
+    cert.setCertificateIssueDate(QDateTime::fromString(doc.value(QLatin1String("issuanceDate")).toString(), Qt::ISODate));
+    if (!rawData.isNull()) {
+        cert.setRawData(rawData);
+    }
 
     return cert;
 }
+
+KHealthCertificate::SignatureValidation DivocParser::verifySignature(const QJsonObject &doc)
+{
+    JwsVerifier verifier(doc);
+    return verifier.verify() ? KHealthCertificate::ValidSignature : KHealthCertificate::InvalidSignature;
+}
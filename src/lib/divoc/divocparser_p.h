@@ -6,8 +6,11 @@
 #ifndef DIVOCPARSER_P_H
 #define DIVOCPARSER_P_H
 
+#include "khealthcertificate.h"
+#include "khealthcertificateparser.h"
+
 class QByteArray;
-class QVariant;
+class QJsonObject;
 
 /** Parser for DIVOC certificates, such as used in India.
  *  @see https://divoc.egov.org.in/
@@ -16,7 +19,19 @@ class DivocParser
 {
 public:
     static void init();
-    static QVariant parse(const QByteArray &data);
+
+    /** Extract the credential from a ZIP archive.
+     *  @returns @p data unchanged if it isn't a ZIP file, or an empty byte array
+     *  if the archive doesn't contain a credential.
+     */
+    static QByteArray unpack(const QByteArray &data);
+    /** Map the verifiable credential @p doc to a certificate.
+     *  The signature state of the result is not set yet.
+     *  @param rawData The original encoded input to store on the resulting certificate, if not null.
+     */
+    static KHealthCertificateParser::Certificate parseCredential(const QJsonObject &doc, const QByteArray &rawData);
+    /** Verify the JWS proof of @p doc. */
+    static KHealthCertificate::SignatureValidation verifySignature(const QJsonObject &doc);
 };
 
 #endif // DIVOCPARSER_P_H
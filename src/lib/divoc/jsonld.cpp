@@ -4,6 +4,7 @@
  */
 
 #include "jsonld_p.h"
+#include "parsecontext_p.h"
 #include "rdf_p.h"
 
 #include <QJsonArray>
@@ -179,15 +180,16 @@ void JsonLdContext::resolve()
     });
 }
 
-JsonLdMetaType JsonLdContext::metaType(const QString &type) const
+const JsonLdMetaType& JsonLdContext::metaType(const QString &type) const
 {
+    static const JsonLdMetaType s_emptyMetaType;
     const auto it = std::lower_bound(metaTypes.begin(), metaTypes.end(), type, [](const auto &lhs, const auto &rhs) {
         return lhs.name < rhs;
     });
     if (it != metaTypes.end() && (*it).name == type) {
         return *it;
     }
-    return {};
+    return s_emptyMetaType;
 }
 
 void JsonLd::setDocumentLoader(const JsonLdDocumentLoader &loader)
@@ -195,9 +197,9 @@ void JsonLd::setDocumentLoader(const JsonLdDocumentLoader &loader)
     m_documentLoader = loader;
 }
 
-std::vector<Rdf::Quad> JsonLd::toRdf(const QJsonObject &obj) const
+Rdf::QuadList JsonLd::toRdf(const QJsonObject &obj, std::pmr::memory_resource *resource) const
 {
-    std::vector<Rdf::Quad> quads;
+    Rdf::QuadList quads(resource);
 
     // determine context
     const auto contextVal = obj.value(QLatin1String("@context"));
@@ -215,7 +217,7 @@ std::vector<Rdf::Quad> JsonLd::toRdf(const QJsonObject &obj) const
     return quads;
 }
 
-Rdf::Term JsonLd::toRdfRecursive(const JsonLdContext &context, const QJsonObject &obj, std::vector<Rdf::Quad> &quads) const
+Rdf::Term JsonLd::toRdfRecursive(const JsonLdContext &context, const QJsonObject &obj, Rdf::QuadList &quads) const
 {
     const auto id = idForObject(obj);
 
@@ -232,11 +234,16 @@ Rdf::Term JsonLd::toRdfRecursive(const JsonLdContext &context, const QJsonObject
     return id;
 }
 
-void JsonLd::toRdfRecursive(const JsonLdContext &context, const JsonLdMetaType &mt, const Rdf::Term &id, const QJsonObject &obj, std::vector<Rdf::Quad> &quads) const
+void JsonLd::toRdfRecursive(const JsonLdContext &context, const JsonLdMetaType &mt, const Rdf::Term &id, const QJsonObject &obj, Rdf::QuadList &quads) const
 {
     if (mt.name.isEmpty() && mt.properties.empty()) { // meta type not found
         return;
     }
+    if (m_limitExceeded || !ParseContext::checkLimit(m_depth + 1, ParseContext::limits().maximumNestingDepth, "JSON-LD nesting depth")) {
+        m_limitExceeded = true;
+        return;
+    }
+    ++m_depth;
 
     for (const auto &property : mt.properties) {
         const auto val = obj.value(property.name);
@@ -245,6 +252,10 @@ void JsonLd::toRdfRecursive(const JsonLdContext &context, const JsonLdMetaType &
         }
 
         const auto createQuad = [&](const QJsonValue &value) {
+            if (m_limitExceeded || !ParseContext::checkLimit((qsizetype)quads.size() + 1, ParseContext::limits().maximumRdfQuadCount, "RDF quad count")) {
+                m_limitExceeded = true;
+                return;
+            }
             Rdf::Quad quad;
             quad.subject = id;
             quad.predicate.value = property.qualifiedName;
@@ -296,6 +307,8 @@ void JsonLd::toRdfRecursive(const JsonLdContext &context, const JsonLdMetaType &
             createQuad(val);
         }
     }
+
+    --m_depth;
 }
 
 Rdf::Term JsonLd::idForObject(const QJsonObject &obj) const
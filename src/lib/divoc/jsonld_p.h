@@ -6,17 +6,15 @@
 #ifndef JSONLD_H
 #define JSONLD_H
 
+#include "rdf_p.h"
+
 #include <QHash>
 #include <QString>
 
 #include <functional>
+#include <memory_resource>
 #include <vector>
 
-namespace Rdf {
-class Quad;
-class Term;
-}
-
 class QByteArray;
 class QJsonObject;
 class QJsonValue;
@@ -54,7 +52,10 @@ public:
     void load(const QByteArray &contextData, const JsonLdDocumentLoader &loader);
     void load(const QJsonObject &context);
     void resolve();
-    JsonLdMetaType metaType(const QString &type) const;
+    /** Look up the meta type for @p type.
+     *  Returns an empty meta type if @p type is unknown.
+     */
+    const JsonLdMetaType& metaType(const QString &type) const;
 
     std::vector<JsonLdMetaType> metaTypes;
     JsonLdCurieMap curieMap;
@@ -72,16 +73,21 @@ public:
     // we only support offline data, so a synchronous interface is fine
     void setDocumentLoader(const JsonLdDocumentLoader &loader);
 
-    /** Convert JSON-LD object to RDF */
-    std::vector<Rdf::Quad> toRdf(const QJsonObject &obj) const;
+    /** Convert JSON-LD object to RDF.
+     *  The resulting quads are allocated from @p resource.
+     *  Conversion stops once the nesting depth or RDF quad count limits are reached.
+     */
+    Rdf::QuadList toRdf(const QJsonObject &obj, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) const;
 
 private:
-    Rdf::Term toRdfRecursive(const JsonLdContext &context, const QJsonObject &obj, std::vector<Rdf::Quad> &quads) const;
-    void toRdfRecursive(const JsonLdContext &context, const JsonLdMetaType &mt, const Rdf::Term &id, const QJsonObject &obj, std::vector<Rdf::Quad> &quads) const;
+    Rdf::Term toRdfRecursive(const JsonLdContext &context, const QJsonObject &obj, Rdf::QuadList &quads) const;
+    void toRdfRecursive(const JsonLdContext &context, const JsonLdMetaType &mt, const Rdf::Term &id, const QJsonObject &obj, Rdf::QuadList &quads) const;
     Rdf::Term idForObject(const QJsonObject &obj) const;
 
     JsonLdDocumentLoader m_documentLoader;
     mutable int m_blankNodeCounter = 0;
+    mutable int m_depth = 0;
+    mutable bool m_limitExceeded = false;
 };
 
 #endif // JSONLD_H
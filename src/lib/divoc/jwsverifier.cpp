@@ -4,16 +4,28 @@
  */
 
 #include "jwsverifier_p.h"
+#include "divockeyregistry_p.h"
 #include "jsonld_p.h"
+#include "khealthcertificateparsersession_p.h"
 #include "logging.h"
+#include "parsecontext_p.h"
 #include "rdf_p.h"
+#include "tracepoints_p.h"
+
+#include "openssl/opensslpp_p.h"
+#include "openssl/verificationcache_p.h"
+
+#include <KHealthCertificatePipeline>
 
 #include <QFile>
 #include <QJsonDocument>
 
 #include <openssl/err.h>
 #include <openssl/evp.h>
-#include <openssl/pem.h>
+#include <openssl/rsa.h>
+
+#include <array>
+#include <optional>
 
 JwsVerifier::JwsVerifier(const QJsonObject &doc)
     : m_obj(doc)
@@ -43,16 +55,32 @@ bool JwsVerifier::verify() const
     // check signature algorithm
     const auto headerObj = QJsonDocument::fromJson(QByteArray::fromBase64(header.toUtf8(), QByteArray::Base64UrlEncoding)).object();
     if (headerObj.value(QLatin1String("alg")) != QLatin1String("PS256")) {
-        qCWarning(Log) << "not implemented JWS algorithm:" << headerObj;
+        qCDebug(Log) << "not implemented JWS algorithm:" << headerObj;
+        ParseContext::setReason(KHealthCertificatePipeline::UnsupportedSignatureAlgorithm);
         return false;
     }
 
-    // load certificate
-    const auto evp = loadPublicKey();
+    // find the key
+    KHC_TRACEPOINT(key_lookup_begin, int(KHealthCertificatePipeline::Divoc));
+    const auto evp = DivocKeyRegistry::publicKey(proof.value(QLatin1String("verificationMethod")).toString(), m_obj.value(QLatin1String("issuer")).toString());
+    KHC_TRACEPOINT(key_lookup_end, int(KHealthCertificatePipeline::Divoc), evp != nullptr);
     if (!evp) {
+        ParseContext::setReason(KHealthCertificatePipeline::UnknownSigningKey);
+        return false;
+    }
+    if (!ParseContext::addCryptoOperation()) {
         return false;
     }
 
+    // the signed content is the entire document, checked before the expensive JSON-LD canonicalization below
+    const auto cacheKey = VerificationCache::Key("DIVOC-PS256")
+        .add(evp)
+        .add(QJsonDocument(m_obj).toJson(QJsonDocument::Compact))
+        .result();
+    if (VerificationCache::contains(cacheKey)) {
+        return true;
+    }
+
     const EVP_MD *digest = EVP_sha256();
     uint8_t digestData[EVP_MAX_MD_SIZE];
     uint32_t  digestSize = 0;
@@ -65,8 +93,16 @@ bool JwsVerifier::verify() const
     proofOptions.remove(QLatin1String("proofValue"));
     proofOptions.insert(QLatin1String("@context"), QLatin1String("https://w3id.org/security/v2"));
 
-    const auto canonicalProof = canonicalRdf(proofOptions);
-    const auto canonicalContent = canonicalRdf(content);
+    // all intermediate JSON-LD/RDF data of this verification is allocated from here, and released in one go at the end
+    // with a parser session the initial arena block is reused across verifications
+    std::optional<std::pmr::monotonic_buffer_resource> arena;
+    if (auto session = ParseContext::session()) {
+        arena.emplace(session->arenaBuffer(), KHealthCertificateParserSessionPrivate::ArenaSize);
+    } else {
+        arena.emplace(KHealthCertificateParserSessionPrivate::ArenaSize);
+    }
+    const auto canonicalProof = canonicalRdf(proofOptions, &*arena);
+    const auto canonicalContent = canonicalRdf(content, &*arena);
 
     QByteArray signedData = header.toUtf8() + '.';
     EVP_Digest(reinterpret_cast<const uint8_t*>(canonicalProof.constData()), canonicalProof.size(), digestData, &digestSize, digest, nullptr);
@@ -78,7 +114,7 @@ bool JwsVerifier::verify() const
     EVP_Digest(reinterpret_cast<const uint8_t*>(signedData.constData()), signedData.size(), digestData, &digestSize, digest, nullptr);
 
     // verify
-    openssl::evp_pkey_ctx_ptr ctx(EVP_PKEY_CTX_new(evp.get(), nullptr));
+    openssl::evp_pkey_ctx_ptr ctx(EVP_PKEY_CTX_new(evp, nullptr));
     if (!ctx || EVP_PKEY_verify_init(ctx.get()) <= 0) {
         return false;
     }
@@ -89,37 +125,15 @@ bool JwsVerifier::verify() const
     const auto verifyResult = EVP_PKEY_verify(ctx.get(), reinterpret_cast<const uint8_t*>(signature.constData()), signature.size(),  digestData, digestSize);
     switch (verifyResult) {
         case -1: // technical issue
-            qCWarning(Log) << "Failed to verify signature:" << ERR_error_string(ERR_get_error(), nullptr);
+            qCDebug(Log) << "Failed to verify signature:" << ERR_error_string(ERR_get_error(), nullptr);
             break;
         case 1: // valid signature;
+            VerificationCache::insert(cacheKey);
             return true;
     }
     return false;
 }
 
-openssl::evp_pkey_ptr JwsVerifier::loadPublicKey() const
-{
-    // ### for now there is only one key, longer term we probably need to actually
-    // implement finding the right key here
-    QFile pemFile(QLatin1String(":/org.kde.khealthcertificate/divoc/did-india.pem"));
-    if (!pemFile.open(QFile::ReadOnly)) {
-        qCWarning(Log) << "unable to load public key file:" << pemFile.errorString();
-        return {};
-    }
-
-    const auto pemData = pemFile.readAll();
-    const openssl::bio_ptr bio(BIO_new_mem_buf(pemData.constData(), pemData.size()));
-    openssl::rsa_ptr rsa(PEM_read_bio_RSA_PUBKEY(bio.get(), nullptr, nullptr, nullptr));
-    if (!rsa) {
-        qCWarning(Log) << "Failed to read public key." << ERR_error_string(ERR_get_error(), nullptr);
-        return {};
-    }
-
-    openssl::evp_pkey_ptr evp(EVP_PKEY_new());
-    EVP_PKEY_assign_RSA(evp.get(), rsa.release());
-    return evp;
-}
-
 static struct {
     const char *uri;
     const char *filePath;
@@ -130,26 +144,38 @@ static struct {
     { "https://w3id.org/security/v2", ":/org.kde.khealthcertificate/divoc/security-v2.json" },
 };
 
-QByteArray JwsVerifier::canonicalRdf(const QJsonObject &doc) const
+QByteArray JwsVerifier::canonicalRdf(const QJsonObject &doc, std::pmr::memory_resource *arena) const
 {
+    KHC_TRACEPOINT(jws_canonical_rdf_begin, doc.size());
     JsonLd jsonLd;
     const auto documentLoader = [](const QString &context) -> QByteArray {
-        for (const auto &i : schema_document_table) {
-            if (context == QLatin1String(i.uri)) {
-                QFile f(QLatin1String(i.filePath));
+        // loaded once and read-only afterwards, so safe for concurrent use
+        static const auto s_documents = []() {
+            std::array<QByteArray, std::size(schema_document_table)> documents;
+            for (std::size_t i = 0; i < documents.size(); ++i) {
+                QFile f(QLatin1String(schema_document_table[i].filePath));
                 if (!f.open(QFile::ReadOnly)) {
                     qCWarning(Log) << f.errorString();
                 } else {
-                    return f.readAll();
+                    documents[i] = f.readAll();
                 }
             }
+            return documents;
+        }();
+
+        for (std::size_t i = 0; i < s_documents.size(); ++i) {
+            if (context == QLatin1String(schema_document_table[i].uri)) {
+                return s_documents[i];
+            }
         }
-        qCWarning(Log) << "Failed to provide requested document:" << context;
+        qCDebug(Log) << "Failed to provide requested document:" << context;
         return QByteArray();
     };
     jsonLd.setDocumentLoader(documentLoader);
 
-    auto quads = jsonLd.toRdf(doc);
+    auto quads = jsonLd.toRdf(doc, arena);
     Rdf::normalize(quads);
-    return Rdf::serialize(quads);
+    const auto result = Rdf::serialize(quads);
+    KHC_TRACEPOINT(jws_canonical_rdf_end, result.size());
+    return result;
 }
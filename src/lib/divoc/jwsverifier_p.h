@@ -6,10 +6,10 @@
 #ifndef JWSVERIFIER_H
 #define JWSVERIFIER_H
 
-#include "openssl/opensslpp_p.h"
-
 #include <QJsonObject>
 
+#include <memory_resource>
+
 /** Verification of JSON Web Signatures (JWS).
  *  @see RFC 7515
  *  @see RFC 7797 (unencoded payload extension)
@@ -26,8 +26,7 @@ public:
     bool verify() const;
 
 private:
-    openssl::evp_pkey_ptr loadPublicKey() const;
-    QByteArray canonicalRdf(const QJsonObject &doc) const;
+    QByteArray canonicalRdf(const QJsonObject &doc, std::pmr::memory_resource *arena) const;
 
     QJsonObject m_obj;
 };
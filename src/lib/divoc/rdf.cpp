@@ -39,7 +39,7 @@ bool Rdf::Quad::operator<(const Rdf::Quad &other) const
 }
 
 // see https://json-ld.github.io/rdf-dataset-canonicalization/spec/#hash-first-degree-quads
-static QByteArray hashFirstDegreeQuads(const std::vector<Rdf::Quad> &quads, const QString &refBlankNode)
+static QByteArray hashFirstDegreeQuads(const Rdf::QuadList &quads, const QString &refBlankNode)
 {
     const auto renameBlankNode = [&refBlankNode](Rdf::Term &term) {
         if (term.type == Rdf::Term::BlankNode) {
@@ -51,7 +51,8 @@ static QByteArray hashFirstDegreeQuads(const std::vector<Rdf::Quad> &quads, cons
         }
     };
 
-    std::vector<Rdf::Quad> toHash;
+    Rdf::QuadList toHash(quads.get_allocator());
+    toHash.reserve(quads.size());
     for (auto quad : quads) {
         renameBlankNode(quad.subject);
         renameBlankNode(quad.predicate);
@@ -63,7 +64,7 @@ static QByteArray hashFirstDegreeQuads(const std::vector<Rdf::Quad> &quads, cons
     return QCryptographicHash::hash(serialize(toHash), QCryptographicHash::Sha256).toHex();
 }
 
-QByteArray Rdf::serialize(const std::vector<Rdf::Quad>& quads)
+QByteArray Rdf::serialize(const Rdf::QuadList &quads)
 {
     QByteArray out;
     QBuffer buffer(&out);
@@ -73,17 +74,24 @@ QByteArray Rdf::serialize(const std::vector<Rdf::Quad>& quads)
     return out;
 }
 
-void Rdf::normalize(std::vector<Rdf::Quad>& quads)
+void Rdf::normalize(Rdf::QuadList &quads)
 {
     // see https://json-ld.github.io/rdf-dataset-canonicalization/spec/#algorithm
-    QHash<QString, std::vector<Rdf::Quad>> blankNodeToQuadMap;
+    QHash<QString, Rdf::QuadList> blankNodeToQuadMap;
+    const auto addBlankNodeQuad = [&blankNodeToQuadMap, &quads](const QString &blankNode, const Rdf::Quad &quad) {
+        auto it = blankNodeToQuadMap.find(blankNode);
+        if (it == blankNodeToQuadMap.end()) {
+            it = blankNodeToQuadMap.emplace(blankNode, quads.get_allocator());
+        }
+        it.value().push_back(quad);
+    };
     for (const auto &quad : quads) {
         // ignores predicates and the same blank nodes used multiple times in a quad, as that doesn't happen for us
         if (quad.subject.type == Rdf::Term::BlankNode) {
-            blankNodeToQuadMap[quad.subject.value].push_back(quad);
+            addBlankNodeQuad(quad.subject.value, quad);
         }
         if (quad.object.type == Rdf::Term::BlankNode) {
-            blankNodeToQuadMap[quad.object.value].push_back(quad);
+            addBlankNodeQuad(quad.object.value, quad);
         }
     }
 
@@ -118,7 +126,7 @@ void Rdf::normalize(std::vector<Rdf::Quad>& quads)
     }), quads.end());
 }
 
-void Rdf::serialize(QIODevice *out, const std::vector<Rdf::Quad> &quads)
+void Rdf::serialize(QIODevice *out, const Rdf::QuadList &quads)
 {
     for (const auto &quad : quads) {
         serialize(out, quad);
@@ -8,6 +8,7 @@
 
 #include <QString>
 
+#include <memory_resource>
 #include <vector>
 
 class QIODevice;
@@ -43,12 +44,20 @@ public:
     bool operator<(const Quad &other) const;
 };
 
-/** Apply the Universal RDF Dataset Normalization Algorithm 2015 (URDNA2015) to @p quads. */
-void normalize(std::vector<Rdf::Quad> &quads);
+/** A list of RDF quads.
+ *  Uses a polymorphic allocator so that all quads of one verification run can be
+ *  placed in a single arena.
+ */
+using QuadList = std::pmr::vector<Rdf::Quad>;
+
+/** Apply the Universal RDF Dataset Normalization Algorithm 2015 (URDNA2015) to @p quads.
+ *  Temporary data is allocated from the same memory resource as @p quads.
+ */
+void normalize(QuadList &quads);
 
 /** Write list of RDF quads to @p out. */
-QByteArray serialize(const std::vector<Rdf::Quad> &quads);
-void serialize(QIODevice *out, const std::vector<Rdf::Quad> &quads);
+QByteArray serialize(const QuadList &quads);
+void serialize(QIODevice *out, const QuadList &quads);
 void serialize(QIODevice *out, const Rdf::Quad &quad);
 void serialize(QIODevice *out, const Rdf::Term &term);
 
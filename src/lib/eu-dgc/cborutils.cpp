@@ -5,6 +5,7 @@
 
 #include "cborutils_p.h"
 #include "logging.h"
+#include "parsecontext_p.h"
 
 #include <QCborStreamReader>
 
@@ -31,7 +32,7 @@ QString CborUtils::readString(QCborStreamReader &reader)
         r = reader.readString();
     }
     if (r.status == QCborStreamReader::Error) {
-        qCWarning(Log) << "CBOR string read error";
+        qCDebug(Log) << "CBOR string read error";
         result.clear();
     }
     return result;
@@ -51,8 +52,19 @@ QByteArray CborUtils::readByteArray(QCborStreamReader &reader)
     }
 
     if (r.status == QCborStreamReader::Error) {
-        qCWarning(Log) << "CBOR byte array read error";
+        qCDebug(Log) << "CBOR byte array read error";
         result.clear();
     }
     return result;
 }
+
+bool CborUtils::skip(QCborStreamReader &reader)
+{
+    if (reader.next(ParseContext::limits().maximumNestingDepth)) {
+        return true;
+    }
+    if (reader.lastError() == QCborError::NestingTooDeep) {
+        ParseContext::setLimitExceeded("CBOR nesting depth");
+    }
+    return false;
+}
@@ -21,6 +21,10 @@ namespace CborUtils
     QString readString(QCborStreamReader &reader);
     /** Read a fully assembled byte array value. */
     QByteArray readByteArray(QCborStreamReader &reader);
+    /** Skip the current element, including any nested content.
+     *  Nested content is subject to the nesting depth limit.
+     */
+    bool skip(QCborStreamReader &reader);
 }
 
 #endif // CBORUTILS_P_H
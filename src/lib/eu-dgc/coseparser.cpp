@@ -5,16 +5,20 @@
 
 #include "coseparser_p.h"
 #include "cborutils_p.h"
+#include "eudgccertificateregistry_p.h"
 #include "logging.h"
+#include "parsecontext_p.h"
+#include "tracepoints_p.h"
 
+#include <KHealthCertificatePipeline>
+
+#include <openssl/verificationcache_p.h>
 #include <openssl/verify_p.h>
-#include <openssl/x509loader_p.h>
 
 #include <QCborMap>
 #include <QCborStreamReader>
 #include <QCborStreamWriter>
 #include <QCborValue>
-#include <QFile>
 
 #include <openssl/bn.h>
 #include <openssl/evp.h>
@@ -42,7 +46,7 @@ void CoseParser::parse(const QByteArray &data)
     // only single signer case implemented atm
     QCborStreamReader reader(data);
     if (reader.type() != QCborStreamReader::Tag || reader.toTag() != QCborKnownTags::COSE_Sign1) {
-        qCWarning(Log) << "wrong COSE tag:" << reader.toTag();
+        qCDebug(Log) << "wrong COSE tag:" << reader.toTag();
         return;
     }
 
@@ -54,7 +58,7 @@ void CoseParser::parse(const QByteArray &data)
     reader.enterContainer();
     m_protectedParams = CborUtils::readByteArray(reader);
     auto params = QCborValue::fromCbor(m_protectedParams);
-    const auto algorithm = params.toMap().value(CoseHeaderAlgorithm).toInteger();
+    m_algorithm = params.toMap().value(CoseHeaderAlgorithm).toInteger();
     m_kid = params.toMap().value(CoseHeaderKid).toByteArray();
     params = QCborValue::fromCbor(reader);
     if (m_kid.isEmpty()) {
@@ -62,51 +66,53 @@ void CoseParser::parse(const QByteArray &data)
     }
     m_payload = CborUtils::readByteArray(reader);
     m_signature = CborUtils::readByteArray(reader);
+}
 
-    // find and load certificate
-    QFile certFile(QLatin1String(":/org.kde.khealthcertificate/eu-dgc/certs/") + QString::fromUtf8(m_kid.toHex()) + QLatin1String(".der"));
-    if (!certFile.open(QFile::ReadOnly)) {
-        qCWarning(Log) << "unable to find certificate for key id:" << m_kid.toHex();
-        m_signatureState = UnknownCertificate;
+QByteArray CoseParser::payload() const
+{
+    return m_payload;
+}
+
+QByteArray CoseParser::keyId() const
+{
+    return m_kid;
+}
+
+void CoseParser::verifySignature()
+{
+    if (m_payload.isEmpty()) {
         return;
     }
+    KHC_TRACEPOINT(cose_verify_begin, m_algorithm, m_payload.size());
 
-    const auto certData = certFile.readAll();
-    const auto cert = X509Loader::readFromDER(certData);
+    // find certificate
+    KHC_TRACEPOINT(key_lookup_begin, int(KHealthCertificatePipeline::EuDgc));
+    const auto cert = EuDgcCertificateRegistry::certificate(m_kid);
+    KHC_TRACEPOINT(key_lookup_end, int(KHealthCertificatePipeline::EuDgc), bool(cert));
     if (!cert) {
-        qCWarning(Log) << "failed to read X509 certificate";
         m_signatureState = UnknownCertificate;
+        KHC_TRACEPOINT(cose_verify_end, m_algorithm, int(m_signatureState));
         return;
     }
-    const openssl::evp_pkey_ptr pkey(X509_get_pubkey(cert.get()));
-    if (!pkey) {
-        qCWarning(Log) << "failed to load public key";
-        m_signatureState = UnknownCertificate;
-        return;
-    }
-    m_certificate = QSslCertificate(certData, QSsl::Der);
+    m_certificate = cert->certificate;
 
-    switch (algorithm) {
+    switch (m_algorithm) {
         case CoseAlgorithmECDSA_SHA256:
         case CoseAlgorithmECDSA_SHA384:
         case CoseAlgorithmECDSA_SHA512:
-            validateECDSA(pkey, algorithm);
+            validateECDSA(cert->publicKey, m_algorithm);
             break;
         case CoseAlgorithmRSA_PSS_256:
         case CoseAlgorithmRSA_PSS_384:
         case CoseAlgorithmRSA_PSS_512:
-            validateRSAPSS(pkey, algorithm);
+            validateRSAPSS(cert->publicKey, m_algorithm);
             break;
         default:
-            qCWarning(Log) << "signature algorithm not implemented yet:" << algorithm;
+            qCDebug(Log) << "signature algorithm not implemented yet:" << m_algorithm;
             m_signatureState = UnsupportedAlgorithm;
-            return;
+            break;
     }
-}
-
-QByteArray CoseParser::payload() const
-{
-    return m_payload;
+    KHC_TRACEPOINT(cose_verify_end, m_algorithm, int(m_signatureState));
 }
 
 CoseParser::SignatureState CoseParser::signatureState() const
@@ -125,7 +131,9 @@ void CoseParser::clear()
     m_payload.clear();
     m_signature.clear();
     m_kid.clear();
+    m_algorithm = 0;
     m_signatureState = Unknown;
+    m_certificate = {};
 }
 
 void CoseParser::validateECDSA(const openssl::evp_pkey_ptr &pkey, int algorithm)
@@ -173,6 +181,20 @@ void CoseParser::validateRSAPSS(const openssl::evp_pkey_ptr &pkey, int algorithm
     EVP_Digest(reinterpret_cast<const uint8_t*>(signedData.constData()), signedData.size(), digestData, &digestSize, digest, nullptr);
 
     // verify
+    if (!ParseContext::addCryptoOperation()) {
+        return;
+    }
+    const auto cacheKey = VerificationCache::Key("RSA-PSS")
+        .add(QByteArray::number(EVP_MD_type(digest)))
+        .add(pkey.get())
+        .add(QByteArrayView(digestData, digestSize))
+        .add(m_signature)
+        .result();
+    if (VerificationCache::contains(cacheKey)) {
+        m_signatureState = ValidSignature;
+        return;
+    }
+
     openssl::evp_pkey_ctx_ptr ctx(EVP_PKEY_CTX_new(pkey.get(), nullptr));
     if (!ctx || EVP_PKEY_verify_init(ctx.get()) <= 0) {
         return;
@@ -185,13 +207,14 @@ void CoseParser::validateRSAPSS(const openssl::evp_pkey_ptr &pkey, int algorithm
     switch (verifyResult) {
         case -1: // technical issue
             m_signatureState = InvalidSignature;
-            qCWarning(Log) << "Failed to verify signature:" << ERR_error_string(ERR_get_error(), nullptr);
+            qCDebug(Log) << "Failed to verify signature:" << ERR_error_string(ERR_get_error(), nullptr);
             break;
         case 0: // invalid signature
             m_signatureState = InvalidSignature;
             break;
         case 1: // valid signature;
             m_signatureState = ValidSignature;
+            VerificationCache::insert(cacheKey);
             break;
     }
 }
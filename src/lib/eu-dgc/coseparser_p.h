@@ -17,9 +17,15 @@
 class CoseParser
 {
 public:
+    /** Parse the COSE structure, this does not verify the signature yet. */
     void parse(const QByteArray &data);
     /** The signed content. */
     QByteArray payload() const;
+    /** The key id of the signing entity. */
+    QByteArray keyId() const;
+
+    /** Look up the certificate of the signing entity and validate the signature. */
+    void verifySignature();
 
     enum SignatureState {
         Unknown,
@@ -45,6 +51,7 @@ private:
     QByteArray m_payload;
     QByteArray m_signature;
     QByteArray m_kid;
+    int m_algorithm = 0;
     SignatureState m_signatureState = Unknown;
     QSslCertificate m_certificate;
 };
@@ -0,0 +1,72 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "eudgccertificateregistry_p.h"
+#include "logging.h"
+
+#include "openssl/x509loader_p.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+
+// certificates are stored as <hex key id>.der
+EuDgcCertificateRegistry::EuDgcCertificateRegistry()
+{
+    QStringList fileNames;
+    for (QDirIterator it(QStringLiteral(":/org.kde.khealthcertificate/eu-dgc/certs"), QDir::Files); it.hasNext();) {
+        const auto fileName = it.next();
+        if (fileName.endsWith(QLatin1String(".der"))) {
+            fileNames.push_back(fileName);
+        }
+    }
+
+    m_entries.reset(new Entry[fileNames.size()]);
+    m_index.reserve(fileNames.size());
+    for (qsizetype i = 0; i < fileNames.size(); ++i) {
+        m_entries[i].fileName = fileNames[i];
+        m_index.insert(QByteArray::fromHex(QFileInfo(fileNames[i]).completeBaseName().toLatin1()), i);
+    }
+}
+
+const EuDgcSignerCertificate* EuDgcCertificateRegistry::certificate(const QByteArray &kid)
+{
+    static EuDgcCertificateRegistry s_registry;
+
+    const auto it = s_registry.m_index.constFind(kid);
+    if (it == s_registry.m_index.constEnd()) {
+        qCDebug(Log) << "unable to find certificate for key id:" << kid.toHex();
+        return nullptr;
+    }
+    auto &entry = s_registry.m_entries[it.value()];
+    std::call_once(entry.loaded, [&entry]() {
+        entry.certificate = loadCertificate(entry.fileName);
+    });
+    return entry.certificate.get();
+}
+
+std::unique_ptr<EuDgcSignerCertificate> EuDgcCertificateRegistry::loadCertificate(const QString &fileName)
+{
+    QFile certFile(fileName);
+    if (!certFile.open(QFile::ReadOnly)) {
+        qCWarning(Log) << "unable to read certificate:" << fileName << certFile.errorString();
+        return {};
+    }
+
+    auto cert = std::make_unique<EuDgcSignerCertificate>();
+    const auto certData = certFile.readAll();
+    cert->x509 = X509Loader::readFromDER(certData);
+    if (!cert->x509) {
+        qCWarning(Log) << "failed to read X509 certificate";
+        return {};
+    }
+    cert->publicKey.reset(X509_get_pubkey(cert->x509.get()));
+    if (!cert->publicKey) {
+        qCWarning(Log) << "failed to load public key";
+        return {};
+    }
+    cert->certificate = QSslCertificate(certData, QSsl::Der);
+    return cert;
+}
@@ -0,0 +1,50 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef EUDGCCERTIFICATEREGISTRY_P_H
+#define EUDGCCERTIFICATEREGISTRY_P_H
+
+#include "openssl/opensslpp_p.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QSslCertificate>
+
+#include <memory>
+#include <mutex>
+
+/** Document signer certificate (DSC) from the EU DGC trust list. */
+struct EuDgcSignerCertificate
+{
+    openssl::x509_ptr x509;
+    openssl::evp_pkey_ptr publicKey;
+    QSslCertificate certificate;
+};
+
+/** Parsed document signer certificates of the EU DGC trust list.
+ *  The index of known key ids is built once on first use and immutable afterwards.
+ *  Certificates are parsed on first use and kept for subsequent lookups, so each
+ *  certificate is only read and parsed once. Lookups don't take any lock.
+ */
+class EuDgcCertificateRegistry
+{
+public:
+    /** Returns the signer certificate for key id @p kid, @c nullptr if not known. */
+    static const EuDgcSignerCertificate* certificate(const QByteArray &kid);
+
+private:
+    explicit EuDgcCertificateRegistry();
+    static std::unique_ptr<EuDgcSignerCertificate> loadCertificate(const QString &fileName);
+
+    struct Entry {
+        QString fileName;
+        std::once_flag loaded;
+        std::unique_ptr<EuDgcSignerCertificate> certificate;
+    };
+    QHash<QByteArray, qsizetype> m_index;
+    std::unique_ptr<Entry[]> m_entries;
+};
+
+#endif // EUDGCCERTIFICATEREGISTRY_P_H
@@ -6,7 +6,12 @@
 #include "eudgcparser_p.h"
 #include "cborutils_p.h"
 #include "coseparser_p.h"
+#include "krecoverycertificate_p.h"
+#include "ktestcertificate_p.h"
+#include "kvaccinationcertificate_p.h"
 #include "logging.h"
+#include "parsecontext_p.h"
+#include "stringpool_p.h"
 #include "zlib/zlib_p.h"
 
 #include <KCodecs>
@@ -14,9 +19,11 @@
 #include <QCborStreamReader>
 #include <QDebug>
 #include <QFile>
+#include <QHash>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QLocale>
+#include <QUrl>
 #include <QVariant>
 
 // std::variant visitor skipping std::monostate alternative
@@ -39,45 +46,74 @@ void EuDgcParser::init()
     Q_INIT_RESOURCE(eu_dgc_certs);
 }
 
+// value set translation tables, loaded once and read-only afterwards, so safe for concurrent use
+static QHash<QString, QJsonObject> loadTranslationTables()
+{
+    QHash<QString, QJsonObject> tables;
+    for (const auto type : { "ma", "mp", "tcMa", "tcTr", "tcTt", "tg", "vp" }) {
+        QFile f(QLatin1String(":/org.kde.khealthcertificate/eu-dgc/") + QLatin1String(type) + QLatin1String(".json"));
+        if (!f.open(QFile::ReadOnly)) {
+            qCWarning(Log) << "no translation table found for" << type;
+            continue;
+        }
+        tables.insert(QLatin1String(type), QJsonDocument::fromJson(f.readAll()).object());
+    }
+    return tables;
+}
+
 static QString translateValue(const QString &type, const QString &key)
 {
-    QFile f(QLatin1String(":/org.kde.khealthcertificate/eu-dgc/") + type + QLatin1String(".json"));
-    if (!f.open(QFile::ReadOnly)) {
-        qCWarning(Log) << "no translation table found for" << type;
-        return key;
+    static const auto s_tables = loadTranslationTables();
+    const auto tableIt = s_tables.constFind(type);
+    if (tableIt == s_tables.constEnd()) {
+        return StringPool::intern(key);
     }
 
-    const auto obj = QJsonDocument::fromJson(f.readAll()).object();
-    const auto language = QLocale().name().left(QLocale().name().indexOf(QLatin1Char('_')));
-    auto it = obj.constFind(key + QLatin1Char('[') + language + QLatin1Char(']'));
+    // translations are keyed as "<key>[<language>]"
+    static const QString s_languageSuffix = []() {
+        const auto localeName = QLocale().name();
+        return QLatin1Char('[') + localeName.left(localeName.indexOf(QLatin1Char('_'))) + QLatin1Char(']');
+    }();
+
+    const auto &obj = tableIt.value();
+    auto it = obj.constFind(key + s_languageSuffix);
     if (it != obj.constEnd()) {
-        return it.value().toString();
+        return StringPool::intern(it.value().toString());
     }
     it = obj.constFind(key);
     if (it != obj.constEnd()) {
-        return it.value().toString();
+        return StringPool::intern(it.value().toString());
     }
-    return key;
+    return StringPool::intern(key);
 }
 
-QVariant EuDgcParser::parse(const QByteArray &data) const
+static QUrl vaccineUrl(const QString &productId)
 {
-    if (!data.startsWith("HC1:") && !data.startsWith("DK3:")) {
-        return {};
-    }
+    const auto num = QStringView(productId).mid(productId.lastIndexOf(QLatin1Char('/')) + 1);
+    return QUrl(QLatin1String("https://ec.europa.eu/health/documents/community-register/html/h") + num + QLatin1String(".htm"));
+}
 
-    const auto decoded = Zlib::decompressZlib(KCodecs::base45Decode(data.mid(4)));
-    if (decoded.isEmpty()) {
-        return {};
-    }
+static QUrl testUrl(const QString &productId)
+{
+    return QUrl(QLatin1String("https://covid-19-diagnostics.jrc.ec.europa.eu/devices/detail/") + productId);
+}
 
-    CoseParser cose;
-    cose.parse(decoded);
-    if (cose.payload().isEmpty()) {
+QByteArray EuDgcParser::decodeTransport(const QByteArray &data)
+{
+    if (!data.startsWith("HC1:") && !data.startsWith("DK3:")) {
         return {};
     }
+    return KCodecs::base45Decode(data.mid(4));
+}
 
-    QCborStreamReader reader(cose.payload());
+QByteArray EuDgcParser::decompress(const QByteArray &data)
+{
+    return Zlib::decompressZlib(data);
+}
+
+KHealthCertificateParser::Certificate EuDgcParser::parsePayload(const QByteArray &payload, const QByteArray &rawData) const
+{
+    QCborStreamReader reader(payload);
     if (!reader.isMap()) {
         return {};
     }
@@ -101,33 +137,39 @@ QVariant EuDgcParser::parse(const QByteArray &data) const
                 break;
             default:
                 qCDebug(Log) << "unhandled header key:" << key;
-                reader.next();
+                CborUtils::skip(reader);
         }
     }
     reader.leaveContainer();
-    std::visit(visitor([&issueDt](auto &cert) { cert.setCertificateIssueDate(issueDt); }), m_cert);
-    std::visit(visitor([&expiryDt](auto &cert) { cert.setCertificateExpiryDate(expiryDt); }), m_cert);
+    std::visit(visitor([&issueDt](auto &cert) { cert.setCertificateIssueDate(std::move(issueDt)); }), m_cert);
+    std::visit(visitor([&expiryDt](auto &cert) { cert.setCertificateExpiryDate(std::move(expiryDt)); }), m_cert);
+    std::visit(visitor([&rawData](auto &cert) { cert.setRawData(rawData); }), m_cert);
+    return m_cert;
+}
 
-    // signature validation
+KHealthCertificate::SignatureValidation EuDgcParser::signatureState(const CoseParser &cose, const QDateTime &issueDate)
+{
     auto sigState = cose.signatureState();
-    if (sigState == CoseParser::ValidSignature && cose.certificate().expiryDate() < issueDt ) {
+    if (sigState == CoseParser::ValidSignature && cose.certificate().expiryDate() < issueDate) {
+        ParseContext::setReason(KHealthCertificatePipeline::InvalidSigningCertificate);
         sigState = CoseParser::InvalidSignature;
     }
     // TODO check key usage OIDs for 1.3.6.1.4.1.1847.2021.1.[1-3] / 1.3.6.1.4.1.0.1847.2021.1.[1-3]
     // (seems unused so far?)
     switch (sigState) {
         case CoseParser::InvalidSignature:
-            std::visit(visitor([](auto &cert) { cert.setSignatureState(KHealthCertificate::InvalidSignature); }), m_cert);
-            break;
+            return KHealthCertificate::InvalidSignature;
         case CoseParser::ValidSignature:
-            std::visit(visitor([](auto &cert) { cert.setSignatureState(KHealthCertificate::ValidSignature); }), m_cert);
-            break;
+            return KHealthCertificate::ValidSignature;
+        case CoseParser::UnknownCertificate:
+            ParseContext::setReason(KHealthCertificatePipeline::UnknownSigningKey);
+            return KHealthCertificate::UnknownSignature;
+        case CoseParser::UnsupportedAlgorithm:
+            ParseContext::setReason(KHealthCertificatePipeline::UnsupportedSignatureAlgorithm);
+            return KHealthCertificate::UnknownSignature;
         default:
-            std::visit(visitor([](auto &cert) { cert.setSignatureState(KHealthCertificate::UnknownSignature); }), m_cert);
-            break;
+            return KHealthCertificate::UnknownSignature;
     }
-    std::visit(visitor([&data](auto &cert) { cert.setRawData(data); }), m_cert);
-    return std::visit([](const auto &cert) { return QVariant::fromValue(cert); }, m_cert);
 }
 
 void EuDgcParser::parseCertificate(QCborStreamReader &reader) const
@@ -138,7 +180,8 @@ void EuDgcParser::parseCertificate(QCborStreamReader &reader) const
     reader.enterContainer();
     const auto version = CborUtils::readInteger(reader);
     if (version != 1) {
-        qCWarning(Log) << "unknown EU DGC version:" << version;
+        qCDebug(Log) << "unknown EU DGC version:" << version;
+        ParseContext::setReason(KHealthCertificatePipeline::UnsupportedVersion);
         return;
     }
 
@@ -169,13 +212,13 @@ void EuDgcParser::parseCertificateV1(QCborStreamReader &reader) const
             dob = QDate::fromString(CborUtils::readString(reader), Qt::ISODate);
         } else {
             qCDebug(Log) << "unhandled element:" << key;
-            reader.next();
+            CborUtils::skip(reader);
         }
     }
     reader.leaveContainer();
 
-    std::visit(visitor([&name](auto &cert) { cert.setName(name); }), m_cert);
-    std::visit(visitor([&dob](auto &cert) { cert.setDateOfBirth(dob); }), m_cert);
+    std::visit(visitor([&name](auto &cert) { cert.setName(std::move(name)); }), m_cert);
+    std::visit(visitor([&dob](auto &cert) { cert.setDateOfBirth(std::move(dob)); }), m_cert);
 }
 
 void EuDgcParser::parseCertificateArray(QCborStreamReader &reader, void (EuDgcParser::*func)(QCborStreamReader&) const) const
@@ -195,42 +238,41 @@ void EuDgcParser::parseVaccinationCertificate(QCborStreamReader& reader) const
     if (!reader.isMap()) {
         return;
     }
-    KVaccinationCertificate cert;
+    KHealthCertificateInternal::CertificateBuilder<KVaccinationCertificatePrivate> cert;
     reader.enterContainer();
     while (reader.hasNext()) {
         const auto key = CborUtils::readString(reader);
         if (key == QLatin1String("tg")) {
-            cert.setDisease(translateValue(key, CborUtils::readString(reader)));
+            cert->disease = translateValue(key, CborUtils::readString(reader));
         } else if (key == QLatin1String("vp")) {
-            cert.setVaccineType(translateValue(key, CborUtils::readString(reader)));
+            cert->vaccineType = translateValue(key, CborUtils::readString(reader));
         } else if (key == QLatin1String("dt")) {
-            cert.setDate(QDate::fromString(CborUtils::readString(reader), Qt::ISODate));
+            cert->date = QDate::fromString(CborUtils::readString(reader), Qt::ISODate);
         } else if (key == QLatin1String("mp")) {
             const auto productId = CborUtils::readString(reader);
-            cert.setVaccine(translateValue(key,productId));
+            cert->vaccine = translateValue(key,productId);
             if (productId.startsWith(QLatin1String("EU/")) && productId.count(QLatin1Char('/')) == 3) {
-                const auto num = QStringView(productId).mid(productId.lastIndexOf(QLatin1Char('/')) + 1);
-                cert.setVaccineUrl(QUrl(QLatin1String("https://ec.europa.eu/health/documents/community-register/html/h") + num + QLatin1String(".htm")));
+                cert->vaccineUrl.setProducer(vaccineUrl, productId);
             }
         } else if (key == QLatin1String("ma")) {
-            cert.setManufacturer(translateValue(key, CborUtils::readString(reader)));
+            cert->manufacturer = translateValue(key, CborUtils::readString(reader));
         } else if (key == QLatin1String("dn")) {
-            cert.setDose(CborUtils::readInteger(reader));
+            cert->dose = CborUtils::readInteger(reader);
         } else if (key == QLatin1String("sd")) {
-            cert.setTotalDoses(CborUtils::readInteger(reader));
+            cert->totalDoses = CborUtils::readInteger(reader);
         } else if (key == QLatin1String("co")) {
-            cert.setCountry(CborUtils::readString(reader));
+            cert->country = StringPool::intern(CborUtils::readString(reader));
         } else if (key == QLatin1String("is")) {
-            cert.setCertificateIssuer(CborUtils::readString(reader));
+            cert->certificateIssuer = CborUtils::readString(reader);
         } else if (key == QLatin1String("ci")) {
-            cert.setCertificateId(CborUtils::readString(reader));
+            cert->certificateId = CborUtils::readString(reader);
         } else {
             qCDebug(Log) << "unhandled vaccine key:" << key;
-            reader.next();
+            CborUtils::skip(reader);
         }
     }
     reader.leaveContainer();
-    m_cert = std::move(cert);
+    m_cert = cert.build();
 }
 
 void EuDgcParser::parseTestCertificate(QCborStreamReader &reader) const
@@ -238,41 +280,41 @@ void EuDgcParser::parseTestCertificate(QCborStreamReader &reader) const
     if (!reader.isMap()) {
         return;
     }
-    KTestCertificate cert;
+    KHealthCertificateInternal::CertificateBuilder<KTestCertificatePrivate> cert;
     reader.enterContainer();
     while (reader.hasNext()) {
         const auto key = CborUtils::readString(reader);
         if (key == QLatin1String("tg")) {
-            cert.setDisease(translateValue(key, CborUtils::readString(reader)));
+            cert->disease = translateValue(key, CborUtils::readString(reader));
         } else if (key == QLatin1String("tt")) {
-            cert.setTestType(translateValue(QLatin1String("tcTt"), CborUtils::readString(reader)));
+            cert->testType = translateValue(QLatin1String("tcTt"), CborUtils::readString(reader));
         } else if (key == QLatin1String("nm")) {
-            cert.setTestName(CborUtils::readString(reader));
+            cert->testName = CborUtils::readString(reader);
         } else if (key == QLatin1String("ma")) {
             const auto productId = CborUtils::readString(reader);
-            cert.setTestName(translateValue(QLatin1String("tcMa"), productId));
-            cert.setTestUrl(QUrl(QLatin1String("https://covid-19-diagnostics.jrc.ec.europa.eu/devices/detail/") + productId));
+            cert->testName = translateValue(QLatin1String("tcMa"), productId);
+            cert->testUrl.setProducer(testUrl, productId);
         } else if (key == QLatin1String("sc")) {
-            cert.setDate(QDate::fromString(CborUtils::readString(reader), Qt::ISODate));
+            cert->date = QDate::fromString(CborUtils::readString(reader), Qt::ISODate);
         } else if (key == QLatin1String("tr")) {
             const auto value = CborUtils::readString(reader);
-            cert.setResultString(translateValue(QLatin1String("tcTr"), value));
-            cert.setResult(value == QLatin1String("260415000") ? KTestCertificate::Negative : KTestCertificate::Positive);
+            cert->resultString = translateValue(QLatin1String("tcTr"), value);
+            cert->result = value == QLatin1String("260415000") ? KTestCertificate::Negative : KTestCertificate::Positive;
         } else if (key == QLatin1String("tc")) {
-            cert.setTestCenter(CborUtils::readString(reader));
+            cert->testCenter = CborUtils::readString(reader);
         } else if (key == QLatin1String("co")) {
-            cert.setCountry(CborUtils::readString(reader));
+            cert->country = StringPool::intern(CborUtils::readString(reader));
         } else if (key == QLatin1String("is")) {
-            cert.setCertificateIssuer(CborUtils::readString(reader));
+            cert->certificateIssuer = CborUtils::readString(reader);
         } else if (key == QLatin1String("ci")) {
-            cert.setCertificateId(CborUtils::readString(reader));
+            cert->certificateId = CborUtils::readString(reader);
         } else {
             qCDebug(Log) << "unhandled test key:" << key;
-            reader.next();
+            CborUtils::skip(reader);
         }
     }
     reader.leaveContainer();
-    m_cert = std::move(cert);
+    m_cert = cert.build();
 }
 
 void EuDgcParser::parseRecoveryCertificate(QCborStreamReader &reader) const
@@ -280,29 +322,29 @@ void EuDgcParser::parseRecoveryCertificate(QCborStreamReader &reader) const
     if (!reader.isMap()) {
         return;
     }
-    KRecoveryCertificate cert;
+    KHealthCertificateInternal::CertificateBuilder<KRecoveryCertificatePrivate> cert;
     reader.enterContainer();
     while (reader.hasNext()) {
         const auto key = CborUtils::readString(reader);
        if (key == QLatin1String("tg")) {
-            cert.setDisease(translateValue(key, CborUtils::readString(reader)));
+            cert->disease = translateValue(key, CborUtils::readString(reader));
         } else if (key == QLatin1String("fr")) {
-            cert.setDateOfPositiveTest(QDate::fromString(CborUtils::readString(reader), Qt::ISODate));
+            cert->dateOfPositiveTest = QDate::fromString(CborUtils::readString(reader), Qt::ISODate);
         } else if (key == QLatin1String("df")) {
-            cert.setValidFrom(QDate::fromString(CborUtils::readString(reader), Qt::ISODate));
+            cert->validFrom = QDate::fromString(CborUtils::readString(reader), Qt::ISODate);
         } else if (key == QLatin1String("du")) {
-            cert.setValidUntil(QDate::fromString(CborUtils::readString(reader), Qt::ISODate));
+            cert->validUntil = QDate::fromString(CborUtils::readString(reader), Qt::ISODate);
         } else if (key == QLatin1String("is")) {
-            cert.setCertificateIssuer(CborUtils::readString(reader));
+            cert->certificateIssuer = CborUtils::readString(reader);
         } else if (key == QLatin1String("ci")) {
-            cert.setCertificateId(CborUtils::readString(reader));
+            cert->certificateId = CborUtils::readString(reader);
         } else {
             qCDebug(Log) << "unhandled recovery key:" << key;
-            reader.next();
+            CborUtils::skip(reader);
         }
     }
     reader.leaveContainer();
-    m_cert = std::move(cert);
+    m_cert = cert.build();
 }
 
 QString EuDgcParser::parseName(QCborStreamReader &reader) const
@@ -319,7 +361,7 @@ QString EuDgcParser::parseName(QCborStreamReader &reader) const
         } else if (key == QLatin1String("gn")) {
             gn = CborUtils::readString(reader);
         } else {
-            reader.next();
+            CborUtils::skip(reader);
         }
     }
     reader.leaveContainer();
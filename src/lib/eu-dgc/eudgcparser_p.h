@@ -6,17 +6,15 @@
 #ifndef EUDGCPARSER_P_H
 #define EUDGCPARSER_P_H
 
-#include "krecoverycertificate.h"
-#include "ktestcertificate.h"
-#include "kvaccinationcertificate.h"
+#include "khealthcertificateparser.h"
 
 #include <QString>
 
-#include <variant>
+class CoseParser;
 
 class QByteArray;
 class QCborStreamReader;
-class QVariant;
+class QDateTime;
 
 /** Parser for EU DGC certificates. */
 class EuDgcParser
@@ -24,10 +22,23 @@ class EuDgcParser
 public:
     EuDgcParser();
     ~EuDgcParser();
-    QVariant parse(const QByteArray &data) const;
 
     static void init();
 
+    /** Decode the base45 transport encoding, including the format prefix.
+     *  @returns the compressed COSE data, or an empty byte array for invalid input.
+     */
+    static QByteArray decodeTransport(const QByteArray &data);
+    /** Decompress the transport decoded data. */
+    static QByteArray decompress(const QByteArray &data);
+    /** Map the CBOR payload of the COSE envelope to a certificate.
+     *  The signature state of the result is not set yet.
+     *  @param rawData The original encoded input, for storing on the resulting certificate.
+     */
+    KHealthCertificateParser::Certificate parsePayload(const QByteArray &payload, const QByteArray &rawData) const;
+    /** Signature state for a certificate issued at @p issueDate with the verified envelope @p cose. */
+    static KHealthCertificate::SignatureValidation signatureState(const CoseParser &cose, const QDateTime &issueDate);
+
 private:
     void parseCertificate(QCborStreamReader &reader) const;
     void parseCertificateV1(QCborStreamReader &reader) const;
@@ -37,7 +48,7 @@ private:
     void parseRecoveryCertificate(QCborStreamReader &reader) const;
     QString parseName(QCborStreamReader &reader) const;
 
-    mutable std::variant<std::monostate, KVaccinationCertificate, KTestCertificate, KRecoveryCertificate> m_cert;
+    mutable KHealthCertificateParser::Certificate m_cert;
 };
 
 #endif // EUDGCPARSER_P_H
@@ -0,0 +1,139 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "icaocscaregistry_p.h"
+#include "khealthcertificateparsersession_p.h"
+#include "logging.h"
+#include "parsecontext_p.h"
+
+#include "openssl/x509loader_p.h"
+#include "openssl/x509validationcache_p.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+
+#include <openssl/x509v3.h>
+
+#include <algorithm>
+
+// ICAO CSCAs commonly use explicit EC curve parameters, which OpenSSL 3 rejects by default
+static int verifyCallback(int ok, X509_STORE_CTX *ctx)
+{
+#ifdef X509_V_ERR_EC_KEY_EXPLICIT_PARAMS
+    if (!ok && X509_STORE_CTX_get_error(ctx) == X509_V_ERR_EC_KEY_EXPLICIT_PARAMS) {
+        return 1;
+    }
+#else
+    Q_UNUSED(ctx)
+#endif
+    return ok;
+}
+
+// CSCA certificates are stored as <hex key id>.der, or as <hex key id>/<n>.der
+// if there are multiple certificates for the same key id.
+IcaoCscaRegistry::IcaoCscaRegistry()
+    : m_store(X509_STORE_new())
+{
+    // CSCA link certificates are not self-signed, but trusted nevertheless
+    X509_STORE_set_flags(m_store.get(), X509_V_FLAG_PARTIAL_CHAIN);
+    X509_STORE_set_verify_cb(m_store.get(), verifyCallback);
+
+    const QString basePath = QStringLiteral(":/org.kde.khealthcertificate/icao/certs");
+    for (QDirIterator it(basePath, QDir::Files, QDirIterator::Subdirectories); it.hasNext();) {
+        const QFileInfo fi(it.next());
+        if (fi.suffix() != QLatin1String("der")) {
+            continue;
+        }
+        const auto keyIdStr = fi.path() == basePath ? fi.completeBaseName() : fi.dir().dirName();
+        loadCertificate(QByteArray::fromHex(keyIdStr.toLatin1()), fi.filePath());
+    }
+    qCDebug(Log) << m_keyIds.size() << "CSCA key ids loaded";
+}
+
+IcaoCscaRegistry& IcaoCscaRegistry::instance()
+{
+    static IcaoCscaRegistry s_registry;
+    return s_registry;
+}
+
+void IcaoCscaRegistry::loadCertificate(const QByteArray &keyId, const QString &fileName)
+{
+    QFile f(fileName);
+    if (keyId.isEmpty() || !f.open(QFile::ReadOnly)) {
+        qCWarning(Log) << "failed to load CSCA certificate" << fileName << f.errorString();
+        return;
+    }
+
+    const auto x509Cert = X509Loader::readFromDER(f.readAll());
+    if (!x509Cert || X509_STORE_add_cert(m_store.get(), x509Cert.get()) != 1) {
+        qCWarning(Log) << "invalid CSCA certificate" << fileName;
+        return;
+    }
+    m_keyIds.insert(keyId);
+}
+
+KHealthCertificate::SignatureValidation IcaoCscaRegistry::verifyChain(X509 *cert, QDateTime &expiry) const
+{
+    expiry = X509ValidationCache::expiryTime(cert);
+
+    const auto keyId = X509_get0_authority_key_id(cert);
+    if (!keyId) {
+        return KHealthCertificate::InvalidSignature;
+    }
+    if (!m_keyIds.contains(QByteArray::fromRawData(reinterpret_cast<const char*>(keyId->data), keyId->length))) {
+        qCDebug(Log) << "No CSCA certificate found for key id" << QByteArray(reinterpret_cast<const char*>(keyId->data), keyId->length).toHex();
+        return KHealthCertificate::UnknownSignature;
+    }
+
+    if (!ParseContext::addCryptoOperation()) {
+        expiry = {};
+        return KHealthCertificate::UnknownSignature;
+    }
+    auto session = ParseContext::session();
+    openssl::x509_store_ctx_ptr ownCtx;
+    auto ctx = session ? session->storeContext() : nullptr;
+    if (!ctx) {
+        ownCtx.reset(X509_STORE_CTX_new());
+        ctx = ownCtx.get();
+    }
+    if (!ctx || X509_STORE_CTX_init(ctx, m_store.get(), cert, nullptr) != 1) {
+        expiry = {};
+        return KHealthCertificate::UnknownSignature;
+    }
+    if (X509_verify_cert(ctx) != 1) {
+        const auto error = X509_STORE_CTX_get_error(ctx);
+        qCDebug(Log) << "certificate chain validation failed:" << X509_verify_cert_error_string(error);
+        if (error == X509_V_ERR_CERT_NOT_YET_VALID) {
+            expiry = {}; // can change any time, don't cache this
+        }
+        return KHealthCertificate::InvalidSignature;
+    }
+
+    // the chain is valid until its first certificate expires
+    const auto chain = X509_STORE_CTX_get0_chain(ctx);
+    for (int i = 0; i < sk_X509_num(chain); ++i) {
+        expiry = std::min(expiry, X509ValidationCache::expiryTime(sk_X509_value(chain, i)));
+    }
+    return KHealthCertificate::UncheckedSignature;
+}
+
+KHealthCertificate::SignatureValidation IcaoCscaRegistry::verifyCertificate(X509 *cert)
+{
+    if (!cert) {
+        return KHealthCertificate::InvalidSignature;
+    }
+
+    // per thread, so lookups don't contend on a shared lock
+    static thread_local X509ValidationCache s_cache;
+    if (const auto result = s_cache.lookup(cert)) {
+        return *result;
+    }
+
+    QDateTime expiry;
+    const auto result = instance().verifyChain(cert, expiry);
+    s_cache.insert(cert, result, expiry);
+    return result;
+}
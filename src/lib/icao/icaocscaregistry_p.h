@@ -0,0 +1,40 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef ICAOCSCAREGISTRY_P_H
+#define ICAOCSCAREGISTRY_P_H
+
+#include "khealthcertificate.h"
+#include "openssl/opensslpp_p.h"
+
+#include <QByteArray>
+#include <QSet>
+
+/** Known ICAO country signing CAs (CSCA).
+ *  All CSCA certificates are loaded once on first use, into a trust store used
+ *  for validating document signer certificates, and indexed by the key identifier
+ *  document signer certificates refer to in their authority key identifier extension.
+ *  The registry is immutable after loading, and can be used from multiple threads without locking.
+ */
+class IcaoCscaRegistry
+{
+public:
+    /** Validates the certificate chain of document signer certificate @p cert.
+     *  Results are cached, so this is cheap for repeatedly seen document signers.
+     *  @returns UncheckedSignature if the certificate chain is valid.
+     */
+    static KHealthCertificate::SignatureValidation verifyCertificate(X509 *cert);
+
+private:
+    explicit IcaoCscaRegistry();
+    static IcaoCscaRegistry& instance();
+    void loadCertificate(const QByteArray &keyId, const QString &fileName);
+    KHealthCertificate::SignatureValidation verifyChain(X509 *cert, QDateTime &expiry) const;
+
+    openssl::x509_store_ptr m_store;
+    QSet<QByteArray> m_keyIds;
+};
+
+#endif // ICAOCSCAREGISTRY_P_H
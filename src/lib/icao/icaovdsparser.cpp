@@ -4,25 +4,37 @@
 */
 
 #include "icaovdsparser_p.h"
+#include "icaocscaregistry_p.h"
+#include "khealthcertificateparsersession_p.h"
+#include "json/jsoncanonicalizer_p.h"
+#include "json/jsonstreamreader_p.h"
+#include "ktestcertificate_p.h"
+#include "kvaccinationcertificate_p.h"
 #include "logging.h"
+#include "parsecontext_p.h"
+#include "stringpool_p.h"
+#include "tracepoints_p.h"
 
 #include <openssl/opensslpp_p.h>
 #include <openssl/verify_p.h>
-#include <openssl/x509loader_p.h>
-
-#include <openssl/x509v3.h>
 
+#include <KHealthCertificatePipeline>
 #include <KTestCertificate>
 #include <KVaccinationCertificate>
 
 #include <KCountry>
 
-#include <QDirIterator>
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 
+#include <openssl/x509v3.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 void IcaoVdsParser::init()
 {
     Q_INIT_RESOURCE(icao_csca_certs);
@@ -47,83 +59,176 @@ static int jsonValueToInt(const QJsonValue &v)
     return 0;
 }
 
-static QString lookupDisease(const QString &code)
+static QJsonObject loadLookupTable(const QString &fileName)
 {
-    QFile f(QLatin1String(":/org.kde.khealthcertificate/icao/data/diseases.json"));
+    QFile f(fileName);
     if (!f.open(QFile::ReadOnly)) {
         qCWarning(Log) << f.fileName() << f.errorString();
-        return code;
+        return {};
     }
+    return QJsonDocument::fromJson(f.readAll()).object();
+}
 
-    const auto obj = QJsonDocument::fromJson(f.readAll()).object();
-    const auto name = obj.value(code.left(4)).toString();
-    return name.isEmpty() ? code : name;
+static QString lookupDisease(const QString &code)
+{
+    static const auto s_diseases = loadLookupTable(QStringLiteral(":/org.kde.khealthcertificate/icao/data/diseases.json"));
+    const auto name = s_diseases.value(code.left(4)).toString();
+    return StringPool::intern(name.isEmpty() ? code : name);
 }
 
 static QString lookupVaccine(const QString &code)
 {
-    QFile f(QLatin1String(":/org.kde.khealthcertificate/icao/data/vaccines.json"));
-    if (!f.open(QFile::ReadOnly)) {
-        qCWarning(Log) << f.fileName() << f.errorString();
-        return code;
-    }
-
-    const auto obj = QJsonDocument::fromJson(f.readAll()).object();
-    const auto name = obj.value(code).toString();
-    return name.isEmpty() ? code : name;
+    static const auto s_vaccines = loadLookupTable(QStringLiteral(":/org.kde.khealthcertificate/icao/data/vaccines.json"));
+    const auto name = s_vaccines.value(code).toString();
+    return StringPool::intern(name.isEmpty() ? code : name);
 }
 
 static QString alpha3ToAlpha2(const QString &alpha3)
 {
     const auto c = KCountry::fromAlpha3(alpha3);
-    return c.isValid() ? c.alpha2() : alpha3;
+    return StringPool::intern(c.isValid() ? c.alpha2() : alpha3);
 }
 
-static KHealthCertificate::SignatureValidation verifyCertificate(const openssl::x509_ptr &x509Cert)
+// member names must match literally and only occur once, otherwise the signed member
+// might not be the one QJsonDocument picks for display
+static bool isUniquePlainName(QByteArrayView name, std::vector<QByteArrayView> &names)
 {
-    const auto keyId = X509_get0_authority_key_id(x509Cert.get());
-    if (!keyId) {
-        return KHealthCertificate::InvalidSignature;
+    if (name.isEmpty() || name.contains('\\') || std::find(names.begin(), names.end(), name) != names.end()) {
+        return false;
     }
-    const auto keyIdStr = QString::fromUtf8(QByteArray(reinterpret_cast<const char*>(keyId->data), keyId->length).toHex());
-    qCDebug(Log) << keyIdStr;
+    names.push_back(name);
+    return true;
+}
 
-    // single certificate file for keyId
-    QFile issuerCertFile(QLatin1String(":/org.kde.khealthcertificate/icao/certs/") + keyIdStr + QLatin1String(".der"));
-    if (issuerCertFile.open(QFile::ReadOnly)) {
-        const auto x509IssuerCert = X509Loader::readFromDER(issuerCertFile.readAll());
-        const openssl::evp_pkey_ptr issuerPkey(X509_get_pubkey(x509IssuerCert.get()));
-        const auto certValid = X509_verify(x509Cert.get(), issuerPkey.get());
-        if (certValid == 1) {
-            return KHealthCertificate::UncheckedSignature;
+static bool hasUniquePlainNames(JsonStreamReader &reader)
+{
+    if (!reader.enterContainer()) {
+        return false;
+    }
+    std::vector<QByteArrayView> names;
+    while (reader.hasNext()) {
+        if (!isUniquePlainName(reader.readName(), names)) {
+            return false;
         }
-        return KHealthCertificate::InvalidSignature;
-    }
-
-    // multiple certificates for keyId, try all of them
-    bool foundInvalid = false;
-    for (QDirIterator it(QLatin1String(":/org.kde.khealthcertificate/icao/certs/") + keyIdStr, QDir::Files); it.hasNext();) {
-        QFile issuerCertFile(it.next());
-        if (issuerCertFile.open(QFile::ReadOnly)) {
-            const auto x509IssuerCert = X509Loader::readFromDER(issuerCertFile.readAll());
-            const openssl::evp_pkey_ptr issuerPkey(X509_get_pubkey(x509IssuerCert.get()));
-            const auto certValid = X509_verify(x509Cert.get(), issuerPkey.get());
-            if (certValid == 1) {
-                return KHealthCertificate::UncheckedSignature;
-            }
-            foundInvalid = true;
-        } else {
-            qCWarning(Log) << issuerCertFile.fileName() << issuerCertFile.errorString();
+        reader.next();
+    }
+    return reader.leaveContainer();
+}
+
+// range of the signed "data" member in the input, begin is -1 if there is none or the envelope is ambiguous
+static std::pair<qsizetype, qsizetype> signedDataRange(const QByteArray &data)
+{
+    JsonStreamReader reader(data);
+    if (reader.isArray()) {
+        reader.enterContainer();
+    }
+    if (!reader.isObject()) {
+        return {-1, -1};
+    }
+    reader.enterContainer();
+    std::vector<QByteArrayView> names;
+    std::pair<qsizetype, qsizetype> range(-1, -1);
+    while (reader.hasNext()) {
+        const auto name = reader.readName();
+        if (!isUniquePlainName(name, names)) {
+            return {-1, -1};
         }
+        if (name != "data") {
+            reader.next();
+            continue;
+        }
+        range.first = reader.offset();
+        if (!reader.isObject() || !hasUniquePlainNames(reader)) {
+            return {-1, -1};
+        }
+        // leaving the container moved past any trailing separator
+        range.second = reader.offset();
+        while (range.second > range.first && data[range.second - 1] != '}') {
+            --range.second;
+        }
+    }
+    return reader.hasError() ? std::pair<qsizetype, qsizetype>(-1, -1) : range;
+}
+
+static bool verifyContentSignature(EVP_PKEY *pkey, const QString &alg, const QByteArray &data, const QJsonObject &dataObj, const QByteArray &signature)
+{
+    const EVP_MD *digest = nullptr;
+    if (alg == QLatin1String("ES256")) {
+        digest = EVP_sha256();
+    } else if (alg == QLatin1String("ES384")) {
+        digest = EVP_sha384();
+    } else if (alg == QLatin1String("ES512")) {
+        digest = EVP_sha512();
+    } else {
+        qCDebug(Log) << "signature algorithm not supported:" << alg;
+        ParseContext::setReason(KHealthCertificatePipeline::UnsupportedSignatureAlgorithm);
+        return false;
+    }
+
+    // what we display has to be exactly what is signed
+    const auto [offset, end] = signedDataRange(data);
+    if (offset < 0 || QJsonDocument::fromJson(QByteArray::fromRawData(data.constData() + offset, end - offset)).object() != dataObj) {
+        qCDebug(Log) << "ambiguous signed content";
+        ParseContext::setReason(KHealthCertificatePipeline::MalformedEnvelope);
+        return false;
     }
 
-    if (!foundInvalid) {
-        qCWarning(Log) << "No CSCA certificate found for key id" << keyId;
+    auto session = ParseContext::session();
+    openssl::evp_md_ctx_ptr ownCtx;
+    auto ctx = session ? session->digestContext() : nullptr;
+    if (!ctx) {
+        ownCtx.reset(EVP_MD_CTX_new());
+        ctx = ownCtx.get();
     }
-    return foundInvalid ? KHealthCertificate::InvalidSignature : KHealthCertificate::UnknownSignature;
+    if (!ctx || EVP_DigestInit_ex(ctx, digest, nullptr) != 1) {
+        return false;
+    }
+
+    // the signature is computed over the RFC 8785 canonical form of the "data" member,
+    // which we feed into the digest straight from the input
+    JsonCanonicalizer jcs(data, [ctx](const char *chunk, qsizetype size) { EVP_DigestUpdate(ctx, chunk, size); });
+    if (!jcs.canonicalize(offset)) {
+        return false;
+    }
+
+    uint8_t digestData[EVP_MAX_MD_SIZE];
+    unsigned int digestSize = 0;
+    if (EVP_DigestFinal_ex(ctx, digestData, &digestSize) != 1) {
+        return false;
+    }
+    return Verify::verifyECDSADigest(pkey, digestData, digestSize, signature.constData(), signature.size());
+}
+
+// removes insignificant whitespace, returns @p data unchanged if there is none
+static QByteArray compactJson(const QByteArray &data)
+{
+    QByteArray result;
+    bool inString = false;
+    for (qsizetype i = 0; i < data.size(); ++i) {
+        const auto c = data[i];
+        const bool isWhitespace = !inString && (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+        if (isWhitespace && result.isNull()) {
+            // only copy once we know there is something to remove
+            result.reserve(data.size());
+            result.append(data.constData(), i);
+        }
+        if (!isWhitespace && !result.isNull()) {
+            result.append(c);
+        }
+
+        if (inString && c == '\\' && i + 1 < data.size()) {
+            ++i;
+            if (!result.isNull()) {
+                result.append(data[i]);
+            }
+        } else if (c == '"') {
+            inString = !inString;
+        }
+    }
+    return result.isNull() ? data : result;
 }
 
-QVariant IcaoVdsParser::parse(const QByteArray &data)
+QJsonObject IcaoVdsParser::parseEnvelope(const QByteArray &data)
 {
     const auto doc = QJsonDocument::fromJson(data);
 
@@ -134,43 +239,58 @@ QVariant IcaoVdsParser::parse(const QByteArray &data)
         rootObj = doc.array().at(0).toObject(); // TODO multiple entries?
     }
 
-    const auto dataObj = rootObj.value(QLatin1String("data")).toObject();
-    const auto hdrObj = dataObj.value(QLatin1String("hdr")).toObject();
-    const auto msgObj = dataObj.value(QLatin1String("msg")).toObject();
-
+    const auto hdrObj = rootObj.value(QLatin1String("data")).toObject().value(QLatin1String("hdr")).toObject();
     if (hdrObj.value(QLatin1String("v")).toInt() != 1) {
         return {};
     }
+    return rootObj;
+}
 
-    const auto sigObj = rootObj.value(QLatin1String("sig")).toObject();
-
-    // verify certificate used for the signature
+static openssl::x509_ptr signerCertificate(const QJsonObject &vds)
+{
+    const auto sigObj = vds.value(QLatin1String("sig")).toObject();
     const auto cert = QByteArray::fromBase64(sigObj.value(QLatin1String("cer")).toString().toUtf8(), QByteArray::Base64UrlEncoding);
     const uint8_t *certData = reinterpret_cast<const uint8_t*>(cert.data());
-    const openssl::x509_ptr x509Cert(d2i_X509(nullptr, &certData, cert.size()));
-    KHealthCertificate::SignatureValidation sigState = verifyCertificate(x509Cert);
+    return openssl::x509_ptr(d2i_X509(nullptr, &certData, cert.size()));
+}
+
+QByteArray IcaoVdsParser::keyId(const QJsonObject &vds)
+{
+    const auto x509Cert = signerCertificate(vds);
+    const auto keyId = x509Cert ? X509_get0_authority_key_id(x509Cert.get()) : nullptr;
+    return keyId ? QByteArray(reinterpret_cast<const char*>(keyId->data), keyId->length) : QByteArray();
+}
+
+KHealthCertificate::SignatureValidation IcaoVdsParser::verifySignature(const QJsonObject &vds, const QByteArray &data)
+{
+    // verify certificate used for the signature
+    const auto x509Cert = signerCertificate(vds);
+    KHC_TRACEPOINT(key_lookup_begin, int(KHealthCertificatePipeline::IcaoVds));
+    KHealthCertificate::SignatureValidation sigState = IcaoCscaRegistry::verifyCertificate(x509Cert.get());
+    KHC_TRACEPOINT(key_lookup_end, int(KHealthCertificatePipeline::IcaoVds), sigState != KHealthCertificate::UnknownSignature);
+    if (sigState == KHealthCertificate::UnknownSignature) {
+        ParseContext::setReason(KHealthCertificatePipeline::UnknownSigningKey);
+    } else if (sigState == KHealthCertificate::InvalidSignature) {
+        ParseContext::setReason(KHealthCertificatePipeline::InvalidSigningCertificate);
+    }
 
     // verify that the content signature is correct
+    const auto sigObj = vds.value(QLatin1String("sig")).toObject();
     const openssl::evp_pkey_ptr pkey(X509_get_pubkey(x509Cert.get()));
     const auto alg = sigObj.value(QLatin1String("alg")).toString();
     const auto signature = QByteArray::fromBase64(sigObj.value(QLatin1String("sigvl")).toString().toUtf8(), QByteArray::Base64UrlEncoding);
-
-    // this need RFC 8785 JSON canonicalization
-    const auto signedData = QJsonDocument(dataObj).toJson(QJsonDocument::Compact);
-
-    bool valid = false;
-    if (alg == QLatin1String("ES256")) {
-        valid = Verify::verifyECDSA(pkey, EVP_sha256(), signedData.constData(), signedData.size(), signature.constData(), signature.size());
-    } else if (alg == QLatin1String("ES384")) {
-        valid = Verify::verifyECDSA(pkey, EVP_sha384(), signedData.constData(), signedData.size(), signature.constData(), signature.size());
-    } else if (alg == QLatin1String("ES512")) {
-        valid = Verify::verifyECDSA(pkey, EVP_sha512(), signedData.constData(), signedData.size(), signature.constData(), signature.size());
-    } else {
-        qCWarning(Log) << "signature algorithm not supported:" << alg;
-    }
+    const auto valid = verifyContentSignature(pkey.get(), alg, data, vds.value(QLatin1String("data")).toObject(), signature);
     if (valid && sigState == KHealthCertificate::UncheckedSignature) {
         sigState = KHealthCertificate::ValidSignature;
     }
+    return sigState;
+}
+
+KHealthCertificateParser::Certificate IcaoVdsParser::parsePayload(const QJsonObject &vds, const QByteArray &data)
+{
+    const auto dataObj = vds.value(QLatin1String("data")).toObject();
+    const auto hdrObj = dataObj.value(QLatin1String("hdr")).toObject();
+    const auto msgObj = dataObj.value(QLatin1String("msg")).toObject();
 
     const auto type = hdrObj.value(QLatin1String("t")).toString();
     if (type == QLatin1String("icao.vacc")) {
@@ -201,9 +321,7 @@ QVariant IcaoVdsParser::parse(const QByteArray &data)
             }
         }
 
-        const auto compactData = doc.toJson(QJsonDocument::Compact);
-        cert.setRawData(compactData.size() < data.size() ? compactData : data);
-        cert.setSignatureState(sigState);
+        KVaccinationCertificatePrivate::get(cert)->rawData.setProducer(compactJson, data);
         return cert;
     }
 
@@ -231,9 +349,7 @@ QVariant IcaoVdsParser::parse(const QByteArray &data)
             cert.setResult(KTestCertificate::Unknown);
         }
 
-        const auto compactData = doc.toJson(QJsonDocument::Compact);
-        cert.setRawData(compactData.size() < data.size() ? compactData : data);
-        cert.setSignatureState(sigState);
+        KTestCertificatePrivate::get(cert)->rawData.setProducer(compactJson, data);
         return cert;
     }
 
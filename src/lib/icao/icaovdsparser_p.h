@@ -6,15 +6,31 @@
 #ifndef ICAOVDSPARSER_H
 #define ICAOVDSPARSER_H
 
+#include "khealthcertificate.h"
+#include "khealthcertificateparser.h"
+
 class QByteArray;
-class QVariant;
+class QJsonObject;
 
 /** Parser foe ICAO VDS-NC certificats. */
 class IcaoVdsParser
 {
 public:
     static void init();
-    static QVariant parse(const QByteArray &data);
+
+    /** Parse the VDS envelope.
+     *  @returns the VDS root object, or an empty object for invalid or unsupported input.
+     */
+    static QJsonObject parseEnvelope(const QByteArray &data);
+    /** Authority key id of the signer certificate, ie. the key id of the issuing CSCA. */
+    static QByteArray keyId(const QJsonObject &vds);
+    /** Map the VDS message to a certificate.
+     *  The signature state of the result is not set yet.
+     *  @param data The original input, for storing on the resulting certificate.
+     */
+    static KHealthCertificateParser::Certificate parsePayload(const QJsonObject &vds, const QByteArray &data);
+    /** Verify the signer certificate and the signature of @p data. */
+    static KHealthCertificate::SignatureValidation verifySignature(const QJsonObject &vds, const QByteArray &data);
 };
 
 #endif // ICAOVDSPARSER_H
@@ -0,0 +1,454 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "jsoncanonicalizer_p.h"
+#include "logging.h"
+#include "parsecontext_p.h"
+
+#include <QString>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+static constexpr bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+JsonCanonicalizer::JsonCanonicalizer(QByteArrayView data, Sink sink)
+    : m_data(data)
+    , m_sink(std::move(sink))
+{
+}
+
+JsonCanonicalizer::~JsonCanonicalizer() = default;
+
+bool JsonCanonicalizer::canonicalize(qsizetype offset)
+{
+    if (!writeValue(offset, 0)) {
+        qCDebug(Log) << "JSON canonicalization failed at offset" << offset;
+        return false;
+    }
+    return true;
+}
+
+bool JsonCanonicalizer::writeValue(qsizetype &pos, int depth)
+{
+    skipWhitespace(pos);
+    if (pos >= m_data.size()) {
+        return false;
+    }
+
+    switch (m_data[pos]) {
+        case '{':
+            return writeObject(pos, depth + 1);
+        case '[':
+            return writeArray(pos, depth + 1);
+        case '"':
+            return writeString(pos);
+        case 't':
+        case 'f':
+        case 'n':
+            return writeLiteral(pos);
+    }
+    return writeNumber(pos);
+}
+
+bool JsonCanonicalizer::writeObject(qsizetype &pos, int depth)
+{
+    if (!ParseContext::checkLimit(depth, ParseContext::limits().maximumNestingDepth, "JSON nesting depth")) {
+        return false;
+    }
+    ++pos;
+
+    // first pass: validate and record member names and positions
+    struct Member {
+        QString name;
+        qsizetype nameOffset;
+        qsizetype valueOffset;
+    };
+    std::vector<Member> members;
+
+    skipWhitespace(pos);
+    if (pos < m_data.size() && m_data[pos] == '}') {
+        ++pos;
+        write("{}", 2);
+        return true;
+    }
+    while (true) {
+        skipWhitespace(pos);
+        Member member;
+        member.nameOffset = pos;
+        bool hasEscapes = false;
+        if (!readString(pos, member.name, hasEscapes) || !consume(pos, ':')) {
+            return false;
+        }
+        member.valueOffset = pos;
+        ++m_discard;
+        const auto valid = writeValue(pos, depth);
+        --m_discard;
+        if (!valid) {
+            return false;
+        }
+        members.push_back(std::move(member));
+
+        skipWhitespace(pos);
+        if (pos < m_data.size() && m_data[pos] == ',') {
+            ++pos;
+            continue;
+        }
+        break;
+    }
+    if (!consume(pos, '}')) {
+        return false;
+    }
+    if (m_discard) {
+        return true;
+    }
+
+    // second pass: write members ordered by the UTF-16 code units of their names
+    std::sort(members.begin(), members.end(), [](const auto &lhs, const auto &rhs) { return lhs.name < rhs.name; });
+    if (std::adjacent_find(members.begin(), members.end(), [](const auto &lhs, const auto &rhs) { return lhs.name == rhs.name; }) != members.end()) {
+        return false; // duplicate names
+    }
+    write("{", 1);
+    for (auto it = members.begin(); it != members.end(); ++it) {
+        if (it != members.begin()) {
+            write(",", 1);
+        }
+        auto namePos = it->nameOffset;
+        writeString(namePos);
+        write(":", 1);
+        auto valuePos = it->valueOffset;
+        writeValue(valuePos, depth);
+    }
+    write("}", 1);
+    return true;
+}
+
+bool JsonCanonicalizer::writeArray(qsizetype &pos, int depth)
+{
+    if (!ParseContext::checkLimit(depth, ParseContext::limits().maximumNestingDepth, "JSON nesting depth")) {
+        return false;
+    }
+    ++pos;
+
+    write("[", 1);
+    skipWhitespace(pos);
+    if (pos < m_data.size() && m_data[pos] == ']') {
+        ++pos;
+        write("]", 1);
+        return true;
+    }
+    while (true) {
+        if (!writeValue(pos, depth)) {
+            return false;
+        }
+        skipWhitespace(pos);
+        if (pos < m_data.size() && m_data[pos] == ',') {
+            write(",", 1);
+            ++pos;
+            continue;
+        }
+        break;
+    }
+    if (!consume(pos, ']')) {
+        return false;
+    }
+    write("]", 1);
+    return true;
+}
+
+bool JsonCanonicalizer::writeString(qsizetype &pos)
+{
+    const auto begin = pos;
+    QString s;
+    bool hasEscapes = false;
+    if (!readString(pos, s, hasEscapes)) {
+        return false;
+    }
+    if (m_discard) {
+        return true;
+    }
+
+    // without escapes the input already is in canonical form
+    if (!hasEscapes) {
+        write(m_data.constData() + begin, pos - begin);
+        return true;
+    }
+
+    const auto utf8 = s.toUtf8();
+    QByteArray out;
+    out.reserve(utf8.size() + 2);
+    out += '"';
+    for (const auto c : utf8) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    static constexpr const char hexDigits[] = "0123456789abcdef";
+                    out += "\\u00";
+                    out += hexDigits[c >> 4];
+                    out += hexDigits[c & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+    write(out.constData(), out.size());
+    return true;
+}
+
+bool JsonCanonicalizer::writeNumber(qsizetype &pos)
+{
+    // validate against the JSON number grammar first, std::from_chars is more lenient
+    const auto begin = pos;
+    auto digits = [this, &pos]() {
+        const auto start = pos;
+        while (pos < m_data.size() && isDigit(m_data[pos])) {
+            ++pos;
+        }
+        return pos - start;
+    };
+    if (pos < m_data.size() && m_data[pos] == '-') {
+        ++pos;
+    }
+    const auto intBegin = pos;
+    const auto intDigits = digits();
+    if (intDigits == 0 || (intDigits > 1 && m_data[intBegin] == '0')) {
+        return false;
+    }
+    if (pos < m_data.size() && m_data[pos] == '.') {
+        ++pos;
+        if (digits() == 0) {
+            return false;
+        }
+    }
+    if (pos < m_data.size() && (m_data[pos] == 'e' || m_data[pos] == 'E')) {
+        ++pos;
+        if (pos < m_data.size() && (m_data[pos] == '+' || m_data[pos] == '-')) {
+            ++pos;
+        }
+        if (digits() == 0) {
+            return false;
+        }
+    }
+
+    double value = 0.0;
+    const auto result = std::from_chars(m_data.constData() + begin, m_data.constData() + pos, value);
+    if (result.ec != std::errc() || result.ptr != m_data.constData() + pos) {
+        return false;
+    }
+    if (m_discard) {
+        return std::isfinite(value);
+    }
+
+    std::string out;
+    if (!formatNumber(value, out)) {
+        return false;
+    }
+    write(out.data(), out.size());
+    return true;
+}
+
+bool JsonCanonicalizer::writeLiteral(qsizetype &pos)
+{
+    for (const auto literal : { QByteArrayView("true"), QByteArrayView("false"), QByteArrayView("null") }) {
+        if (m_data.sliced(pos).startsWith(literal)) {
+            write(literal.constData(), literal.size());
+            pos += literal.size();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JsonCanonicalizer::readString(qsizetype &pos, QString &result, bool &hasEscapes)
+{
+    if (pos >= m_data.size() || m_data[pos] != '"') {
+        return false;
+    }
+
+    const auto begin = ++pos;
+    hasEscapes = false;
+    for (; pos < m_data.size() && m_data[pos] != '"'; ++pos) {
+        if (static_cast<unsigned char>(m_data[pos]) < 0x20) {
+            return false;
+        }
+        if (m_data[pos] == '\\') {
+            hasEscapes = true;
+            ++pos;
+        }
+    }
+    if (pos >= m_data.size()) {
+        return false;
+    }
+    const auto raw = m_data.sliced(begin, pos - begin);
+    ++pos;
+
+    if (!hasEscapes) {
+        result = QString::fromUtf8(raw);
+        return true;
+    }
+
+    result.clear();
+    result.reserve(raw.size());
+    qsizetype runBegin = 0;
+    for (qsizetype i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\\') {
+            continue;
+        }
+        result += QString::fromUtf8(raw.sliced(runBegin, i - runBegin));
+        switch (raw[++i]) {
+            case '"':
+            case '\\':
+            case '/':
+                result += QLatin1Char(raw[i]);
+                break;
+            case 'b':
+                result += QLatin1Char('\b');
+                break;
+            case 'f':
+                result += QLatin1Char('\f');
+                break;
+            case 'n':
+                result += QLatin1Char('\n');
+                break;
+            case 'r':
+                result += QLatin1Char('\r');
+                break;
+            case 't':
+                result += QLatin1Char('\t');
+                break;
+            case 'u':
+            {
+                bool ok = false;
+                const auto code = i + 4 < raw.size() ? raw.sliced(i + 1, 4).toUShort(&ok, 16) : 0;
+                if (!ok) {
+                    return false;
+                }
+                result += QChar(code);
+                i += 4;
+                break;
+            }
+            default:
+                return false;
+        }
+        runBegin = i + 1;
+    }
+    result += QString::fromUtf8(raw.sliced(runBegin));
+
+    // lone surrogates have no UTF-8 representation
+    return QStringView(result).isValidUtf16();
+}
+
+void JsonCanonicalizer::skipWhitespace(qsizetype &pos) const
+{
+    while (pos < m_data.size() && (m_data[pos] == ' ' || m_data[pos] == '\t' || m_data[pos] == '\n' || m_data[pos] == '\r')) {
+        ++pos;
+    }
+}
+
+bool JsonCanonicalizer::consume(qsizetype &pos, char c)
+{
+    skipWhitespace(pos);
+    if (pos >= m_data.size() || m_data[pos] != c) {
+        return false;
+    }
+    ++pos;
+    return true;
+}
+
+void JsonCanonicalizer::write(const char *data, qsizetype size)
+{
+    if (!m_discard) {
+        m_sink(data, size);
+    }
+}
+
+bool JsonCanonicalizer::formatNumber(double value, std::string &out)
+{
+    if (!std::isfinite(value)) {
+        return false;
+    }
+    if (value == 0.0) { // this includes -0
+        out += '0';
+        return true;
+    }
+    if (value < 0.0) {
+        out += '-';
+        value = -value;
+    }
+
+    // shortest representation that round-trips, as d.ddde±x
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    const auto expPos = static_cast<const char*>(std::memchr(buffer, 'e', result.ptr - buffer));
+    if (!expPos) {
+        return false;
+    }
+    int exponent = 0;
+    std::from_chars(expPos + (expPos[1] == '+' ? 2 : 1), result.ptr, exponent);
+
+    // value = 0.digits * 10^n, with k digits
+    char digits[20];
+    int k = 0;
+    for (auto it = buffer; it != expPos; ++it) {
+        if (*it != '.') {
+            digits[k++] = *it;
+        }
+    }
+    const int n = exponent + 1;
+
+    if (k <= n && n <= 21) {
+        out.append(digits, k);
+        out.append(n - k, '0');
+    } else if (0 < n && n <= 21) {
+        out.append(digits, n);
+        out += '.';
+        out.append(digits + n, k - n);
+    } else if (-6 < n && n <= 0) {
+        out += "0.";
+        out.append(-n, '0');
+        out.append(digits, k);
+    } else {
+        out += digits[0];
+        if (k > 1) {
+            out += '.';
+            out.append(digits + 1, k - 1);
+        }
+        out += 'e';
+        out += n - 1 >= 0 ? '+' : '-';
+        out += std::to_string(std::abs(n - 1));
+    }
+    return true;
+}
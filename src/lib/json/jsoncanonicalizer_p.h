@@ -0,0 +1,59 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef JSONCANONICALIZER_P_H
+#define JSONCANONICALIZER_P_H
+
+#include <QByteArrayView>
+
+#include <functional>
+#include <string>
+
+class QString;
+
+/** JSON Canonicalization Scheme (JCS).
+ *  Works directly on the JSON input, without building a DOM. Object members
+ *  are sorted by recording their position in the input, so the only state kept
+ *  is the member list of the objects currently being written.
+ *  @see RFC 8785
+ */
+class JsonCanonicalizer
+{
+public:
+    /** Receives the canonical output, in pieces. */
+    using Sink = std::function<void(const char *data, qsizetype size)>;
+
+    explicit JsonCanonicalizer(QByteArrayView data, Sink sink);
+    ~JsonCanonicalizer();
+
+    /** Canonicalize the JSON value starting at @p offset in the input.
+     *  @returns @c false for invalid input.
+     */
+    bool canonicalize(qsizetype offset);
+
+    /** Appends the canonical form of @p value to @p out.
+     *  This is the ECMAScript number serialization, see RFC 8785 § 3.2.2.3.
+     */
+    static bool formatNumber(double value, std::string &out);
+
+private:
+    bool writeValue(qsizetype &pos, int depth);
+    bool writeObject(qsizetype &pos, int depth);
+    bool writeArray(qsizetype &pos, int depth);
+    bool writeString(qsizetype &pos);
+    bool writeNumber(qsizetype &pos);
+    bool writeLiteral(qsizetype &pos);
+    bool readString(qsizetype &pos, QString &result, bool &hasEscapes);
+    void skipWhitespace(qsizetype &pos) const;
+    bool consume(qsizetype &pos, char c);
+    void write(const char *data, qsizetype size);
+
+    QByteArrayView m_data;
+    Sink m_sink;
+    // > 0 while values are only validated and skipped
+    int m_discard = 0;
+};
+
+#endif // JSONCANONICALIZER_P_H
@@ -0,0 +1,339 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "jsonstreamreader_p.h"
+#include "logging.h"
+#include "parsecontext_p.h"
+
+static constexpr bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// characters in numbers or literals (true, false, null)
+static constexpr bool isLiteralCharacter(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-' || c == '+' || c == '.';
+}
+
+JsonStreamReader::JsonStreamReader(QByteArrayView data)
+    : m_data(data)
+{
+    skipWhitespace();
+    if (m_pos >= m_data.size()) {
+        setError();
+    }
+}
+
+JsonStreamReader::~JsonStreamReader() = default;
+
+JsonStreamReader::Type JsonStreamReader::type() const
+{
+    if (m_error || m_pos >= m_data.size()) {
+        return Invalid;
+    }
+
+    switch (m_data[m_pos]) {
+        case '{':
+            return Object;
+        case '[':
+            return Array;
+        case '"':
+            return String;
+        case 't':
+        case 'f':
+            return Bool;
+        case 'n':
+            return Null;
+        case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return Number;
+    }
+    return Invalid;
+}
+
+qsizetype JsonStreamReader::offset() const
+{
+    return m_pos;
+}
+
+bool JsonStreamReader::hasError() const
+{
+    return m_error;
+}
+
+bool JsonStreamReader::enterContainer()
+{
+    const auto t = type();
+    if (t != Object && t != Array) {
+        return setError();
+    }
+    // this limits nesting depth for entered containers, skipped content is not affected by this
+    if (!ParseContext::checkLimit((qsizetype)m_containers.size() + 1, ParseContext::limits().maximumNestingDepth, "JSON nesting depth")) {
+        return setError();
+    }
+
+    m_containers.push_back(t == Object ? '}' : ']');
+    ++m_pos;
+    skipWhitespace();
+    return m_pos < m_data.size() || setError();
+}
+
+bool JsonStreamReader::leaveContainer()
+{
+    if (m_containers.empty()) {
+        return setError();
+    }
+
+    while (hasNext()) {
+        if (m_containers.back() == '}') {
+            readName();
+        }
+        next();
+    }
+    if (m_error || m_pos >= m_data.size() || m_data[m_pos] != m_containers.back()) {
+        return setError();
+    }
+
+    m_containers.pop_back();
+    ++m_pos;
+    return finishValue();
+}
+
+bool JsonStreamReader::hasNext() const
+{
+    return !m_error && !m_containers.empty() && m_pos < m_data.size() && m_data[m_pos] != m_containers.back();
+}
+
+QByteArrayView JsonStreamReader::readName()
+{
+    if (m_containers.empty() || m_containers.back() != '}' || type() != String) {
+        setError();
+        return {};
+    }
+
+    const auto begin = m_pos + 1;
+    if (!skipString()) {
+        return {};
+    }
+    const auto name = m_data.sliced(begin, m_pos - begin - 1);
+
+    skipWhitespace();
+    if (m_pos >= m_data.size() || m_data[m_pos] != ':') {
+        setError();
+        return {};
+    }
+    ++m_pos;
+    skipWhitespace();
+    if (m_pos >= m_data.size()) {
+        setError();
+        return {};
+    }
+    return name;
+}
+
+bool JsonStreamReader::next()
+{
+    if (m_error) {
+        return false;
+    }
+
+    // skipped content is only checked for balanced nesting
+    int depth = 0;
+    do {
+        if (m_pos >= m_data.size()) {
+            return setError();
+        }
+        const auto c = m_data[m_pos];
+        switch (c) {
+            case '{':
+            case '[':
+                ++depth;
+                ++m_pos;
+                break;
+            case '}':
+            case ']':
+                if (--depth < 0) {
+                    return setError();
+                }
+                ++m_pos;
+                break;
+            case '"':
+                if (!skipString()) {
+                    return false;
+                }
+                break;
+            case ',':
+            case ':':
+                if (depth == 0) {
+                    return setError();
+                }
+                ++m_pos;
+                break;
+            default:
+                if (isWhitespace(c)) {
+                    ++m_pos;
+                    break;
+                }
+                if (!isLiteralCharacter(c)) {
+                    return setError();
+                }
+                while (m_pos < m_data.size() && isLiteralCharacter(m_data[m_pos])) {
+                    ++m_pos;
+                }
+                break;
+        }
+    } while (depth > 0);
+
+    return finishValue();
+}
+
+QString JsonStreamReader::readString()
+{
+    if (type() != String) {
+        next();
+        return {};
+    }
+
+    const auto begin = m_pos + 1;
+    if (!skipString()) {
+        return {};
+    }
+    const auto raw = m_data.sliced(begin, m_pos - begin - 1);
+    auto result = m_stringHasEscapes ? unescape(raw) : QString::fromUtf8(raw);
+    finishValue();
+    return result;
+}
+
+double JsonStreamReader::readDouble()
+{
+    if (type() != Number) {
+        next();
+        return 0.0;
+    }
+
+    const auto begin = m_pos;
+    while (m_pos < m_data.size() && isLiteralCharacter(m_data[m_pos])) {
+        ++m_pos;
+    }
+    bool ok = false;
+    const auto result = m_data.sliced(begin, m_pos - begin).toDouble(&ok);
+    if (!ok) {
+        setError();
+        return 0.0;
+    }
+    finishValue();
+    return result;
+}
+
+bool JsonStreamReader::setError()
+{
+    if (!m_error) {
+        qCDebug(Log) << "invalid JSON at offset" << m_pos;
+    }
+    m_error = true;
+    return false;
+}
+
+void JsonStreamReader::skipWhitespace()
+{
+    while (m_pos < m_data.size() && isWhitespace(m_data[m_pos])) {
+        ++m_pos;
+    }
+}
+
+bool JsonStreamReader::skipString()
+{
+    m_stringHasEscapes = false;
+    for (++m_pos; m_pos < m_data.size(); ++m_pos) {
+        const auto c = m_data[m_pos];
+        if (c == '"') {
+            ++m_pos;
+            return true;
+        }
+        if (c == '\\') {
+            m_stringHasEscapes = true;
+            ++m_pos;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            break;
+        }
+    }
+    return setError();
+}
+
+// moves past the separator following a value, to the next element or the end of the current container
+bool JsonStreamReader::finishValue()
+{
+    skipWhitespace();
+    if (m_containers.empty()) {
+        return m_pos == m_data.size() || setError();
+    }
+    if (m_pos >= m_data.size()) {
+        return setError();
+    }
+
+    if (m_data[m_pos] == ',') {
+        ++m_pos;
+        skipWhitespace();
+        return (m_pos < m_data.size() && m_data[m_pos] != m_containers.back()) || setError();
+    }
+    return m_data[m_pos] == m_containers.back() || setError();
+}
+
+QString JsonStreamReader::unescape(QByteArrayView raw)
+{
+    QString result;
+    result.reserve(raw.size());
+    qsizetype runBegin = 0;
+    for (qsizetype i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\\') {
+            continue;
+        }
+        result += QString::fromUtf8(raw.sliced(runBegin, i - runBegin));
+
+        // skipString() ensures there is always a character following the backslash
+        switch (raw[++i]) {
+            case '"':
+            case '\\':
+            case '/':
+                result += QLatin1Char(raw[i]);
+                break;
+            case 'b':
+                result += QLatin1Char('\b');
+                break;
+            case 'f':
+                result += QLatin1Char('\f');
+                break;
+            case 'n':
+                result += QLatin1Char('\n');
+                break;
+            case 'r':
+                result += QLatin1Char('\r');
+                break;
+            case 't':
+                result += QLatin1Char('\t');
+                break;
+            case 'u':
+            {
+                bool ok = false;
+                const auto code = i + 4 < raw.size() ? raw.sliced(i + 1, 4).toUShort(&ok, 16) : 0;
+                if (!ok) {
+                    setError();
+                    return {};
+                }
+                result += QChar(code);
+                i += 4;
+                break;
+            }
+            default:
+                setError();
+                return {};
+        }
+        runBegin = i + 1;
+    }
+    result += QString::fromUtf8(raw.sliced(runBegin));
+    return result;
+}
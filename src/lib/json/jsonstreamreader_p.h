@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef JSONSTREAMREADER_P_H
+#define JSONSTREAMREADER_P_H
+
+#include <QByteArrayView>
+#include <QString>
+
+#include <vector>
+
+/** Pull parser for JSON data, without building a DOM.
+ *  Modeled after QCborStreamReader: the reader is positioned at a value,
+ *  containers are entered and left explicitly, and values not of interest
+ *  are skipped with next().
+ */
+class JsonStreamReader
+{
+public:
+    explicit JsonStreamReader(QByteArrayView data);
+    ~JsonStreamReader();
+
+    enum Type {
+        Invalid,
+        Object,
+        Array,
+        String,
+        Number,
+        Bool,
+        Null,
+    };
+    /** Type of the value at the current position. */
+    Type type() const;
+    inline bool isObject() const { return type() == Object; }
+    inline bool isArray() const { return type() == Array; }
+    inline bool isString() const { return type() == String; }
+    inline bool isNumber() const { return type() == Number; }
+
+    /** Position of the current value in the input data. */
+    qsizetype offset() const;
+
+    /** Returns @c true if the input was found to be invalid JSON. */
+    bool hasError() const;
+
+    /** Enter the object or array at the current position. */
+    bool enterContainer();
+    /** Leave the current container, skipping all remaining elements in it. */
+    bool leaveContainer();
+    /** Returns @c true if there are more elements in the current container. */
+    bool hasNext() const;
+
+    /** Read the name of the next member of the current object, and move to its value.
+     *  Escape sequences are not resolved, this is meant for matching against known ASCII names.
+     */
+    QByteArrayView readName();
+
+    /** Skip the value at the current position. */
+    bool next();
+    /** Read the string value at the current position, and forward the reader. */
+    QString readString();
+    /** Read the numeric value at the current position, and forward the reader. */
+    double readDouble();
+
+private:
+    bool setError();
+    void skipWhitespace();
+    bool skipString();
+    bool finishValue();
+    QString unescape(QByteArrayView raw);
+
+    QByteArrayView m_data;
+    qsizetype m_pos = 0;
+    // closing characters of the containers we are in
+    std::vector<char> m_containers;
+    bool m_stringHasEscapes = false;
+    bool m_error = false;
+};
+
+#endif // JSONSTREAMREADER_P_H
@@ -14,30 +14,39 @@
 QDateTime KHealthCertificate::relevantUntil(const QVariant &certificate)
 {
     if (certificate.userType() == qMetaTypeId<KVaccinationCertificate>()) {
-        const auto vac = certificate.value<KVaccinationCertificate>();
-        if (vac.certificateExpiryDate().isValid()) {
-            return vac.certificateExpiryDate();
-        }
-        return QDateTime(vac.date().addYears(1), {0, 0});
+        return relevantUntil(*static_cast<const KVaccinationCertificate*>(certificate.constData()));
     }
-
     if (certificate.userType() == qMetaTypeId<KTestCertificate>()) {
-        const auto test = certificate.value<KTestCertificate>();
-        if (test.certificateExpiryDate().isValid() && test.date().isValid()) {
-            return std::min(test.certificateExpiryDate(), QDateTime(test.date().addDays(2), {0, 0}));
-        }
-        if (test.certificateExpiryDate().isValid()) {
-            return test.certificateExpiryDate();
-        }
-        return QDateTime(test.date().addDays(2), {0, 0});
+        return relevantUntil(*static_cast<const KTestCertificate*>(certificate.constData()));
     }
-
     if (certificate.userType() == qMetaTypeId<KRecoveryCertificate>()) {
-        const auto rec = certificate.value<KRecoveryCertificate>();
-        return QDateTime(rec.validUntil(), {0, 0});
+        return relevantUntil(*static_cast<const KRecoveryCertificate*>(certificate.constData()));
     }
-
     return {};
 }
 
+QDateTime KHealthCertificate::relevantUntil(const KVaccinationCertificate &vac)
+{
+    if (vac.certificateExpiryDate().isValid()) {
+        return vac.certificateExpiryDate();
+    }
+    return QDateTime(vac.date().addYears(1), {0, 0});
+}
+
+QDateTime KHealthCertificate::relevantUntil(const KTestCertificate &test)
+{
+    if (test.certificateExpiryDate().isValid() && test.date().isValid()) {
+        return std::min(test.certificateExpiryDate(), QDateTime(test.date().addDays(2), {0, 0}));
+    }
+    if (test.certificateExpiryDate().isValid()) {
+        return test.certificateExpiryDate();
+    }
+    return QDateTime(test.date().addDays(2), {0, 0});
+}
+
+QDateTime KHealthCertificate::relevantUntil(const KRecoveryCertificate &rec)
+{
+    return QDateTime(rec.validUntil(), {0, 0});
+}
+
 #include "moc_khealthcertificate.cpp"
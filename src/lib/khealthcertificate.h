@@ -9,6 +9,10 @@
 #include "khealthcertificate_export.h"
 #include <QMetaType>
 
+class KRecoveryCertificate;
+class KTestCertificate;
+class KVaccinationCertificate;
+
 /** Dummy RTTI for QML, which doesn't support `instanceof` on Q_GADGETs... */
 class KHEALTHCERTIFICATE_EXPORT KHealthCertificate
 {
@@ -44,6 +48,10 @@ public:
      *  This is useful for sorting a set of certificate in the UI in a meaningful way.
      */
     static QDateTime relevantUntil(const QVariant &certificate);
+    /** Same as above, for a certificate of a statically known type. */
+    static QDateTime relevantUntil(const KVaccinationCertificate &certificate);
+    static QDateTime relevantUntil(const KTestCertificate &certificate);
+    static QDateTime relevantUntil(const KRecoveryCertificate &certificate);
 };
 
 #endif // KHEALTHCERTIFICATE_H
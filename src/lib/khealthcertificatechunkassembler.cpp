@@ -0,0 +1,160 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "khealthcertificatechunkassembler.h"
+#include "khealthcertificateparser.h"
+#include "logging.h"
+#include "shc/shcparser_p.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QVariant>
+
+#include <vector>
+
+// upper bound for the number of chunks, the SHC spec recommends not to exceed 3
+constexpr inline const int MaximumChunkCount = 64;
+
+class KHealthCertificateChunkAssemblerPrivate
+{
+public:
+    struct Assembly {
+        void reset(int chunkCount);
+
+        std::vector<QByteArray> chunks; // encoded data of each chunk as scanned
+        qsizetype size = 0; // total size of all chunks
+        int receivedChunks = 0;
+    };
+
+    KHealthCertificateParser::ParseLimits limits;
+    // incomplete certificates, keyed by their number of chunks
+    QHash<int, Assembly> assemblies;
+    int currentChunkCount = 0;
+};
+
+void KHealthCertificateChunkAssemblerPrivate::Assembly::reset(int chunkCount)
+{
+    chunks.clear();
+    chunks.resize(chunkCount);
+    size = 0;
+    receivedChunks = 0;
+}
+
+// SHC chunk format: shc:/<index>/<count>/<numeric data>
+// see https://spec.smarthealth.cards/#chunking-larger-shcs
+struct ShcChunk {
+    int index = 0;
+    int count = 0;
+    int dataBegin = 0;
+};
+
+static ShcChunk parseShcChunkHeader(const QByteArray &data)
+{
+    if (!data.startsWith("shc:/")) {
+        return {};
+    }
+    const auto idx1 = data.indexOf('/', 5);
+    const auto idx2 = idx1 < 0 ? -1 : data.indexOf('/', idx1 + 1);
+    if (idx2 < 0) {
+        return {};
+    }
+
+    bool indexOk = false;
+    bool countOk = false;
+    ShcChunk chunk;
+    chunk.index = data.mid(5, idx1 - 5).toInt(&indexOk);
+    chunk.count = data.mid(idx1 + 1, idx2 - idx1 - 1).toInt(&countOk);
+    chunk.dataBegin = idx2 + 1;
+    if (!indexOk || !countOk || chunk.count < 1 || chunk.count > MaximumChunkCount || chunk.index < 1 || chunk.index > chunk.count) {
+        return {};
+    }
+    return chunk;
+}
+
+KHealthCertificateChunkAssembler::KHealthCertificateChunkAssembler(const KHealthCertificateParser::ParseLimits &limits)
+    : d(std::make_unique<KHealthCertificateChunkAssemblerPrivate>())
+{
+    d->limits = limits;
+}
+
+KHealthCertificateChunkAssembler::~KHealthCertificateChunkAssembler() = default;
+
+bool KHealthCertificateChunkAssembler::isChunk(const QByteArray &data)
+{
+    return parseShcChunkHeader(data).count > 0;
+}
+
+QVariant KHealthCertificateChunkAssembler::addChunk(const QByteArray &data)
+{
+    const auto chunk = parseShcChunkHeader(data);
+    if (chunk.count == 0) {
+        return KHealthCertificateParser::parse(data, d->limits);
+    }
+    if (data.size() > d->limits.maximumInputSize) {
+        qCDebug(Log) << "chunk exceeds input size limit:" << data.size();
+        return {};
+    }
+
+    auto &assembly = d->assemblies[chunk.count];
+    if (assembly.chunks.empty()) {
+        assembly.reset(chunk.count);
+    }
+    d->currentChunkCount = chunk.count;
+
+    const auto encoded = data.mid(chunk.dataBegin);
+    if (assembly.chunks[chunk.index - 1] == encoded) {
+        return {}; // same chunk scanned again
+    }
+
+    // reject garbage right away, rather than only once all chunks are present
+    if (ShcParser::decodeNumeric(encoded.constData(), encoded.constData() + encoded.size()).isEmpty()) {
+        return {};
+    }
+
+    if (!assembly.chunks[chunk.index - 1].isEmpty()) {
+        // different content for a chunk we already have: must be a different certificate, start over
+        qCDebug(Log) << "conflicting chunk content, restarting assembly";
+        assembly.reset(chunk.count);
+    }
+    assembly.chunks[chunk.index - 1] = encoded;
+    assembly.size += encoded.size();
+    if (assembly.size + 5 > d->limits.maximumInputSize) {
+        qCDebug(Log) << "assembled certificate exceeds input size limit:" << assembly.size;
+        d->assemblies.remove(chunk.count);
+        d->currentChunkCount = 0;
+        return {};
+    }
+    if (++assembly.receivedChunks < chunk.count) {
+        return {};
+    }
+
+    // all chunks are present, the combined numeric data is equivalent to the non-chunked form
+    // and is processed like that, with the same limits, diagnostics and metrics
+    QByteArray rawData("shc:/");
+    rawData.reserve(assembly.size + 5);
+    for (const auto &c : assembly.chunks) {
+        rawData += c;
+    }
+    d->assemblies.remove(chunk.count);
+    d->currentChunkCount = 0;
+    return KHealthCertificateParser::parse(rawData, d->limits);
+}
+
+int KHealthCertificateChunkAssembler::chunkCount() const
+{
+    return d->currentChunkCount;
+}
+
+int KHealthCertificateChunkAssembler::receivedChunkCount() const
+{
+    const auto it = d->assemblies.constFind(d->currentChunkCount);
+    return it != d->assemblies.constEnd() ? it.value().receivedChunks : 0;
+}
+
+void KHealthCertificateChunkAssembler::clear()
+{
+    d->assemblies.clear();
+    d->currentChunkCount = 0;
+}
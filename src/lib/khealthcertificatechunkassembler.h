@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KHEALTHCERTIFICATECHUNKASSEMBLER_H
+#define KHEALTHCERTIFICATECHUNKASSEMBLER_H
+
+#include "khealthcertificate_export.h"
+#include "khealthcertificateparser.h"
+
+#include <memory>
+
+class KHealthCertificateChunkAssemblerPrivate;
+
+/** Reassembles health certificates that are split over multiple barcodes.
+ *  This is e.g. the case for large SMART Health Cards.
+ *
+ *  Scanned barcode content can be passed in in any order, partial state is
+ *  kept until all parts of a certificate have been received. Input that isn't
+ *  split is parsed immediately, so all scanner output can be passed through this.
+ */
+class KHEALTHCERTIFICATE_EXPORT KHealthCertificateChunkAssembler
+{
+public:
+    /** Create an assembler, applying @p limits to each part as well as to the assembled certificate. */
+    explicit KHealthCertificateChunkAssembler(const KHealthCertificateParser::ParseLimits &limits = {});
+    ~KHealthCertificateChunkAssembler();
+
+    /** Returns @c true if @p data is one part of a multi-part certificate. */
+    static bool isChunk(const QByteArray &data);
+
+    /** Add scanned barcode content.
+     *  @returns the parsed certificate as KHealthCertificateParser::parse() would,
+     *  once the last missing part of a multi-part certificate has been added.
+     *  A null QVariant is returned while parts are still missing.
+     */
+    QVariant addChunk(const QByteArray &data);
+
+    /** Total number of parts of the certificate currently being assembled.
+     *  This is 0 if there is no incomplete certificate.
+     */
+    int chunkCount() const;
+    /** Number of parts of the certificate currently being assembled that have been received already. */
+    int receivedChunkCount() const;
+
+    /** Discard all incomplete certificates. */
+    void clear();
+
+private:
+    std::unique_ptr<KHealthCertificateChunkAssemblerPrivate> d;
+};
+
+#endif // KHEALTHCERTIFICATECHUNKASSEMBLER_H
@@ -0,0 +1,190 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "khealthcertificatemetrics.h"
+#include "khealthcertificatemetrics_p.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <tuple>
+
+using namespace KHealthCertificateMetrics;
+
+constexpr inline const int FormatCount = std::tuple_size_v<decltype(Snapshot::formats)>;
+constexpr inline const int StageCount = std::tuple_size_v<decltype(FormatStatistics::stages)>;
+constexpr inline const int OutcomeCount = std::tuple_size_v<decltype(FormatStatistics::outcomes)>;
+constexpr inline const int SignatureStateCount = std::tuple_size_v<decltype(FormatStatistics::signatureStates)>;
+constexpr inline const int ReasonCount = std::tuple_size_v<decltype(FormatStatistics::signatureFailureReasons)>;
+
+// Counters are only ever written by the thread owning the block, so a relaxed
+// load/store pair is enough, there is no need for an atomic read-modify-write.
+// The atomics are only there to make concurrent reads from snapshot() well-defined.
+using Counter = std::atomic<quint64>;
+
+static inline void add(Counter &counter, quint64 value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+struct StageCounters {
+    Counter count;
+    Counter failures;
+    Counter totalNanoseconds;
+    Counter latencyHistogram[LatencyBucketCount];
+};
+
+struct FormatCounters {
+    StageCounters stages[StageCount];
+    Counter outcomes[OutcomeCount];
+    Counter signatureStates[SignatureStateCount];
+    Counter signatureFailureReasons[ReasonCount];
+};
+
+/** Counters of one thread.
+ *  Blocks are never deallocated, a block released by an exiting thread is
+ *  reused by the next new thread. That keeps the values recorded by the exited
+ *  thread and allows snapshot() to traverse the list without any locking.
+ */
+struct CounterBlock {
+    FormatCounters formats[FormatCount];
+    Counter verificationCacheHits;
+    Counter verificationCacheMisses;
+    CounterBlock *next = nullptr; // immutable once the block is published
+    std::atomic<bool> inUse = true;
+};
+
+static std::atomic<CounterBlock*> s_blocks = nullptr;
+
+static CounterBlock* acquireBlock()
+{
+    for (auto block = s_blocks.load(std::memory_order_acquire); block; block = block->next) {
+        bool expected = false;
+        if (block->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return block;
+        }
+    }
+
+    auto block = new CounterBlock();
+    block->next = s_blocks.load(std::memory_order_relaxed);
+    while (!s_blocks.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {}
+    return block;
+}
+
+namespace {
+struct ThreadCounters {
+    ThreadCounters() : block(acquireBlock()) {}
+    ~ThreadCounters() { block->inUse.store(false, std::memory_order_release); }
+    CounterBlock *block;
+};
+}
+
+static CounterBlock& threadCounters()
+{
+    thread_local ThreadCounters t;
+    return *t.block;
+}
+
+static FormatCounters& threadCounters(KHealthCertificatePipeline::Format format)
+{
+    return threadCounters().formats[format];
+}
+
+static int latencyBucket(qint64 nsecs)
+{
+    const auto usecs = static_cast<quint64>(std::max<qint64>(0, nsecs)) / 1000;
+    return std::min<int>(std::bit_width(usecs), LatencyBucketCount - 1);
+}
+
+void KHealthCertificateMetrics::recordStage(KHealthCertificatePipeline::Format format, KHealthCertificatePipeline::Stage stage, qint64 nsecs, bool success)
+{
+    auto &counters = threadCounters(format).stages[stage];
+    add(counters.count, 1);
+    if (!success) {
+        add(counters.failures, 1);
+    }
+    add(counters.totalNanoseconds, std::max<qint64>(0, nsecs));
+    add(counters.latencyHistogram[latencyBucket(nsecs)], 1);
+}
+
+void KHealthCertificateMetrics::recordOutcome(KHealthCertificatePipeline::Format format, KHealthCertificateParser::ParseOutcome outcome)
+{
+    add(threadCounters(format).outcomes[static_cast<int>(outcome)], 1);
+}
+
+void KHealthCertificateMetrics::recordSignatureState(KHealthCertificatePipeline::Format format, KHealthCertificate::SignatureValidation state, KHealthCertificatePipeline::Reason reason)
+{
+    auto &counters = threadCounters(format);
+    add(counters.signatureStates[state], 1);
+    if (reason != KHealthCertificatePipeline::NoReason) {
+        add(counters.signatureFailureReasons[reason], 1);
+    }
+}
+
+void KHealthCertificateMetrics::recordVerificationCacheLookup(bool hit)
+{
+    auto &block = threadCounters();
+    add(hit ? block.verificationCacheHits : block.verificationCacheMisses, 1);
+}
+
+static inline void collect(quint64 &value, const Counter &counter)
+{
+    value += counter.load(std::memory_order_relaxed);
+}
+
+Snapshot KHealthCertificateMetrics::snapshot()
+{
+    Snapshot result;
+    for (auto block = s_blocks.load(std::memory_order_acquire); block; block = block->next) {
+        collect(result.verificationCacheHits, block->verificationCacheHits);
+        collect(result.verificationCacheMisses, block->verificationCacheMisses);
+        for (int f = 0; f < FormatCount; ++f) {
+            const auto &counters = block->formats[f];
+            auto &stats = result.formats[f];
+            for (int s = 0; s < StageCount; ++s) {
+                collect(stats.stages[s].count, counters.stages[s].count);
+                collect(stats.stages[s].failures, counters.stages[s].failures);
+                collect(stats.stages[s].totalNanoseconds, counters.stages[s].totalNanoseconds);
+                for (int i = 0; i < LatencyBucketCount; ++i) {
+                    collect(stats.stages[s].latencyHistogram[i], counters.stages[s].latencyHistogram[i]);
+                }
+            }
+            for (int i = 0; i < OutcomeCount; ++i) {
+                collect(stats.outcomes[i], counters.outcomes[i]);
+            }
+            for (int i = 0; i < SignatureStateCount; ++i) {
+                collect(stats.signatureStates[i], counters.signatureStates[i]);
+            }
+            for (int i = 0; i < ReasonCount; ++i) {
+                collect(stats.signatureFailureReasons[i], counters.signatureFailureReasons[i]);
+            }
+        }
+    }
+    return result;
+}
+
+qint64 StageStatistics::latencyPercentile(double percentile) const
+{
+    quint64 total = 0;
+    for (const auto n : latencyHistogram) {
+        total += n;
+    }
+    if (total == 0) {
+        return -1;
+    }
+
+    // nearest rank, rounded up so that e.g. p99 of 10 samples is the 10th sample
+    // (minus a bit of tolerance against floating point error pushing exact ranks up)
+    const auto threshold = static_cast<quint64>(std::ceil(std::clamp(percentile, 0.0, 1.0) * total - 1e-9));
+    quint64 sum = 0;
+    for (int i = 0; i < LatencyBucketCount - 1; ++i) {
+        sum += latencyHistogram[i];
+        if (sum >= threshold && sum > 0) {
+            return qint64(1) << i;
+        }
+    }
+    return -1;
+}
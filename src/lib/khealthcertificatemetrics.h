@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KHEALTHCERTIFICATEMETRICS_H
+#define KHEALTHCERTIFICATEMETRICS_H
+
+#include "khealthcertificate_export.h"
+#include "khealthcertificate.h"
+#include "khealthcertificateparser.h"
+#include "khealthcertificatepipeline.h"
+
+#include <array>
+
+/** Process-wide statistics about certificate parsing.
+ *
+ *  Counters and stage latencies are recorded for every certificate processed by
+ *  KHealthCertificateParser or KHealthCertificatePipeline, per format and per stage.
+ *  Recording is done in thread-local storage without any locking, so this is cheap
+ *  enough to be always enabled.
+ *
+ *  All values are cumulative since process start, monitoring is expected
+ *  to compute rates from the difference between two snapshots.
+ */
+namespace KHealthCertificateMetrics
+{
+    /** Number of latency histogram buckets.
+     *  Bucket @c 0 counts latencies below 1µs, bucket @c i latencies in [2^(i-1)µs, 2^iµs),
+     *  and the last bucket everything above that.
+     */
+    constexpr inline const int LatencyBucketCount = 24;
+
+    /** Statistics for one processing stage. */
+    struct StageStatistics {
+        /** Number of times this stage was run. */
+        quint64 count = 0;
+        /** Number of times this stage failed. */
+        quint64 failures = 0;
+        /** Total time spent in this stage, in nanoseconds. */
+        quint64 totalNanoseconds = 0;
+        /** Latency histogram, see LatencyBucketCount. */
+        std::array<quint64, LatencyBucketCount> latencyHistogram = {};
+
+        /** Upper bound of the latency histogram bucket containing the given percentile, in microseconds.
+         *  @param percentile A value between 0.0 and 1.0, e.g. 0.99 for the p99 latency.
+         *  @returns -1 if there is no data or the percentile falls into the open-ended last bucket.
+         */
+        KHEALTHCERTIFICATE_EXPORT qint64 latencyPercentile(double percentile) const;
+    };
+
+    /** Statistics for one certificate format. */
+    struct FormatStatistics {
+        /** Per-stage statistics, indexed by KHealthCertificatePipeline::Stage. */
+        std::array<StageStatistics, KHealthCertificatePipeline::SignatureVerification + 1> stages;
+        /** Number of certificates per KHealthCertificateParser::ParseOutcome, for completely processed input. */
+        std::array<quint64, int(KHealthCertificateParser::ParseOutcome::LimitExceeded) + 1> outcomes = {};
+        /** Number of certificates per KHealthCertificate::SignatureValidation result. */
+        std::array<quint64, KHealthCertificate::UncheckedSignature + 1> signatureStates = {};
+        /** Number of certificates without a valid signature per KHealthCertificatePipeline::Reason,
+         *  e.g. to tell unknown signing keys apart from unsupported signature algorithms.
+         */
+        std::array<quint64, KHealthCertificatePipeline::ResourceLimitExceeded + 1> signatureFailureReasons = {};
+    };
+
+    /** A consistent-enough copy of all counters. */
+    struct Snapshot {
+        /** Per-format statistics, indexed by KHealthCertificatePipeline::Format.
+         *  Input failing format detection is accounted for as KHealthCertificatePipeline::UnknownFormat.
+         */
+        std::array<FormatStatistics, KHealthCertificatePipeline::NLCoronaCheck + 1> formats;
+        /** Number of signature verifications answered from the verification result cache. */
+        quint64 verificationCacheHits = 0;
+        /** Number of signature verifications not found in the verification result cache. */
+        quint64 verificationCacheMisses = 0;
+    };
+
+    /** Collect the current state of all counters.
+     *  This doesn't block threads currently parsing certificates, values recorded concurrently
+     *  might or might not be included.
+     */
+    KHEALTHCERTIFICATE_EXPORT Snapshot snapshot();
+}
+
+#endif // KHEALTHCERTIFICATEMETRICS_H
@@ -0,0 +1,22 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KHEALTHCERTIFICATEMETRICS_P_H
+#define KHEALTHCERTIFICATEMETRICS_P_H
+
+#include "khealthcertificatemetrics.h"
+
+/** Recording side of KHealthCertificateMetrics.
+ *  All of this only touches counters of the calling thread.
+ */
+namespace KHealthCertificateMetrics
+{
+    void recordStage(KHealthCertificatePipeline::Format format, KHealthCertificatePipeline::Stage stage, qint64 nsecs, bool success);
+    void recordOutcome(KHealthCertificatePipeline::Format format, KHealthCertificateParser::ParseOutcome outcome);
+    void recordSignatureState(KHealthCertificatePipeline::Format format, KHealthCertificate::SignatureValidation state, KHealthCertificatePipeline::Reason reason);
+    void recordVerificationCacheLookup(bool hit);
+}
+
+#endif // KHEALTHCERTIFICATEMETRICS_P_H
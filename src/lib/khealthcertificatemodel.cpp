@@ -0,0 +1,231 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "khealthcertificatemodel.h"
+#include "khealthcertificate.h"
+#include "khealthcertificatepipeline.h"
+
+#include <QSet>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// mapping the payload is cheap compared to signature verification, so that is done
+// for all pending certificates first, to get content on screen as quickly as possible
+constexpr inline const int MappingPriority = 1;
+constexpr inline const int VerificationPriority = 0;
+
+class KHealthCertificateModelPrivate
+{
+public:
+    struct Entry {
+        quint64 id = 0;
+        QByteArray rawData;
+        QVariant certificate;
+        QString name;
+        QDateTime relevantUntil;
+        qint64 sortKey = 0; // relevantUntil in ms since epoch, computed once for cheap comparisons
+        KHealthCertificate::CertificateType type = KHealthCertificate::Vaccination;
+        KHealthCertificate::SignatureValidation signatureState = KHealthCertificate::UncheckedSignature;
+    };
+
+    explicit KHealthCertificateModelPrivate(KHealthCertificateModel *qq) : q(qq) {}
+
+    static void setCertificate(Entry &entry, const KHealthCertificateParser::Certificate &certificate);
+    int rowForId(quint64 id) const;
+
+    void startMapping(quint64 id, const QByteArray &data);
+    void mappingFinished(quint64 id, const std::shared_ptr<KHealthCertificatePipeline> &pipeline);
+    void verificationFinished(quint64 id, const KHealthCertificateParser::Certificate &certificate);
+
+    KHealthCertificateModel *q;
+    QThreadPool threadPool;
+    std::vector<Entry> entries;
+    QSet<quint64> pendingIds; // certificates still being parsed
+    quint64 nextId = 0;
+};
+
+void KHealthCertificateModelPrivate::setCertificate(Entry &entry, const KHealthCertificateParser::Certificate &certificate)
+{
+    std::visit([&entry](const auto &cert) {
+        if constexpr (!std::is_same_v<std::decay_t<decltype(cert)>, std::monostate>) {
+            entry.name = cert.name();
+            entry.type = cert.type();
+            entry.signatureState = cert.signatureState();
+            entry.relevantUntil = KHealthCertificate::relevantUntil(cert);
+        }
+    }, certificate);
+    entry.certificate = KHealthCertificateParser::toVariant(certificate);
+    entry.sortKey = entry.relevantUntil.isValid() ? entry.relevantUntil.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+}
+
+int KHealthCertificateModelPrivate::rowForId(quint64 id) const
+{
+    const auto it = std::find_if(entries.begin(), entries.end(), [id](const auto &entry) { return entry.id == id; });
+    return it == entries.end() ? -1 : (int)std::distance(entries.begin(), it);
+}
+
+void KHealthCertificateModelPrivate::startMapping(quint64 id, const QByteArray &data)
+{
+    threadPool.start([this, id, data]() {
+        auto pipeline = std::make_shared<KHealthCertificatePipeline>(data);
+        pipeline->mapPayload();
+        QMetaObject::invokeMethod(q, [this, id, pipeline]() { mappingFinished(id, pipeline); }, Qt::QueuedConnection);
+    }, MappingPriority);
+}
+
+void KHealthCertificateModelPrivate::mappingFinished(quint64 id, const std::shared_ptr<KHealthCertificatePipeline> &pipeline)
+{
+    if (!pendingIds.remove(id)) {
+        return; // removed in the meantime
+    }
+
+    const auto certificate = pipeline->typedCertificate();
+    if (!std::holds_alternative<std::monostate>(certificate)) {
+        Entry entry;
+        entry.id = id;
+        entry.rawData = pipeline->input();
+        setCertificate(entry, certificate);
+
+        const auto it = std::upper_bound(entries.begin(), entries.end(), entry, [](const auto &lhs, const auto &rhs) {
+            return lhs.sortKey > rhs.sortKey;
+        });
+        const auto row = (int)std::distance(entries.begin(), it);
+        q->beginInsertRows({}, row, row);
+        entries.insert(it, std::move(entry));
+        q->endInsertRows();
+
+        threadPool.start([this, id, pipeline]() {
+            pipeline->verifySignature();
+            QMetaObject::invokeMethod(q, [this, id, pipeline]() { verificationFinished(id, pipeline->typedCertificate()); }, Qt::QueuedConnection);
+        }, VerificationPriority);
+    }
+
+    if (pendingIds.isEmpty()) {
+        Q_EMIT q->loadingChanged();
+    }
+}
+
+void KHealthCertificateModelPrivate::verificationFinished(quint64 id, const KHealthCertificateParser::Certificate &certificate)
+{
+    const auto row = rowForId(id);
+    if (row < 0) {
+        return; // removed in the meantime
+    }
+
+    // signature verification doesn't change the sort key
+    setCertificate(entries[row], certificate);
+    const auto idx = q->index(row, 0);
+    Q_EMIT q->dataChanged(idx, idx);
+}
+
+
+KHealthCertificateModel::KHealthCertificateModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , d(std::make_unique<KHealthCertificateModelPrivate>(this))
+{
+}
+
+KHealthCertificateModel::~KHealthCertificateModel()
+{
+    d->threadPool.clear();
+    d->threadPool.waitForDone();
+}
+
+bool KHealthCertificateModel::isLoading() const
+{
+    return !d->pendingIds.isEmpty();
+}
+
+void KHealthCertificateModel::addCertificate(const QByteArray &data)
+{
+    const auto wasLoading = isLoading();
+    const auto id = d->nextId++;
+    d->pendingIds.insert(id);
+    d->startMapping(id, data);
+    if (!wasLoading) {
+        Q_EMIT loadingChanged();
+    }
+}
+
+void KHealthCertificateModel::addCertificates(const QList<QByteArray> &data)
+{
+    for (const auto &certData : data) {
+        addCertificate(certData);
+    }
+}
+
+void KHealthCertificateModel::removeCertificate(int row)
+{
+    if (row < 0 || row >= rowCount()) {
+        return;
+    }
+    beginRemoveRows({}, row, row);
+    d->entries.erase(d->entries.begin() + row);
+    endRemoveRows();
+}
+
+void KHealthCertificateModel::clear()
+{
+    // results of jobs already running are discarded when they arrive
+    d->threadPool.clear();
+
+    beginResetModel();
+    d->entries.clear();
+    endResetModel();
+
+    if (isLoading()) {
+        d->pendingIds.clear();
+        Q_EMIT loadingChanged();
+    }
+}
+
+int KHealthCertificateModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return (int)d->entries.size();
+}
+
+QVariant KHealthCertificateModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid | QAbstractItemModel::CheckIndexOption::ParentIsInvalid)) {
+        return {};
+    }
+
+    const auto &entry = d->entries[index.row()];
+    switch (role) {
+        case Qt::DisplayRole:
+            return entry.name;
+        case CertificateRole:
+            return entry.certificate;
+        case CertificateTypeRole:
+            return QVariant::fromValue(entry.type);
+        case SignatureStateRole:
+            return QVariant::fromValue(entry.signatureState);
+        case RelevantUntilRole:
+            return entry.relevantUntil;
+        case RawDataRole:
+            return entry.rawData;
+    }
+    return {};
+}
+
+QHash<int, QByteArray> KHealthCertificateModel::roleNames() const
+{
+    auto names = QAbstractListModel::roleNames();
+    names.insert(CertificateRole, "certificate");
+    names.insert(CertificateTypeRole, "certificateType");
+    names.insert(SignatureStateRole, "signatureState");
+    names.insert(RelevantUntilRole, "relevantUntil");
+    names.insert(RawDataRole, "rawData");
+    return names;
+}
+
+#include "moc_khealthcertificatemodel.cpp"
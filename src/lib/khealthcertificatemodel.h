@@ -0,0 +1,73 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KHEALTHCERTIFICATEMODEL_H
+#define KHEALTHCERTIFICATEMODEL_H
+
+#include "khealthcertificate_export.h"
+
+#include <QAbstractListModel>
+
+#include <memory>
+
+class KHealthCertificateModelPrivate;
+
+/** List of parsed health certificates, e.g. for displaying a certificate wallet.
+ *
+ *  Raw certificate data is parsed in background threads, rows are inserted as
+ *  soon as the content of a certificate is available. Signatures are verified
+ *  afterwards, the KHealthCertificate::SignatureValidation state of a row changes
+ *  once that is done.
+ *
+ *  Rows are sorted by KHealthCertificate::relevantUntil(), most relevant certificates first.
+ *  Input that can't be parsed is ignored.
+ */
+class KHEALTHCERTIFICATE_EXPORT KHealthCertificateModel : public QAbstractListModel
+{
+    Q_OBJECT
+    /** @c true while added certificates are still being parsed. */
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+public:
+    enum Role {
+        /** The certificate, as returned by KHealthCertificateParser::parse(). */
+        CertificateRole = Qt::UserRole,
+        /** KHealthCertificate::CertificateType */
+        CertificateTypeRole,
+        /** KHealthCertificate::SignatureValidation, this changes after signature verification. */
+        SignatureStateRole,
+        /** See KHealthCertificate::relevantUntil(). */
+        RelevantUntilRole,
+        /** The raw certificate data as added to the model. */
+        RawDataRole,
+    };
+    Q_ENUM(Role)
+
+    explicit KHealthCertificateModel(QObject *parent = nullptr);
+    ~KHealthCertificateModel() override;
+
+    bool isLoading() const;
+
+    /** Add a certificate in its raw form, e.g. as read from a barcode. */
+    Q_INVOKABLE void addCertificate(const QByteArray &data);
+    /** Add multiple certificates. */
+    void addCertificates(const QList<QByteArray> &data);
+    /** Remove the certificate in @p row. */
+    Q_INVOKABLE void removeCertificate(int row);
+    /** Remove all certificates, including those still being parsed. */
+    Q_INVOKABLE void clear();
+
+    int rowCount(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+Q_SIGNALS:
+    void loadingChanged();
+
+private:
+    friend class KHealthCertificateModelPrivate;
+    std::unique_ptr<KHealthCertificateModelPrivate> d;
+};
+
+#endif // KHEALTHCERTIFICATEMODEL_H
@@ -4,19 +4,24 @@
  */
 
 #include "khealthcertificateparser.h"
+#include "khealthcertificateparser_p.h"
+#include "khealthcertificateparsersession_p.h"
+#include "khealthcertificatepipeline.h"
+#include "config-truststore_p.h"
 #include "divoc/divocparser_p.h"
 #include "eu-dgc/eudgcparser_p.h"
 #include "icao/icaovdsparser_p.h"
 #include "nl-coronacheck/nlcoronacheckparser_p.h"
+#include "parsecontext_p.h"
 #include "shc/shcparser_p.h"
+#include "tracepoints_p.h"
 
-#include <KZip>
-
-#include <QBuffer>
 #include <QByteArray>
 #include <QVariant>
 
-static bool initResources()
+#include <type_traits>
+
+static bool registerResources()
 {
     DivocParser::init();
     EuDgcParser::init();
@@ -27,54 +32,59 @@ static bool initResources()
     return true;
 }
 
+void KHealthCertificateParser::initResources()
+{
+    [[maybe_unused]] static bool s_init = registerResources();
+}
+
 QVariant KHealthCertificateParser::parse(const QByteArray &data)
 {
-    [[maybe_unused]] static bool s_init = initResources();
+    return parse(data, ParseLimits());
+}
 
-    EuDgcParser eudcg;
-    auto result = eudcg.parse(data);
-    if (!result.isNull()) {
-        return result;
-    }
-    result = DivocParser::parse(data);
-    if (!result.isNull()) {
-        return result;
-    }
-    result = ShcParser::parse(data);
-    if (!result.isNull()) {
-        return result;
-    }
-    result = IcaoVdsParser::parse(data);
-    if (!result.isNull()) {
-        return result;
-    }
-    result = NLCoronaCheckParser::parse(data);
-    if (!result.isNull()) {
-        return result;
-    }
+QVariant KHealthCertificateParser::parse(const QByteArray &data, const ParseLimits &limits, ParseOutcome *outcome)
+{
+    return toVariant(parseCertificate(data, limits, outcome));
+}
 
-    // ZIP unpacking (needed for Indian certificates)
-    if (data.startsWith(QByteArray("\x50\x4B\x03\x04"))) {
-        QBuffer buffer;
-        buffer.setData(data);
-        buffer.open(QIODevice::ReadOnly);
-        KZip zip(&buffer);
-        if (!zip.open(QIODevice::ReadOnly)) {
-            return {};
-        }
-        const auto entries = zip.directory()->entries();
-        for (const auto &entry : entries) {
-            if (auto f = zip.directory()->file(entry)) {
-                result = parse(f->data());
-                if (!result.isNull()) {
-                    auto vac = result.value<KVaccinationCertificate>();
-                    vac.setRawData(data);
-                    return vac;
-                }
-            }
-        }
+QVariant KHealthCertificateParser::parse(KHealthCertificateParserSession &session, const QByteArray &data, ParseOutcome *outcome)
+{
+    return toVariant(parseCertificate(session, data, outcome));
+}
 
+KHealthCertificateParser::Certificate KHealthCertificateParser::parseCertificate(const QByteArray &data, const ParseLimits &limits, ParseOutcome *outcome)
+{
+    KHC_TRACEPOINT(parse_begin, data.size());
+    KHealthCertificatePipeline pipeline(data, limits);
+    pipeline.verifySignature();
+    KHC_TRACEPOINT(parse_end, int(pipeline.format()), int(pipeline.outcome()));
+    if (outcome) {
+        *outcome = pipeline.outcome();
     }
+    return pipeline.typedCertificate();
+}
 
-    return {};
+KHealthCertificateParser::Certificate KHealthCertificateParser::parseCertificate(KHealthCertificateParserSession &session, const QByteArray &data, ParseOutcome *outcome)
+{
+    auto d = KHealthCertificateParserSessionPrivate::get(session);
+    ParseContext context(d);
+    return parseCertificate(data, d->limits, outcome);
+}
+
+QVariant KHealthCertificateParser::toVariant(const Certificate &certificate)
+{
+    return std::visit([](const auto &cert) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(cert)>, std::monostate>) {
+            return QVariant();
+        } else {
+            return QVariant::fromValue(cert);
+        }
+    }, certificate);
+}
+
+QByteArray KHealthCertificateParser::trustStoreVersion()
+{
+    // digest over all built-in trust anchors, computed at build time
+    static const QByteArray s_version = QByteArray::fromHex(KHEALTHCERTIFICATE_TRUST_STORE_VERSION);
+    return s_version;
 }
@@ -7,13 +7,57 @@
 #define KHEALTHCERTIFICATEPARSER_H
 
 #include "khealthcertificate_export.h"
+#include "krecoverycertificate.h"
+#include "ktestcertificate.h"
+#include "kvaccinationcertificate.h"
+
+#include <QtGlobal>
+
+#include <variant>
+
+class KHealthCertificateParserSession;
 
 class QByteArray;
 class QVariant;
 
-/** Parses health certificates. */
+/** Parses health certificates.
+ *  All functions in here are thread-safe, they can be called concurrently from multiple threads.
+ */
 namespace KHealthCertificateParser
 {
+    /**
+     * Upper bounds for the work spent on parsing a single certificate.
+     * This allows to guarantee a worst-case runtime and memory consumption when
+     * handling untrusted input. The defaults are well above what real-world
+     * certificates need.
+     */
+    struct ParseLimits {
+        /** Maximum size of the input data, in bytes. */
+        qsizetype maximumInputSize = 64 * 1024;
+        /** Maximum size of any decompressed data, in bytes. */
+        qsizetype maximumDecompressedSize = 1024 * 1024;
+        /** Maximum nesting depth of JSON, CBOR or JSON-LD structures. */
+        int maximumNestingDepth = 64;
+        /** Maximum number of RDF quads produced during JSON-LD signature canonicalization. */
+        int maximumRdfQuadCount = 1024;
+        /** Maximum number of signature or certificate chain verifications. */
+        int maximumCryptoOperations = 8;
+        /** Maximum number of digits of inputs decoded as a single large number,
+         *  such as the NL CoronaCheck Base45 encoding. Decoding those takes quadratic time.
+         */
+        qsizetype maximumBignumDigits = 4096;
+    };
+
+    /** Outcome of a parse operation. */
+    enum class ParseOutcome {
+        Success, ///< input was parsed successfully
+        UnsupportedInput, ///< input is invalid or of an unsupported format
+        LimitExceeded, ///< parsing was aborted as the input exceeded one of the ParseLimits
+    };
+
+    /** A parsed certificate, or std::monostate in case of invalid or unsupported input. */
+    using Certificate = std::variant<std::monostate, KVaccinationCertificate, KTestCertificate, KRecoveryCertificate>;
+
     /**
      * Parse a single digital health certificate.
      *
@@ -29,6 +73,48 @@ namespace KHealthCertificateParser
      * separately, see e.g. KVaccinationCertificate::signatureState and KVaccinationCertificate::validationState.
      */
     KHEALTHCERTIFICATE_EXPORT QVariant parse(const QByteArray &data);
+
+    /**
+     * Parse a single digital health certificate, within the given resource limits.
+     *
+     * @param data The digital health certificate, see above.
+     * @param limits The resource limits to apply.
+     * @param outcome If not @c nullptr, this is set to the reason for a null result.
+     *
+     * @returns the same as parse() above, or a null QVariant if @p data exceeds @p limits.
+     * @see KHealthCertificatePipeline::diagnostics() for more details on failures.
+     */
+    KHEALTHCERTIFICATE_EXPORT QVariant parse(const QByteArray &data, const ParseLimits &limits, ParseOutcome *outcome = nullptr);
+
+    /**
+     * Parse a single digital health certificate, reusing the resources of @p session.
+     *
+     * @param session The parser session, with the resource limits to apply.
+     * @param data The digital health certificate, see above.
+     * @param outcome If not @c nullptr, this is set to the reason for a null result.
+     *
+     * @returns the same as parse() above.
+     */
+    KHEALTHCERTIFICATE_EXPORT QVariant parse(KHealthCertificateParserSession &session, const QByteArray &data, ParseOutcome *outcome = nullptr);
+
+    /**
+     * Parse a single digital health certificate, without boxing the result into a QVariant.
+     * This is otherwise the same as parse().
+     */
+    KHEALTHCERTIFICATE_EXPORT Certificate parseCertificate(const QByteArray &data, const ParseLimits &limits = {}, ParseOutcome *outcome = nullptr);
+    /** Same as above, reusing the resources of @p session. */
+    KHEALTHCERTIFICATE_EXPORT Certificate parseCertificate(KHealthCertificateParserSession &session, const QByteArray &data, ParseOutcome *outcome = nullptr);
+
+    /** Converts @p certificate to the QVariant representation returned by parse(). */
+    KHEALTHCERTIFICATE_EXPORT QVariant toVariant(const Certificate &certificate);
+
+    /**
+     * Identifies the set of trusted signer certificates and keys built into this library.
+     * Signature verification results obtained with a different trust store version
+     * have to be considered outdated, e.g. when persisting them.
+     * @see KHealthCertificateSerializer, KHealthCertificateStore
+     */
+    KHEALTHCERTIFICATE_EXPORT QByteArray trustStoreVersion();
 }
 
 #endif // KHEALTHCERTIFICATEPARSER_H
@@ -0,0 +1,15 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KHEALTHCERTIFICATEPARSER_P_H
+#define KHEALTHCERTIFICATEPARSER_P_H
+
+namespace KHealthCertificateParser
+{
+    /** Register the compiled-in resources of all parsers, if that hasn't happened yet. */
+    void initResources();
+}
+
+#endif // KHEALTHCERTIFICATEPARSER_P_H
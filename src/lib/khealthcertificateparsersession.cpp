@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "khealthcertificateparsersession.h"
+#include "khealthcertificateparsersession_p.h"
+#include "logging.h"
+
+KHealthCertificateParserSessionPrivate::~KHealthCertificateParserSessionPrivate()
+{
+    if (m_inflateWindowBits != 0) {
+        inflateEnd(&m_inflateStream);
+    }
+}
+
+KHealthCertificateParserSessionPrivate* KHealthCertificateParserSessionPrivate::get(KHealthCertificateParserSession &session)
+{
+    return session.d.get();
+}
+
+z_stream* KHealthCertificateParserSessionPrivate::inflateStream(int windowBits)
+{
+    if (m_inflateWindowBits == 0) {
+        m_inflateStream.zalloc = nullptr;
+        m_inflateStream.zfree = nullptr;
+        m_inflateStream.opaque = nullptr;
+        m_inflateStream.avail_in = 0;
+        m_inflateStream.next_in = nullptr;
+        if (inflateInit2(&m_inflateStream, windowBits) != Z_OK) {
+            qCWarning(Log) << "zlib initialization failed" << m_inflateStream.msg;
+            return nullptr;
+        }
+    } else if (inflateReset2(&m_inflateStream, windowBits) != Z_OK) {
+        qCWarning(Log) << "zlib reset failed" << m_inflateStream.msg;
+        inflateEnd(&m_inflateStream);
+        m_inflateWindowBits = 0;
+        return nullptr;
+    }
+    m_inflateWindowBits = windowBits;
+    return &m_inflateStream;
+}
+
+QByteArray& KHealthCertificateParserSessionPrivate::inflateBuffer()
+{
+    return m_inflateBuffer;
+}
+
+BN_CTX* KHealthCertificateParserSessionPrivate::bnContext()
+{
+    if (!m_bnCtx) {
+        m_bnCtx.reset(BN_CTX_new());
+    }
+    return m_bnCtx.get();
+}
+
+EVP_MD_CTX* KHealthCertificateParserSessionPrivate::digestContext()
+{
+    if (!m_mdCtx) {
+        m_mdCtx.reset(EVP_MD_CTX_new());
+    } else {
+        EVP_MD_CTX_reset(m_mdCtx.get());
+    }
+    return m_mdCtx.get();
+}
+
+X509_STORE_CTX* KHealthCertificateParserSessionPrivate::storeContext()
+{
+    if (!m_storeCtx) {
+        m_storeCtx.reset(X509_STORE_CTX_new());
+    } else {
+        X509_STORE_CTX_cleanup(m_storeCtx.get());
+    }
+    return m_storeCtx.get();
+}
+
+std::byte* KHealthCertificateParserSessionPrivate::arenaBuffer()
+{
+    if (!m_arenaBuffer) {
+        m_arenaBuffer.reset(new std::byte[ArenaSize]);
+    }
+    return m_arenaBuffer.get();
+}
+
+
+KHealthCertificateParserSession::KHealthCertificateParserSession(const KHealthCertificateParser::ParseLimits &limits)
+    : d(std::make_unique<KHealthCertificateParserSessionPrivate>())
+{
+    d->limits = limits;
+}
+
+KHealthCertificateParserSession::~KHealthCertificateParserSession() = default;
+
+const KHealthCertificateParser::ParseLimits& KHealthCertificateParserSession::limits() const
+{
+    return d->limits;
+}
@@ -0,0 +1,45 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KHEALTHCERTIFICATEPARSERSESSION_H
+#define KHEALTHCERTIFICATEPARSERSESSION_H
+
+#include "khealthcertificate_export.h"
+#include "khealthcertificateparser.h"
+
+#include <memory>
+
+class KHealthCertificateParserSessionPrivate;
+
+/** Resources reused across multiple parse operations.
+ *
+ *  Parsing a certificate needs a number of temporary buffers as well as
+ *  decompression and cryptographic contexts. Parsing with a session keeps those
+ *  around for subsequent calls instead of allocating and releasing them every time.
+ *  This is useful for applications parsing large amounts of certificates, such
+ *  as verification services.
+ *
+ *  A session must only be used by one thread at a time, create one session
+ *  per worker thread for parallel parsing.
+ *
+ *  @see KHealthCertificateParser::parse(KHealthCertificateParserSession&, const QByteArray&, KHealthCertificateParser::ParseOutcome*)
+ */
+class KHEALTHCERTIFICATE_EXPORT KHealthCertificateParserSession
+{
+public:
+    /** Create a new session, parsing with the given resource limits. */
+    explicit KHealthCertificateParserSession(const KHealthCertificateParser::ParseLimits &limits = {});
+    ~KHealthCertificateParserSession();
+
+    /** Resource limits applied to all parse operations of this session. */
+    const KHealthCertificateParser::ParseLimits& limits() const;
+
+private:
+    friend class KHealthCertificateParserSessionPrivate;
+    Q_DISABLE_COPY_MOVE(KHealthCertificateParserSession)
+    std::unique_ptr<KHealthCertificateParserSessionPrivate> d;
+};
+
+#endif // KHEALTHCERTIFICATEPARSERSESSION_H
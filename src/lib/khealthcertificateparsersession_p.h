@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KHEALTHCERTIFICATEPARSERSESSION_P_H
+#define KHEALTHCERTIFICATEPARSERSESSION_P_H
+
+#include "khealthcertificateparsersession.h"
+#include "openssl/opensslpp_p.h"
+
+#include <QByteArray>
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <memory>
+
+/** Reusable resources of a KHealthCertificateParserSession.
+ *  Parser internals get to this via ParseContext::session(), and have
+ *  to fall back to allocating their own resources without an active session.
+ *
+ *  Buffers returned from here are only valid until the next call to the
+ *  same method, contexts are reset to their initial state when retrieved.
+ */
+class KHealthCertificateParserSessionPrivate
+{
+public:
+    ~KHealthCertificateParserSessionPrivate();
+
+    static KHealthCertificateParserSessionPrivate* get(KHealthCertificateParserSession &session);
+
+    /** Inflate stream initialized for @p windowBits, or @c nullptr on error. */
+    z_stream* inflateStream(int windowBits);
+    /** Output buffer for decompression.
+     *  This is returned to the caller as a shallow copy, should the caller still hold
+     *  on to that on the next use, implicit sharing makes sure it isn't overwritten.
+     */
+    QByteArray& inflateBuffer();
+
+    /** Big number arithmetic context, or @c nullptr on error. */
+    BN_CTX* bnContext();
+    /** Message digest context, or @c nullptr on error. */
+    EVP_MD_CTX* digestContext();
+    /** Certificate store context, ready for X509_STORE_CTX_init(), or @c nullptr on error. */
+    X509_STORE_CTX* storeContext();
+
+    /** Initial buffer for monotonic arenas, see ArenaSize. */
+    std::byte* arenaBuffer();
+    /** Size of arenaBuffer(). */
+    static constexpr inline const std::size_t ArenaSize = 32 * 1024;
+
+    KHealthCertificateParser::ParseLimits limits;
+
+private:
+    z_stream m_inflateStream;
+    int m_inflateWindowBits = 0; // 0 means not initialized yet
+    QByteArray m_inflateBuffer;
+
+    openssl::bn_ctx_ptr m_bnCtx;
+    openssl::evp_md_ctx_ptr m_mdCtx;
+    openssl::x509_store_ctx_ptr m_storeCtx;
+
+    std::unique_ptr<std::byte[]> m_arenaBuffer;
+};
+
+#endif // KHEALTHCERTIFICATEPARSERSESSION_P_H
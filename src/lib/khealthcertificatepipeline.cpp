@@ -0,0 +1,531 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "khealthcertificatepipeline.h"
+#include "khealthcertificatemetrics_p.h"
+#include "khealthcertificateparser_p.h"
+#include "divoc/divocparser_p.h"
+#include "eu-dgc/coseparser_p.h"
+#include "eu-dgc/eudgcparser_p.h"
+#include "icao/icaovdsparser_p.h"
+#include "json/jsonstreamreader_p.h"
+#include "nl-coronacheck/nlcoronacheckparser_p.h"
+#include "parsecontext_p.h"
+#include "shc/jwtparser_p.h"
+#include "shc/shcparser_p.h"
+#include "tracepoints_p.h"
+#include "zip/zipreader_p.h"
+
+#include <KRecoveryCertificate>
+#include <KTestCertificate>
+#include <KVaccinationCertificate>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVariant>
+
+#include <type_traits>
+#include <variant>
+
+#include <openssl/err.h>
+
+using ParseOutcome = KHealthCertificateParser::ParseOutcome;
+
+class KHealthCertificatePipelinePrivate
+{
+public:
+    bool run(KHealthCertificatePipeline::Stage target);
+    bool runStages(ParseContext &context, KHealthCertificatePipeline::Stage target);
+    const QByteArray& stageInput(KHealthCertificatePipeline::Stage stage) const;
+    KHealthCertificatePipeline::Reason defaultReason(KHealthCertificatePipeline::Stage stage) const;
+
+    bool detectFormat();
+    bool decodeTransport();
+    bool decompress();
+    bool parseEnvelope();
+    bool mapPayload();
+    bool verifySignature();
+
+    QByteArray input;
+    KHealthCertificateParser::ParseLimits limits;
+    KHealthCertificatePipeline::Format format = KHealthCertificatePipeline::UnknownFormat;
+    KHealthCertificatePipeline::Stage stage = KHealthCertificatePipeline::NoStage;
+    ParseOutcome outcome = ParseOutcome::Success;
+    KHealthCertificatePipeline::Diagnostics diagnostics;
+    bool error = false;
+    // crypto operations done by previous run() calls, when advancing the pipeline step by step
+    int cryptoOperations = 0;
+
+    QByteArray transportDecoded;
+    QByteArray decompressed;
+    QByteArray payload;
+    QByteArray keyId;
+    KHealthCertificateParser::Certificate certificate;
+    KHealthCertificate::SignatureValidation signatureState = KHealthCertificate::UncheckedSignature;
+
+    // format-specific result of parseEnvelope(), needed for the later stages
+    // DIVOC and ICAO VDS both use a QJsonObject here
+    std::variant<std::monostate, CoseParser, JwtParser, QJsonObject, NLCoronaCheckProof> envelope;
+};
+
+bool KHealthCertificatePipelinePrivate::run(KHealthCertificatePipeline::Stage target)
+{
+    // limits apply to the parse operation as a whole, not to individual stages
+    ParseContext context(limits);
+    context.setCryptoOperations(cryptoOperations);
+    const auto result = runStages(context, target);
+    cryptoOperations = context.cryptoOperations();
+    return result;
+}
+
+bool KHealthCertificatePipelinePrivate::runStages(ParseContext &context, KHealthCertificatePipeline::Stage target)
+{
+    while (stage < target) {
+        if (error) {
+            return false;
+        }
+
+        const auto next = static_cast<KHealthCertificatePipeline::Stage>(stage + 1);
+        context.clearReason();
+        KHC_TRACEPOINT(stage_begin, int(format), int(next), stageInput(next).size());
+        QElapsedTimer timer;
+        timer.start();
+        bool success = false;
+        switch (next) {
+            case KHealthCertificatePipeline::NoStage:
+                break;
+            case KHealthCertificatePipeline::FormatDetection:
+                success = detectFormat();
+                break;
+            case KHealthCertificatePipeline::TransportDecoding:
+                success = decodeTransport();
+                break;
+            case KHealthCertificatePipeline::Decompression:
+                success = decompress();
+                break;
+            case KHealthCertificatePipeline::EnvelopeParsing:
+                success = parseEnvelope();
+                break;
+            case KHealthCertificatePipeline::PayloadMapping:
+                success = mapPayload();
+                break;
+            case KHealthCertificatePipeline::SignatureVerification:
+                success = verifySignature();
+                break;
+        }
+
+        // results produced after hitting a limit are incomplete, e.g. lacking signature verification
+        if (context.limitExceeded()) {
+            success = false;
+            outcome = ParseOutcome::LimitExceeded;
+        } else if (!success) {
+            outcome = ParseOutcome::UnsupportedInput;
+        }
+        KHealthCertificateMetrics::recordStage(format, next, timer.nsecsElapsed(), success);
+        KHC_TRACEPOINT(stage_end, int(format), int(next), success);
+        if (!success) {
+            diagnostics.stage = next;
+            if (outcome == ParseOutcome::LimitExceeded) {
+                diagnostics.reason = KHealthCertificatePipeline::ResourceLimitExceeded;
+            } else {
+                diagnostics.reason = context.reason() != KHealthCertificatePipeline::NoReason ? context.reason() : defaultReason(next);
+            }
+            KHealthCertificateMetrics::recordOutcome(format, outcome);
+            error = true;
+            certificate = {};
+            return false;
+        }
+        stage = next;
+        if (stage == KHealthCertificatePipeline::SignatureVerification) {
+            auto reason = KHealthCertificatePipeline::NoReason;
+            if (signatureState == KHealthCertificate::InvalidSignature || signatureState == KHealthCertificate::UnknownSignature) {
+                reason = context.reason() != KHealthCertificatePipeline::NoReason ? context.reason() : defaultReason(stage);
+                diagnostics.stage = stage;
+                diagnostics.reason = reason;
+            }
+            KHealthCertificateMetrics::recordOutcome(format, outcome);
+            KHealthCertificateMetrics::recordSignatureState(format, signatureState, reason);
+        }
+    }
+    return true;
+}
+
+const QByteArray& KHealthCertificatePipelinePrivate::stageInput(KHealthCertificatePipeline::Stage stage) const
+{
+    switch (stage) {
+        case KHealthCertificatePipeline::NoStage:
+        case KHealthCertificatePipeline::FormatDetection:
+        case KHealthCertificatePipeline::TransportDecoding:
+            return input;
+        case KHealthCertificatePipeline::Decompression:
+            return transportDecoded;
+        case KHealthCertificatePipeline::EnvelopeParsing:
+            return decompressed;
+        case KHealthCertificatePipeline::PayloadMapping:
+        case KHealthCertificatePipeline::SignatureVerification:
+            break;
+    }
+    return payload;
+}
+
+// used when the failing code didn't provide a more specific reason
+KHealthCertificatePipeline::Reason KHealthCertificatePipelinePrivate::defaultReason(KHealthCertificatePipeline::Stage stage) const
+{
+    switch (stage) {
+        case KHealthCertificatePipeline::NoStage:
+            return KHealthCertificatePipeline::NoReason;
+        case KHealthCertificatePipeline::FormatDetection:
+            return KHealthCertificatePipeline::UnrecognizedFormat;
+        case KHealthCertificatePipeline::TransportDecoding:
+            return KHealthCertificatePipeline::InvalidTransportEncoding;
+        case KHealthCertificatePipeline::Decompression:
+            return format == KHealthCertificatePipeline::Divoc ? KHealthCertificatePipeline::MissingCredential : KHealthCertificatePipeline::DecompressionFailed;
+        case KHealthCertificatePipeline::EnvelopeParsing:
+            return KHealthCertificatePipeline::MalformedEnvelope;
+        case KHealthCertificatePipeline::PayloadMapping:
+            return KHealthCertificatePipeline::MalformedPayload;
+        case KHealthCertificatePipeline::SignatureVerification:
+            break;
+    }
+    return signatureState == KHealthCertificate::UnknownSignature ? KHealthCertificatePipeline::UnknownSigningKey : KHealthCertificatePipeline::SignatureMismatch;
+}
+
+static KHealthCertificatePipeline::Format detectJsonFormat(const QByteArray &data)
+{
+    // tell the JSON-based formats apart by their top-level members, ICAO VDS can be wrapped in an array
+    JsonStreamReader reader(data);
+    if (reader.isArray()) {
+        reader.enterContainer();
+    }
+    if (!reader.isObject()) {
+        return KHealthCertificatePipeline::UnknownFormat;
+    }
+    reader.enterContainer();
+    while (reader.hasNext()) {
+        const auto name = reader.readName();
+        if (name == "credentialSubject" || name == "@context") {
+            return KHealthCertificatePipeline::Divoc;
+        }
+        if (name == "data" || name == "sig") {
+            return KHealthCertificatePipeline::IcaoVds;
+        }
+        reader.next();
+    }
+    return KHealthCertificatePipeline::UnknownFormat;
+}
+
+bool KHealthCertificatePipelinePrivate::detectFormat()
+{
+    if (!ParseContext::checkLimit(input.size(), limits.maximumInputSize, "input size")) {
+        return false;
+    }
+
+    if (input.startsWith("HC1:") || input.startsWith("DK3:")) {
+        format = KHealthCertificatePipeline::EuDgc;
+    } else if (input.startsWith("shc:/")) {
+        format = KHealthCertificatePipeline::SmartHealthCard;
+    } else if (input.startsWith("NL2:")) {
+        format = KHealthCertificatePipeline::NLCoronaCheck;
+    } else if (ZipReader::isZip(input)) {
+        // ZIP unpacking (needed for Indian certificates)
+        format = KHealthCertificatePipeline::Divoc;
+    } else {
+        format = detectJsonFormat(input);
+    }
+    return format != KHealthCertificatePipeline::UnknownFormat;
+}
+
+bool KHealthCertificatePipelinePrivate::decodeTransport()
+{
+    switch (format) {
+        case KHealthCertificatePipeline::EuDgc:
+            transportDecoded = EuDgcParser::decodeTransport(input);
+            break;
+        case KHealthCertificatePipeline::SmartHealthCard:
+            transportDecoded = ShcParser::decodeTransport(input);
+            break;
+        case KHealthCertificatePipeline::NLCoronaCheck:
+            transportDecoded = NLCoronaCheckParser::decodeTransport(input);
+            break;
+        case KHealthCertificatePipeline::Divoc:
+        case KHealthCertificatePipeline::IcaoVds:
+            transportDecoded = input;
+            break;
+        case KHealthCertificatePipeline::UnknownFormat:
+            return false;
+    }
+    return !transportDecoded.isEmpty();
+}
+
+bool KHealthCertificatePipelinePrivate::decompress()
+{
+    switch (format) {
+        case KHealthCertificatePipeline::EuDgc:
+            decompressed = EuDgcParser::decompress(transportDecoded);
+            break;
+        case KHealthCertificatePipeline::Divoc:
+            decompressed = DivocParser::unpack(transportDecoded);
+            break;
+        case KHealthCertificatePipeline::SmartHealthCard: // JWS payload decompression is part of the envelope
+        case KHealthCertificatePipeline::IcaoVds:
+        case KHealthCertificatePipeline::NLCoronaCheck:
+            decompressed = transportDecoded;
+            break;
+        case KHealthCertificatePipeline::UnknownFormat:
+            return false;
+    }
+    return !decompressed.isEmpty();
+}
+
+bool KHealthCertificatePipelinePrivate::parseEnvelope()
+{
+    switch (format) {
+        case KHealthCertificatePipeline::EuDgc:
+        {
+            auto &cose = envelope.emplace<CoseParser>();
+            cose.parse(decompressed);
+            payload = cose.payload();
+            keyId = cose.keyId();
+            break;
+        }
+        case KHealthCertificatePipeline::SmartHealthCard:
+        {
+            auto &jwt = envelope.emplace<JwtParser>();
+            jwt.parse(decompressed);
+            payload = jwt.payload();
+            keyId = jwt.keyId();
+            break;
+        }
+        case KHealthCertificatePipeline::Divoc:
+        {
+            const auto doc = QJsonDocument::fromJson(decompressed);
+            if (!doc.isObject()) {
+                return false;
+            }
+            const auto obj = doc.object();
+            envelope = obj;
+            payload = decompressed;
+            keyId = obj.value(QLatin1String("proof")).toObject().value(QLatin1String("verificationMethod")).toString().toUtf8();
+            break;
+        }
+        case KHealthCertificatePipeline::IcaoVds:
+        {
+            const auto vds = IcaoVdsParser::parseEnvelope(decompressed);
+            if (vds.isEmpty()) {
+                return false;
+            }
+            envelope = vds;
+            payload = decompressed;
+            keyId = IcaoVdsParser::keyId(vds);
+            break;
+        }
+        case KHealthCertificatePipeline::NLCoronaCheck:
+        {
+            auto &proof = envelope.emplace<NLCoronaCheckProof>();
+            if (!NLCoronaCheckParser::parseEnvelope(decompressed, proof)) {
+                return false;
+            }
+            payload = decompressed;
+            keyId = proof.issuer.toUtf8();
+            break;
+        }
+        case KHealthCertificatePipeline::UnknownFormat:
+            return false;
+    }
+    return !payload.isEmpty();
+}
+
+static void setSignatureState(KHealthCertificateParser::Certificate &certificate, KHealthCertificate::SignatureValidation state)
+{
+    std::visit([state](auto &cert) {
+        if constexpr (!std::is_same_v<std::decay_t<decltype(cert)>, std::monostate>) {
+            cert.setSignatureState(state);
+        }
+    }, certificate);
+}
+
+static QDateTime certificateIssueDate(const KHealthCertificateParser::Certificate &certificate)
+{
+    return std::visit([](const auto &cert) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(cert)>, std::monostate>) {
+            return QDateTime();
+        } else {
+            return cert.certificateIssueDate();
+        }
+    }, certificate);
+}
+
+bool KHealthCertificatePipelinePrivate::mapPayload()
+{
+    switch (format) {
+        case KHealthCertificatePipeline::EuDgc:
+        {
+            EuDgcParser parser;
+            certificate = parser.parsePayload(payload, input);
+            break;
+        }
+        case KHealthCertificatePipeline::SmartHealthCard:
+            certificate = ShcParser::parsePayload(payload, input);
+            break;
+        case KHealthCertificatePipeline::Divoc:
+            // only store the raw data for ZIP archives, not for the plain credential
+            certificate = DivocParser::parseCredential(std::get<QJsonObject>(envelope), ZipReader::isZip(input) ? input : QByteArray());
+            break;
+        case KHealthCertificatePipeline::IcaoVds:
+            certificate = IcaoVdsParser::parsePayload(std::get<QJsonObject>(envelope), input);
+            break;
+        case KHealthCertificatePipeline::NLCoronaCheck:
+            certificate = NLCoronaCheckParser::parsePayload(std::get<NLCoronaCheckProof>(envelope), input);
+            break;
+        case KHealthCertificatePipeline::UnknownFormat:
+            return false;
+    }
+
+    if (std::holds_alternative<std::monostate>(certificate)) {
+        return false;
+    }
+    setSignatureState(certificate, KHealthCertificate::UncheckedSignature);
+    return true;
+}
+
+bool KHealthCertificatePipelinePrivate::verifySignature()
+{
+    auto state = KHealthCertificate::UncheckedSignature;
+    switch (format) {
+        case KHealthCertificatePipeline::EuDgc:
+        {
+            auto &cose = std::get<CoseParser>(envelope);
+            cose.verifySignature();
+            state = EuDgcParser::signatureState(cose, certificateIssueDate(certificate));
+            break;
+        }
+        case KHealthCertificatePipeline::SmartHealthCard:
+            state = std::get<JwtParser>(envelope).verifySignature(std::get<KVaccinationCertificate>(certificate).certificateIssuer());
+            break;
+        case KHealthCertificatePipeline::Divoc:
+            state = DivocParser::verifySignature(std::get<QJsonObject>(envelope));
+            break;
+        case KHealthCertificatePipeline::IcaoVds:
+            state = IcaoVdsParser::verifySignature(std::get<QJsonObject>(envelope), decompressed);
+            break;
+        case KHealthCertificatePipeline::NLCoronaCheck:
+            state = NLCoronaCheckParser::verifySignature(std::get<NLCoronaCheckProof>(envelope));
+            break;
+        case KHealthCertificatePipeline::UnknownFormat:
+            return false;
+    }
+
+    setSignatureState(certificate, state);
+    signatureState = state;
+
+    // failed verifications leave entries in the (per-thread) OpenSSL error queue, don't let those pile up
+    ERR_clear_error();
+    return true;
+}
+
+KHealthCertificatePipeline::KHealthCertificatePipeline(const QByteArray &data, const KHealthCertificateParser::ParseLimits &limits)
+    : d(std::make_unique<KHealthCertificatePipelinePrivate>())
+{
+    KHealthCertificateParser::initResources();
+    d->input = data;
+    d->limits = limits;
+}
+
+KHealthCertificatePipeline::KHealthCertificatePipeline(KHealthCertificatePipeline &&) noexcept = default;
+KHealthCertificatePipeline::~KHealthCertificatePipeline() = default;
+KHealthCertificatePipeline& KHealthCertificatePipeline::operator=(KHealthCertificatePipeline &&) noexcept = default;
+
+QByteArray KHealthCertificatePipeline::input() const
+{
+    return d->input;
+}
+
+KHealthCertificatePipeline::Stage KHealthCertificatePipeline::stage() const
+{
+    return d->stage;
+}
+
+bool KHealthCertificatePipeline::hasError() const
+{
+    return d->error;
+}
+
+KHealthCertificateParser::ParseOutcome KHealthCertificatePipeline::outcome() const
+{
+    return d->outcome;
+}
+
+KHealthCertificatePipeline::Diagnostics KHealthCertificatePipeline::diagnostics() const
+{
+    return d->diagnostics;
+}
+
+KHealthCertificatePipeline::Format KHealthCertificatePipeline::detectFormat()
+{
+    d->run(FormatDetection);
+    return d->format;
+}
+
+KHealthCertificatePipeline::Format KHealthCertificatePipeline::format() const
+{
+    return d->format;
+}
+
+bool KHealthCertificatePipeline::decodeTransport()
+{
+    return d->run(TransportDecoding);
+}
+
+QByteArray KHealthCertificatePipeline::transportDecodedData() const
+{
+    return d->transportDecoded;
+}
+
+bool KHealthCertificatePipeline::decompress()
+{
+    return d->run(Decompression);
+}
+
+QByteArray KHealthCertificatePipeline::decompressedData() const
+{
+    return d->decompressed;
+}
+
+bool KHealthCertificatePipeline::parseEnvelope()
+{
+    return d->run(EnvelopeParsing);
+}
+
+QByteArray KHealthCertificatePipeline::payload() const
+{
+    return d->payload;
+}
+
+QByteArray KHealthCertificatePipeline::keyId() const
+{
+    return d->keyId;
+}
+
+bool KHealthCertificatePipeline::mapPayload()
+{
+    return d->run(PayloadMapping);
+}
+
+bool KHealthCertificatePipeline::verifySignature()
+{
+    return d->run(SignatureVerification);
+}
+
+QVariant KHealthCertificatePipeline::certificate() const
+{
+    return KHealthCertificateParser::toVariant(d->certificate);
+}
+
+KHealthCertificateParser::Certificate KHealthCertificatePipeline::typedCertificate() const
+{
+    return d->certificate;
+}
@@ -0,0 +1,147 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KHEALTHCERTIFICATEPIPELINE_H
+#define KHEALTHCERTIFICATEPIPELINE_H
+
+#include "khealthcertificate_export.h"
+#include "khealthcertificateparser.h"
+
+#include <memory>
+
+class KHealthCertificatePipelinePrivate;
+
+class QByteArray;
+class QVariant;
+
+/** Step-by-step parsing of a single health certificate.
+ *
+ *  This is the staged equivalent of KHealthCertificateParser::parse(), it exposes
+ *  the intermediate results of each processing stage. That allows to e.g. run
+ *  one stage on a whole batch of certificates before continuing with the next one,
+ *  or to group certificates by their signing key before verifying them.
+ *
+ *  Stages are run in the order they are declared in below. Running a stage implicitly
+ *  runs all preceding stages that haven't been run yet. Stages that don't apply to
+ *  a certain format pass their input through unchanged.
+ *
+ *  This class is reentrant, separate instances can be used from different threads
+ *  at the same time.
+ */
+class KHEALTHCERTIFICATE_EXPORT KHealthCertificatePipeline
+{
+public:
+    /** Supported certificate formats. */
+    enum Format {
+        UnknownFormat,
+        EuDgc, ///< EU Digital COVID Certificate
+        Divoc, ///< DIVOC (India)
+        SmartHealthCard, ///< SMART Health Cards
+        IcaoVds, ///< ICAO Visible Digital Seal for non-constrained environments
+        NLCoronaCheck, ///< NL CoronaCheck
+    };
+
+    /** Processing stages. */
+    enum Stage {
+        NoStage, ///< nothing has been done yet
+        FormatDetection,
+        TransportDecoding,
+        Decompression,
+        EnvelopeParsing,
+        PayloadMapping,
+        SignatureVerification,
+    };
+
+    /** Machine-readable reasons for processing failures or signature verification problems. */
+    enum Reason {
+        NoReason,
+        UnrecognizedFormat, ///< input doesn't match any supported format
+        InvalidTransportEncoding, ///< e.g. invalid base45 or SHC numeric data
+        DecompressionFailed, ///< compressed data is corrupt
+        MissingCredential, ///< archive doesn't contain a certificate
+        MalformedEnvelope, ///< invalid COSE, JWS, VDS or IRMA proof structure
+        UnsupportedVersion, ///< envelope or payload version not supported
+        MalformedPayload, ///< payload doesn't contain a valid certificate
+        UnknownSigningKey, ///< signing key or certificate isn't in the trust store
+        UnsupportedSignatureAlgorithm, ///< signature algorithm not implemented
+        SignatureMismatch, ///< signature doesn't match the signed content
+        InvalidSigningCertificate, ///< signing certificate isn't valid, e.g. expired or not issued by a trusted authority
+        SpecimenCertificate, ///< certificate is marked as specimen
+        ResourceLimitExceeded, ///< input exceeds the KHealthCertificateParser::ParseLimits
+    };
+
+    /** Details about why processing failed, or why a signature couldn't be verified. */
+    struct Diagnostics {
+        /** The stage that failed, or SignatureVerification for signature problems. */
+        Stage stage = NoStage;
+        Reason reason = NoReason;
+    };
+
+    explicit KHealthCertificatePipeline(const QByteArray &data, const KHealthCertificateParser::ParseLimits &limits = {});
+    KHealthCertificatePipeline(KHealthCertificatePipeline &&) noexcept;
+    ~KHealthCertificatePipeline();
+    KHealthCertificatePipeline& operator=(KHealthCertificatePipeline &&) noexcept;
+
+    /** The input data. */
+    QByteArray input() const;
+    /** The last stage that completed successfully. */
+    Stage stage() const;
+    /** @c true if processing failed at the stage following stage(). */
+    bool hasError() const;
+    /** Reason for a failure, or KHealthCertificateParser::ParseOutcome::Success. */
+    KHealthCertificateParser::ParseOutcome outcome() const;
+    /** Details on a failure or a signature verification problem.
+     *  Empty if processing succeeded and the signature is valid or hasn't been checked yet.
+     */
+    Diagnostics diagnostics() const;
+
+    /** Determine the certificate format.
+     *  This only inspects a small part of the input, the format isn't validated beyond that.
+     */
+    Format detectFormat();
+    /** The detected format, UnknownFormat if detectFormat() hasn't been run yet or has failed. */
+    Format format() const;
+
+    /** Decode the transport encoding (base45, SHC numeric encoding, etc), if any. */
+    bool decodeTransport();
+    QByteArray transportDecodedData() const;
+
+    /** Decompress the decoded data, if the format requires that.
+     *  For ZIP archives this is the extracted certificate.
+     */
+    bool decompress();
+    QByteArray decompressedData() const;
+
+    /** Parse the signed envelope (COSE, JWS, VDS, IRMA proof).
+     *  This does not verify the signature yet.
+     */
+    bool parseEnvelope();
+    /** The signed content of the envelope.
+     *  For JSON based formats this is the entire document.
+     */
+    QByteArray payload() const;
+    /** Identifier of the key needed for signature verification, if the format has that. */
+    QByteArray keyId() const;
+
+    /** Map the payload to a certificate object.
+     *  Signature state of the result is KHealthCertificate::UncheckedSignature at this point.
+     */
+    bool mapPayload();
+    /** Verify the signature, this completes processing. */
+    bool verifySignature();
+
+    /** The certificate, if mapPayload() succeeded.
+     *  This is either a KVaccinationCertificate, a KTestCertificate or a KRecoveryCertificate,
+     *  or a null QVariant if processing failed or hasn't gotten far enough.
+     */
+    QVariant certificate() const;
+    /** Same as certificate(), without boxing the result into a QVariant. */
+    KHealthCertificateParser::Certificate typedCertificate() const;
+
+private:
+    std::unique_ptr<KHealthCertificatePipelinePrivate> d;
+};
+
+#endif // KHEALTHCERTIFICATEPIPELINE_H
@@ -0,0 +1,333 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "khealthcertificateserializer.h"
+#include "krecoverycertificate_p.h"
+#include "ktestcertificate_p.h"
+#include "kvaccinationcertificate_p.h"
+#include "logging.h"
+#include "stringpool_p.h"
+#include "eu-dgc/cborutils_p.h"
+
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QTimeZone>
+#include <QUrl>
+
+#include <type_traits>
+
+using namespace KHealthCertificateInternal;
+
+// Encoding: CBOR array of
+// - format version
+// - certificate type (KHealthCertificate::CertificateType)
+// - signature state (KHealthCertificate::SignatureValidation)
+// - trust store version the signature state was obtained with
+// - the certificate fields, in the order defined by visitFields()
+
+namespace {
+enum FieldFlag {
+    Plain,
+    Pooled, ///< value is shared among many certificates, see StringPool
+};
+}
+
+// New fields must only ever be appended at the end, older data then just lacks those
+// and older readers ignore them. Anything else requires a new format version.
+template <typename Private, typename F>
+static void visitFields(Private &d, F &&f)
+{
+    using P = std::remove_const_t<Private>;
+    f(d.name, Plain);
+    f(d.dateOfBirth, Plain);
+    if constexpr (std::is_same_v<P, KVaccinationCertificatePrivate>) {
+        f(d.date, Plain);
+        f(d.disease, Pooled);
+        f(d.vaccineType, Pooled);
+        f(d.vaccine, Pooled);
+        f(d.vaccineUrl, Plain);
+        f(d.manufacturer, Pooled);
+        f(d.dose, Plain);
+        f(d.totalDoses, Plain);
+        f(d.country, Pooled);
+    } else if constexpr (std::is_same_v<P, KTestCertificatePrivate>) {
+        f(d.date, Plain);
+        f(d.disease, Pooled);
+        f(d.testType, Pooled);
+        f(d.testName, Pooled);
+        f(d.testUrl, Plain);
+        f(d.result, Plain);
+        f(d.resultString, Pooled);
+        f(d.testCenter, Plain);
+        f(d.country, Pooled);
+    } else {
+        static_assert(std::is_same_v<P, KRecoveryCertificatePrivate>);
+        f(d.dateOfPositiveTest, Plain);
+        f(d.validFrom, Plain);
+        f(d.validUntil, Plain);
+        f(d.disease, Pooled);
+    }
+    f(d.certificateIssuer, Plain);
+    f(d.certificateId, Plain);
+    f(d.certificateIssueDate, Plain);
+    f(d.certificateExpiryDate, Plain);
+    f(d.rawData, Plain);
+}
+
+static void writeValue(QCborStreamWriter &writer, const QString &value)
+{
+    writer.append(value);
+}
+
+static void writeValue(QCborStreamWriter &writer, qint64 value)
+{
+    writer.append(value);
+}
+
+static void writeValue(QCborStreamWriter &writer, QDate value)
+{
+    if (value.isValid()) {
+        writer.append(value.toJulianDay());
+    } else {
+        writer.appendNull();
+    }
+}
+
+static void writeValue(QCborStreamWriter &writer, const QDateTime &value)
+{
+    if (!value.isValid()) {
+        writer.appendNull();
+        return;
+    }
+    if (value.timeSpec() == Qt::LocalTime) {
+        writer.append(value.toMSecsSinceEpoch());
+        return;
+    }
+    writer.startArray(2);
+    writer.append(value.toMSecsSinceEpoch());
+    writer.append(qint64(value.offsetFromUtc()));
+    writer.endArray();
+}
+
+static void writeValue(QCborStreamWriter &writer, const QUrl &value)
+{
+    writer.append(value.toString(QUrl::FullyEncoded));
+}
+
+static void writeValue(QCborStreamWriter &writer, const QByteArray &value)
+{
+    writer.append(value);
+}
+
+template <typename T, typename Source>
+static void writeValue(QCborStreamWriter &writer, const Lazy<T, Source> &value)
+{
+    writeValue(writer, value.value());
+}
+
+static bool readValue(QCborStreamReader &reader, QString &value, FieldFlag flag)
+{
+    if (!reader.isString()) {
+        return false;
+    }
+    value = CborUtils::readString(reader);
+    if (flag == Pooled) {
+        value = StringPool::intern(value);
+    }
+    return true;
+}
+
+static bool readValue(QCborStreamReader &reader, int &value, FieldFlag)
+{
+    if (!reader.isInteger()) {
+        return false;
+    }
+    value = CborUtils::readInteger(reader);
+    return true;
+}
+
+template <typename T>
+static bool readValue(QCborStreamReader &reader, T &value, FieldFlag)
+{
+    static_assert(std::is_enum_v<T>);
+    if (!reader.isInteger()) {
+        return false;
+    }
+    value = static_cast<T>(CborUtils::readInteger(reader));
+    return true;
+}
+
+static bool readValue(QCborStreamReader &reader, QDate &value, FieldFlag)
+{
+    if (reader.isNull()) {
+        value = {};
+        return reader.next();
+    }
+    if (!reader.isInteger()) {
+        return false;
+    }
+    value = QDate::fromJulianDay(CborUtils::readInteger(reader));
+    return true;
+}
+
+static bool readValue(QCborStreamReader &reader, QDateTime &value, FieldFlag)
+{
+    if (reader.isNull()) {
+        value = {};
+        return reader.next();
+    }
+    if (reader.isInteger()) {
+        value = QDateTime::fromMSecsSinceEpoch(CborUtils::readInteger(reader));
+        return true;
+    }
+    if (!reader.isArray()) {
+        return false;
+    }
+    reader.enterContainer();
+    if (!reader.isInteger()) {
+        return false;
+    }
+    const auto msecs = CborUtils::readInteger(reader);
+    if (!reader.isInteger()) {
+        return false;
+    }
+    const auto offset = CborUtils::readInteger(reader);
+    value = QDateTime::fromMSecsSinceEpoch(msecs, offset == 0 ? QTimeZone::utc() : QTimeZone(static_cast<int>(offset)));
+    return reader.leaveContainer();
+}
+
+static bool readValue(QCborStreamReader &reader, QUrl &value, FieldFlag)
+{
+    if (!reader.isString()) {
+        return false;
+    }
+    value = QUrl(CborUtils::readString(reader));
+    return true;
+}
+
+static bool readValue(QCborStreamReader &reader, QByteArray &value, FieldFlag)
+{
+    if (!reader.isByteArray()) {
+        return false;
+    }
+    value = CborUtils::readByteArray(reader);
+    return true;
+}
+
+template <typename T, typename Source>
+static bool readValue(QCborStreamReader &reader, Lazy<T, Source> &value, FieldFlag flag)
+{
+    T v;
+    if (!readValue(reader, v, flag)) {
+        return false;
+    }
+    value = std::move(v);
+    return true;
+}
+
+static const KVaccinationCertificatePrivate* privateData(const KVaccinationCertificate &cert) { return KVaccinationCertificatePrivate::get(cert); }
+static const KTestCertificatePrivate* privateData(const KTestCertificate &cert) { return KTestCertificatePrivate::get(cert); }
+static const KRecoveryCertificatePrivate* privateData(const KRecoveryCertificate &cert) { return KRecoveryCertificatePrivate::get(cert); }
+
+static constexpr KHealthCertificate::CertificateType certificateType(const KVaccinationCertificate&) { return KHealthCertificate::Vaccination; }
+static constexpr KHealthCertificate::CertificateType certificateType(const KTestCertificate&) { return KHealthCertificate::Test; }
+static constexpr KHealthCertificate::CertificateType certificateType(const KRecoveryCertificate&) { return KHealthCertificate::Recovery; }
+
+QByteArray KHealthCertificateSerializer::serialize(const KHealthCertificateParser::Certificate &certificate)
+{
+    return std::visit([](const auto &cert) {
+        QByteArray data;
+        if constexpr (!std::is_same_v<std::decay_t<decltype(cert)>, std::monostate>) {
+            const auto d = privateData(cert);
+            QCborStreamWriter writer(&data);
+            writer.startArray();
+            writer.append(qint64(FormatVersion));
+            writer.append(qint64(certificateType(cert)));
+            writer.append(qint64(d->signatureState));
+            writer.append(KHealthCertificateParser::trustStoreVersion());
+            visitFields(*d, [&writer](const auto &value, FieldFlag) {
+                writeValue(writer, value);
+            });
+            writer.endArray();
+        }
+        return data;
+    }, certificate);
+}
+
+template <typename Private>
+static typename Private::Certificate readCertificate(QCborStreamReader &reader, KHealthCertificate::SignatureValidation signatureState, bool &ok)
+{
+    CertificateBuilder<Private> cert;
+    visitFields(*cert, [&reader, &ok](auto &value, FieldFlag flag) {
+        if (ok && reader.hasNext()) {
+            ok = readValue(reader, value, flag);
+        }
+    });
+    cert->signatureState = signatureState;
+    return cert.build();
+}
+
+KHealthCertificateParser::Certificate KHealthCertificateSerializer::deserialize(const QByteArray &data, QByteArray *trustStoreVersion)
+{
+    QCborStreamReader reader(data);
+    if (!reader.isArray()) {
+        return {};
+    }
+    reader.enterContainer();
+
+    if (!reader.isInteger()) {
+        return {};
+    }
+    const auto version = CborUtils::readInteger(reader);
+    if (version < 1 || version > FormatVersion) {
+        qCDebug(Log) << "unsupported serialization format version:" << version;
+        return {};
+    }
+
+    if (!reader.isInteger()) {
+        return {};
+    }
+    const auto type = CborUtils::readInteger(reader);
+    if (!reader.isInteger()) {
+        return {};
+    }
+    const auto signatureState = CborUtils::readInteger(reader);
+    if (signatureState < KHealthCertificate::ValidSignature || signatureState > KHealthCertificate::UncheckedSignature || !reader.isByteArray()) {
+        return {};
+    }
+    const auto storeVersion = CborUtils::readByteArray(reader);
+
+    bool ok = true;
+    KHealthCertificateParser::Certificate result;
+    const auto sigState = static_cast<KHealthCertificate::SignatureValidation>(signatureState);
+    switch (type) {
+        case KHealthCertificate::Vaccination:
+            result = readCertificate<KVaccinationCertificatePrivate>(reader, sigState, ok);
+            break;
+        case KHealthCertificate::Test:
+            result = readCertificate<KTestCertificatePrivate>(reader, sigState, ok);
+            break;
+        case KHealthCertificate::Recovery:
+            result = readCertificate<KRecoveryCertificatePrivate>(reader, sigState, ok);
+            break;
+        default:
+            qCDebug(Log) << "unknown serialized certificate type:" << type;
+            return {};
+    }
+
+    // fields added by newer versions of this format
+    while (ok && reader.hasNext()) {
+        ok = CborUtils::skip(reader);
+    }
+    if (!ok || !reader.leaveContainer() || reader.lastError() != QCborError::NoError) {
+        qCDebug(Log) << "invalid serialized certificate data";
+        return {};
+    }
+
+    if (trustStoreVersion) {
+        *trustStoreVersion = storeVersion;
+    }
+    return result;
+}
@@ -0,0 +1,44 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KHEALTHCERTIFICATESERIALIZER_H
+#define KHEALTHCERTIFICATESERIALIZER_H
+
+#include "khealthcertificate_export.h"
+#include "khealthcertificateparser.h"
+
+#include <QByteArray>
+
+/** Compact binary encoding of parsed certificates.
+ *
+ *  This allows to persist certificates including their signature verification result,
+ *  so they don't need to be parsed and verified again on every application start.
+ *  The encoding is versioned, newer versions of this library can read data written
+ *  by older ones.
+ *
+ *  Decoded values are what the parser produced when encoding, ie. translated
+ *  values are in the language that was active back then.
+ */
+namespace KHealthCertificateSerializer
+{
+    /** Version of the format written by serialize(). */
+    constexpr inline const int FormatVersion = 1;
+
+    /** Encode @p certificate.
+     *  The signature verification result of @p certificate is assumed to be obtained with
+     *  the current KHealthCertificateParser::trustStoreVersion(), which is recorded alongside.
+     *  @returns an empty byte array for std::monostate.
+     */
+    KHEALTHCERTIFICATE_EXPORT QByteArray serialize(const KHealthCertificateParser::Certificate &certificate);
+
+    /** Decode a certificate previously encoded with serialize().
+     *  @param trustStoreVersion If not @c nullptr, this is set to the trust store version
+     *  the signature verification result was obtained with.
+     *  @returns std::monostate for invalid input or input of an unsupported format version.
+     */
+    KHEALTHCERTIFICATE_EXPORT KHealthCertificateParser::Certificate deserialize(const QByteArray &data, QByteArray *trustStoreVersion = nullptr);
+}
+
+#endif // KHEALTHCERTIFICATESERIALIZER_H
@@ -0,0 +1,521 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "khealthcertificatestore.h"
+#include "khealthcertificateserializer.h"
+#include "logging.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QHash>
+#include <QtEndian>
+
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// File layout:
+// - file header: Magic, StoreVersion
+// - any number of records, each consisting of a RecordHeader, the UTF-8 encoded
+//   certificate id and the KHealthCertificateSerializer encoding of the certificate
+// All integers are little endian.
+
+constexpr inline const char Magic[] = { 'K', 'H', 'C', 'S' };
+constexpr inline const quint32 StoreVersion = 1;
+constexpr inline const qint64 FileHeaderSize = sizeof(Magic) + sizeof(quint32);
+constexpr inline const int DigestSize = 32;
+// certificates are a few kB at most, anything beyond this is garbage
+constexpr inline const quint32 MaximumRecordSize = 1024 * 1024;
+
+namespace {
+enum RecordKind : quint16 {
+    CertificateRecord = 0,
+    RemovalRecord = 1, ///< removes the certificate with the same raw data digest, no id or payload
+};
+
+struct RecordHeader {
+    quint32 size; ///< size of the entire record, including this header
+    quint16 kind;
+    quint16 idSize;
+    char rawDataDigest[DigestSize];
+};
+static_assert(sizeof(RecordHeader) == 40);
+}
+
+template <typename Func>
+static auto visitCertificate(const KHealthCertificateParser::Certificate &certificate, Func &&func)
+{
+    return std::visit([&func](const auto &cert) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(cert)>, std::monostate>) {
+            return decltype(func(std::declval<KVaccinationCertificate>()))();
+        } else {
+            return func(cert);
+        }
+    }, certificate);
+}
+
+static QByteArray rawData(const KHealthCertificateParser::Certificate &certificate)
+{
+    return visitCertificate(certificate, [](const auto &cert) { return cert.rawData(); });
+}
+
+static QString certificateId(const KHealthCertificateParser::Certificate &certificate)
+{
+    return visitCertificate(certificate, [](const auto &cert) { return cert.certificateId(); });
+}
+
+class KHealthCertificateStorePrivate
+{
+public:
+    static QByteArray digest(const QByteArray &rawData);
+
+    bool map();
+    void unmap();
+
+    RecordHeader header(qint64 offset) const;
+    bool isRecordChain(qint64 offset) const;
+    QString certificateId(qint64 offset) const;
+    QByteArray payload(qint64 offset) const;
+    KHealthCertificateParser::Certificate load(qint64 offset, QByteArray *trustStoreVersion = nullptr) const;
+    /** Like load(), but with the verification result updated if necessary. */
+    KHealthCertificateParser::Certificate loadCurrent(qint64 offset) const;
+
+    void indexRecord(qint64 offset, const RecordHeader &header);
+    void removeCertificateId(const QString &id, const QByteArray &digest);
+    void compact();
+    bool append(RecordKind kind, const QByteArray &digest, const QString &certificateId, const QByteArray &payload);
+    bool appendCertificate(const QByteArray &digest, const KHealthCertificateParser::Certificate &certificate);
+
+    QFile file;
+    uchar *data = nullptr;
+    qint64 size = 0;
+    QString errorString;
+
+    struct Entry {
+        QByteArray digest;
+        QString certificateId;
+        qint64 offset = -1; ///< offset of the current record, -1 for removed certificates
+    };
+    // certificates in insertion order, removed ones are only dropped by compact()
+    // before the next index-based access, so that removals don't need to shift everything
+    std::vector<Entry> entries;
+    QHash<QByteArray, qsizetype> entriesByDigest; // raw data digest -> index in entries
+    qsizetype removedCount = 0;
+    QHash<QString, QList<QByteArray>> digestsByCertificateId; // in order of addition
+};
+
+QByteArray KHealthCertificateStorePrivate::digest(const QByteArray &rawData)
+{
+    return QCryptographicHash::hash(rawData, QCryptographicHash::Sha256);
+}
+
+bool KHealthCertificateStorePrivate::map()
+{
+    unmap();
+    size = file.size();
+    if (size == 0) {
+        return true;
+    }
+    data = file.map(0, size);
+    if (!data) {
+        errorString = file.errorString();
+        size = 0;
+        return false;
+    }
+    return true;
+}
+
+void KHealthCertificateStorePrivate::unmap()
+{
+    if (data) {
+        file.unmap(data);
+        data = nullptr;
+    }
+    size = 0;
+}
+
+RecordHeader KHealthCertificateStorePrivate::header(qint64 offset) const
+{
+    RecordHeader header;
+    std::memcpy(&header, data + offset, sizeof(RecordHeader));
+    header.size = qFromLittleEndian(header.size);
+    header.kind = qFromLittleEndian(header.kind);
+    header.idSize = qFromLittleEndian(header.idSize);
+    return header;
+}
+
+// checks whether plausible records start at @p offset and continue up to the end of the file
+bool KHealthCertificateStorePrivate::isRecordChain(qint64 offset) const
+{
+    while (size - offset >= qint64(sizeof(RecordHeader))) {
+        const auto h = header(offset);
+        if ((h.kind != CertificateRecord && h.kind != RemovalRecord) || h.size < sizeof(RecordHeader) + h.idSize || h.size > MaximumRecordSize) {
+            return false;
+        }
+        offset += h.size;
+    }
+    return offset == size;
+}
+
+QString KHealthCertificateStorePrivate::certificateId(qint64 offset) const
+{
+    const auto h = header(offset);
+    return QString::fromUtf8(reinterpret_cast<const char*>(data + offset + sizeof(RecordHeader)), h.idSize);
+}
+
+QByteArray KHealthCertificateStorePrivate::payload(qint64 offset) const
+{
+    const auto h = header(offset);
+    const auto payloadOffset = offset + sizeof(RecordHeader) + h.idSize;
+    // not copied, this is only valid until the next remapping
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(data + payloadOffset), offset + h.size - payloadOffset);
+}
+
+KHealthCertificateParser::Certificate KHealthCertificateStorePrivate::load(qint64 offset, QByteArray *trustStoreVersion) const
+{
+    auto cert = KHealthCertificateSerializer::deserialize(payload(offset), trustStoreVersion);
+    if (std::holds_alternative<std::monostate>(cert)) {
+        qCWarning(Log) << "failed to decode stored certificate in" << file.fileName() << offset;
+        return cert;
+    }
+    // the stored verification result is only meaningful for the raw data it was obtained for
+    const auto h = header(offset);
+    if (digest(rawData(cert)) != QByteArray::fromRawData(h.rawDataDigest, DigestSize)) {
+        qCWarning(Log) << "stored certificate doesn't match its raw data digest in" << file.fileName() << offset;
+        return {};
+    }
+    return cert;
+}
+
+KHealthCertificateParser::Certificate KHealthCertificateStorePrivate::loadCurrent(qint64 offset) const
+{
+    QByteArray trustStoreVersion;
+    auto cert = load(offset, &trustStoreVersion);
+    if (!std::holds_alternative<std::monostate>(cert) && trustStoreVersion != KHealthCertificateParser::trustStoreVersion()) {
+        // stored verification result is outdated
+        cert = KHealthCertificateParser::parseCertificate(rawData(cert));
+    }
+    return cert;
+}
+
+void KHealthCertificateStorePrivate::indexRecord(qint64 offset, const RecordHeader &header)
+{
+    if (header.kind != CertificateRecord && header.kind != RemovalRecord) {
+        qCDebug(Log) << "skipping unknown record type:" << header.kind;
+        return;
+    }
+
+    const QByteArray digest(header.rawDataDigest, DigestSize);
+    const auto it = entriesByDigest.constFind(digest);
+    if (header.kind == RemovalRecord) {
+        if (it == entriesByDigest.constEnd()) {
+            return;
+        }
+        auto &entry = entries[it.value()];
+        removeCertificateId(entry.certificateId, digest);
+        entry = {};
+        ++removedCount;
+        entriesByDigest.erase(it);
+        return;
+    }
+
+    const auto id = certificateId(offset);
+    if (it == entriesByDigest.constEnd()) {
+        entriesByDigest.insert(digest, entries.size());
+        entries.push_back({ digest, id, offset });
+    } else {
+        auto &entry = entries[it.value()];
+        removeCertificateId(entry.certificateId, digest);
+        entry.certificateId = id;
+        entry.offset = offset;
+    }
+    if (!id.isEmpty()) {
+        digestsByCertificateId[id].push_back(digest);
+    }
+}
+
+void KHealthCertificateStorePrivate::removeCertificateId(const QString &id, const QByteArray &digest)
+{
+    const auto it = digestsByCertificateId.find(id);
+    if (it == digestsByCertificateId.end()) {
+        return;
+    }
+    it.value().removeOne(digest);
+    if (it.value().isEmpty()) {
+        digestsByCertificateId.erase(it);
+    }
+}
+
+void KHealthCertificateStorePrivate::compact()
+{
+    if (removedCount == 0) {
+        return;
+    }
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].offset < 0) {
+            continue;
+        }
+        if (i != count) {
+            entries[count] = std::move(entries[i]);
+            entriesByDigest[entries[count].digest] = count;
+        }
+        ++count;
+    }
+    entries.resize(count);
+    removedCount = 0;
+}
+
+bool KHealthCertificateStorePrivate::append(RecordKind kind, const QByteArray &digest, const QString &certificateId, const QByteArray &payload)
+{
+    const auto id = certificateId.toUtf8();
+    const auto recordSize = qsizetype(sizeof(RecordHeader)) + id.size() + payload.size();
+    if (digest.size() != DigestSize || id.size() > std::numeric_limits<quint16>::max() || recordSize > MaximumRecordSize) {
+        errorString = QStringLiteral("Certificate too large to be stored.");
+        return false;
+    }
+
+    RecordHeader header;
+    header.size = qToLittleEndian<quint32>(recordSize);
+    header.kind = qToLittleEndian<quint16>(kind);
+    header.idSize = qToLittleEndian<quint16>(id.size());
+    std::memcpy(header.rawDataDigest, digest.constData(), DigestSize);
+
+    QByteArray record;
+    record.reserve(recordSize);
+    record.append(reinterpret_cast<const char*>(&header), sizeof(RecordHeader));
+    record.append(id);
+    record.append(payload);
+
+    const auto offset = size;
+    if (!file.seek(offset) || file.write(record) != record.size() || !file.flush()) {
+        errorString = file.errorString();
+        // don't leave an incomplete record behind
+        unmap();
+        file.resize(offset);
+        map();
+        return false;
+    }
+
+    if (!map()) {
+        return false;
+    }
+    indexRecord(offset, this->header(offset));
+    return true;
+}
+
+bool KHealthCertificateStorePrivate::appendCertificate(const QByteArray &digest, const KHealthCertificateParser::Certificate &certificate)
+{
+    const auto payload = KHealthCertificateSerializer::serialize(certificate);
+    if (payload.isEmpty()) {
+        errorString = QStringLiteral("Invalid certificate.");
+        return false;
+    }
+    return append(CertificateRecord, digest, ::certificateId(certificate), payload);
+}
+
+KHealthCertificateStore::KHealthCertificateStore(const QString &fileName)
+    : d(std::make_unique<KHealthCertificateStorePrivate>())
+{
+    d->file.setFileName(fileName);
+}
+
+KHealthCertificateStore::~KHealthCertificateStore()
+{
+    d->unmap();
+}
+
+bool KHealthCertificateStore::open()
+{
+    if (d->file.isOpen()) {
+        return true;
+    }
+    if (!d->file.open(QFile::ReadWrite)) {
+        d->errorString = d->file.errorString();
+        return false;
+    }
+
+    if (d->file.size() == 0) {
+        QByteArray fileHeader(Magic, sizeof(Magic));
+        const auto version = qToLittleEndian(StoreVersion);
+        fileHeader.append(reinterpret_cast<const char*>(&version), sizeof(version));
+        if (d->file.write(fileHeader) != fileHeader.size() || !d->file.flush()) {
+            d->errorString = d->file.errorString();
+            d->file.close();
+            return false;
+        }
+    }
+
+    if (!d->map()) {
+        d->file.close();
+        return false;
+    }
+    if (d->size < FileHeaderSize || std::memcmp(d->data, Magic, sizeof(Magic)) != 0) {
+        d->errorString = QStringLiteral("Not a certificate store file.");
+        d->unmap();
+        d->file.close();
+        return false;
+    }
+    if (qFromLittleEndian<quint32>(d->data + sizeof(Magic)) != StoreVersion) {
+        d->errorString = QStringLiteral("Unsupported certificate store version.");
+        d->unmap();
+        d->file.close();
+        return false;
+    }
+
+    const auto corrupted = [this]() {
+        // we can't find the next record anymore, and must not discard anything behind this either
+        d->errorString = QStringLiteral("Corrupted certificate store file.");
+        d->unmap();
+        d->file.close();
+        d->entries.clear();
+        d->entriesByDigest.clear();
+        d->digestsByCertificateId.clear();
+        d->removedCount = 0;
+        return false;
+    };
+
+    // only record headers are read here, certificates are decoded on access
+    qint64 offset = FileHeaderSize;
+    while (d->size - offset >= qint64(sizeof(RecordHeader))) {
+        const auto header = d->header(offset);
+        if (header.size < sizeof(RecordHeader) + header.idSize) {
+            return corrupted();
+        }
+        if (offset + header.size > d->size) {
+            // an interrupted write only affects the last record, a corrupted size field
+            // would make us discard everything behind it otherwise
+            if (header.size > MaximumRecordSize) {
+                return corrupted();
+            }
+            for (auto next = offset + qint64(sizeof(RecordHeader)); next < d->size; ++next) {
+                if (d->isRecordChain(next)) {
+                    return corrupted();
+                }
+            }
+            break; // incomplete last record
+        }
+        if (header.size > MaximumRecordSize) {
+            qCDebug(Log) << "skipping oversized record:" << header.size;
+        } else {
+            d->indexRecord(offset, header);
+        }
+        offset += header.size;
+    }
+
+    if (offset < d->size) {
+        qCWarning(Log) << "discarding incomplete record at the end of" << d->file.fileName();
+        d->unmap();
+        if (!d->file.resize(offset) || !d->map()) {
+            d->errorString = d->file.errorString();
+            d->file.close();
+            return false;
+        }
+    }
+    return true;
+}
+
+QString KHealthCertificateStore::errorString() const
+{
+    return d->errorString;
+}
+
+qsizetype KHealthCertificateStore::count() const
+{
+    return qsizetype(d->entries.size()) - d->removedCount;
+}
+
+KHealthCertificateParser::Certificate KHealthCertificateStore::certificate(qsizetype index) const
+{
+    if (index < 0 || index >= count()) {
+        return {};
+    }
+    d->compact();
+    return d->loadCurrent(d->entries[index].offset);
+}
+
+KHealthCertificateParser::Certificate KHealthCertificateStore::findByRawData(const QByteArray &rawData) const
+{
+    const auto it = d->entriesByDigest.constFind(KHealthCertificateStorePrivate::digest(rawData));
+    if (it == d->entriesByDigest.constEnd()) {
+        return {};
+    }
+    return d->loadCurrent(d->entries[it.value()].offset);
+}
+
+KHealthCertificateParser::Certificate KHealthCertificateStore::findByCertificateId(const QString &certificateId) const
+{
+    const auto it = d->digestsByCertificateId.constFind(certificateId);
+    if (it == d->digestsByCertificateId.constEnd()) {
+        return {};
+    }
+    return d->loadCurrent(d->entries[d->entriesByDigest.value(it.value().last())].offset);
+}
+
+bool KHealthCertificateStore::add(const KHealthCertificateParser::Certificate &certificate)
+{
+    if (!d->file.isOpen()) {
+        return false;
+    }
+    const auto raw = rawData(certificate);
+    if (raw.isEmpty()) {
+        d->errorString = QStringLiteral("Invalid certificate.");
+        return false;
+    }
+    const auto digest = KHealthCertificateStorePrivate::digest(raw);
+    if (d->entriesByDigest.contains(digest)) {
+        return true;
+    }
+    return d->appendCertificate(digest, certificate);
+}
+
+KHealthCertificateParser::Certificate KHealthCertificateStore::addRawData(const QByteArray &rawData)
+{
+    auto cert = findByRawData(rawData);
+    if (!std::holds_alternative<std::monostate>(cert)) {
+        return cert;
+    }
+    cert = KHealthCertificateParser::parseCertificate(rawData);
+    if (std::holds_alternative<std::monostate>(cert) || !add(cert)) {
+        return {};
+    }
+    return cert;
+}
+
+bool KHealthCertificateStore::remove(qsizetype index)
+{
+    if (index < 0 || index >= count() || !d->file.isOpen()) {
+        return false;
+    }
+    d->compact();
+    return d->append(RemovalRecord, d->entries[index].digest, {}, {});
+}
+
+qsizetype KHealthCertificateStore::refresh()
+{
+    if (!d->file.isOpen()) {
+        return 0;
+    }
+
+    qsizetype updated = 0;
+    const auto currentVersion = KHealthCertificateParser::trustStoreVersion();
+    d->compact();
+    // appending updated records doesn't change the entries, only their offsets
+    for (std::size_t i = 0; i < d->entries.size(); ++i) {
+        const auto digest = d->entries[i].digest;
+        QByteArray trustStoreVersion;
+        const auto cert = d->load(d->entries[i].offset, &trustStoreVersion);
+        if (std::holds_alternative<std::monostate>(cert) || trustStoreVersion == currentVersion) {
+            continue;
+        }
+        const auto newCert = KHealthCertificateParser::parseCertificate(rawData(cert));
+        if (!std::holds_alternative<std::monostate>(newCert) && d->appendCertificate(digest, newCert)) {
+            ++updated;
+        }
+    }
+    return updated;
+}
@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KHEALTHCERTIFICATESTORE_H
+#define KHEALTHCERTIFICATESTORE_H
+
+#include "khealthcertificate_export.h"
+#include "khealthcertificateparser.h"
+
+#include <memory>
+
+class KHealthCertificateStorePrivate;
+
+class QString;
+
+/** Persistent storage for parsed certificates, e.g. for a certificate wallet.
+ *
+ *  Certificates are stored in their KHealthCertificateSerializer encoding, including
+ *  their signature verification result. Loading them is therefore just a matter of
+ *  memory-mapping the store file rather than parsing and verifying every certificate again.
+ *  Certificates whose verification result was obtained with a different
+ *  KHealthCertificateParser::trustStoreVersion() are parsed and verified again on access.
+ *
+ *  The file is append-only: changes and removals add new records, and previous content
+ *  is never modified. An incompletely written last record, e.g. from a crash, is discarded
+ *  on open(), any other corruption makes open() fail without touching the file.
+ *  Certificates not matching the raw data digest they were stored with are ignored.
+ *
+ *  Stored verification results are only as trustworthy as the location of the store file,
+ *  anyone able to modify it can also change those results.
+ *
+ *  Certificates are identified by their raw data. A store must only be used by one
+ *  thread at a time, and a store file must only be opened by one store at a time.
+ */
+class KHEALTHCERTIFICATE_EXPORT KHealthCertificateStore
+{
+public:
+    /** Create a store for the file @p fileName, call open() before using it. */
+    explicit KHealthCertificateStore(const QString &fileName);
+    ~KHealthCertificateStore();
+
+    /** Open the store file, creating it if it doesn't exist yet.
+     *  @returns @c false on failure, see errorString() for details then.
+     */
+    bool open();
+    /** Human readable description of the last error. */
+    QString errorString() const;
+
+    /** Number of certificates in the store. */
+    qsizetype count() const;
+    /** Certificate at @p index, in the order they were added. */
+    KHealthCertificateParser::Certificate certificate(qsizetype index) const;
+
+    /** Returns the certificate with the raw data @p rawData, or std::monostate if there is none. */
+    KHealthCertificateParser::Certificate findByRawData(const QByteArray &rawData) const;
+    /** Returns the most recently added certificate with the identifier @p certificateId,
+     *  or std::monostate if there is none.
+     */
+    KHealthCertificateParser::Certificate findByCertificateId(const QString &certificateId) const;
+
+    /** Add a parsed certificate.
+     *  Nothing is done if a certificate with the same raw data is already stored.
+     *  @returns @c false if @p certificate is invalid or on write errors.
+     */
+    bool add(const KHealthCertificateParser::Certificate &certificate);
+    /** Parse, verify and add a certificate in its raw form.
+     *  @returns the parsed certificate, or std::monostate if @p rawData can't be parsed or stored.
+     */
+    KHealthCertificateParser::Certificate addRawData(const QByteArray &rawData);
+    /** Remove the certificate at @p index.
+     *  @returns @c false on write errors.
+     */
+    bool remove(qsizetype index);
+
+    /** Verify all certificates with outdated verification results again and store the new results.
+     *  Without this outdated certificates are verified again on every access.
+     *  @returns the number of updated certificates.
+     */
+    qsizetype refresh();
+
+private:
+    Q_DISABLE_COPY_MOVE(KHealthCertificateStore)
+    std::unique_ptr<KHealthCertificateStorePrivate> d;
+};
+
+#endif // KHEALTHCERTIFICATESTORE_H
@@ -46,5 +46,10 @@ public: \
     Type Getter() const; \
     void Setter(KHealthCertificateInternal::parameter_type<Type>::type value); \
 
+// for types that benefit from move assignment
+#define KHEALTHCERTIFICATE_MOVABLE_PROPERTY(Type, Getter, Setter) \
+    KHEALTHCERTIFICATE_PROPERTY(Type, Getter, Setter) \
+    void Setter(Type &&value); \
+
 #endif // KHEALTHCERTIFICATETYPES_H
 
@@ -8,9 +8,129 @@
 
 #include "khealthcertificatetypes.h"
 
+#include <QByteArray>
 #include <QSharedData>
 #include <QVariant>
 
+#include <atomic>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace KHealthCertificateInternal {
+/** A property value that can be derived from other data on access.
+ *  This is for values that are rarely needed, so rather than computing them
+ *  during parsing only their (already existing) source data is kept.
+ *  The value is computed on first access and then memoized, the source data is
+ *  released at that point. Certificates are shared between threads, so the first
+ *  access is synchronized, concurrent readers wait for the producing thread.
+ */
+template <typename T, typename Source = QByteArray>
+class Lazy
+{
+public:
+    using Producer = T(*)(const Source&);
+
+    Lazy() = default;
+    // copies happen on detach, while other threads might still access @p other
+    Lazy(const Lazy &other)
+        : m_data(std::in_place_index<ValueIndex>, other.value())
+    {
+    }
+    Lazy& operator=(const Lazy &other)
+    {
+        if (this != &other) {
+            *this = other.value();
+        }
+        return *this;
+    }
+    Lazy& operator=(const T &value)
+    {
+        m_data.template emplace<ValueIndex>(value);
+        m_producer = nullptr;
+        m_state.store(Ready, std::memory_order_relaxed);
+        return *this;
+    }
+    Lazy& operator=(T &&value)
+    {
+        m_data.template emplace<ValueIndex>(std::move(value));
+        m_producer = nullptr;
+        m_state.store(Ready, std::memory_order_relaxed);
+        return *this;
+    }
+
+    /** Compute the value with @p producer from @p source on first access. */
+    void setProducer(Producer producer, const Source &source)
+    {
+        m_data.template emplace<SourceIndex>(source);
+        m_producer = producer;
+        m_state.store(Pending, std::memory_order_relaxed);
+    }
+
+    T value() const
+    {
+        auto state = m_state.load(std::memory_order_acquire);
+        if (state == Pending && m_state.compare_exchange_strong(state, Producing, std::memory_order_acquire)) {
+            m_data.template emplace<ValueIndex>(m_producer(std::get<SourceIndex>(m_data)));
+            m_state.store(Ready, std::memory_order_release);
+            m_state.notify_all();
+            return std::get<ValueIndex>(m_data);
+        }
+        while (state != Ready) {
+            m_state.wait(state, std::memory_order_acquire);
+            state = m_state.load(std::memory_order_acquire);
+        }
+        return std::get<ValueIndex>(m_data);
+    }
+    inline operator T() const { return value(); }
+    inline bool operator==(const Lazy &other) const { return value() == other.value(); }
+
+private:
+    enum State : quint8 {
+        Ready,
+        Pending,
+        Producing,
+    };
+    // index based, T and Source can be the same type
+    static constexpr std::size_t ValueIndex = 0;
+    static constexpr std::size_t SourceIndex = 1;
+
+    mutable std::variant<T, Source> m_data;
+    Producer m_producer = nullptr;
+    mutable std::atomic<State> m_state = Ready;
+};
+
+/** Fills in the private data of a new certificate.
+ *  This is for parsers mapping many fields at once: the shared data is allocated
+ *  exactly once up front, values can be moved into it directly, and there is no
+ *  detach check per field as with the public setters.
+ */
+template <typename Private>
+class CertificateBuilder
+{
+public:
+    using Certificate = typename Private::Certificate;
+
+    CertificateBuilder() : m_data(Private::get(m_certificate)) {}
+    CertificateBuilder(const CertificateBuilder&) = delete;
+    CertificateBuilder& operator=(const CertificateBuilder&) = delete;
+
+    inline Private* operator->() const { return m_data; }
+    inline Private& operator*() const { return *m_data; }
+
+    /** Hand out the finished certificate, the builder must not be used afterwards. */
+    Certificate build()
+    {
+        m_data = nullptr;
+        return std::move(m_certificate);
+    }
+
+private:
+    Certificate m_certificate;
+    Private *m_data;
+};
+}
+
 #define KHEALTHCERTIFICATE_MAKE_GADGET(Class) \
 K ## Class ## Certificate::K ## Class ## Certificate() : d(new K ## Class ## Certificate ## Private) {} \
 K ## Class ## Certificate::K ## Class ## Certificate(const K ## Class ## Certificate&) = default; \
@@ -23,6 +143,19 @@ bool K ## Class ## Certificate::operator==(const K ## Class ## Certificate &othe
 bool K ## Class ## Certificate::operator!=(const K ## Class ## Certificate &other) const { return d->rawData == other.d->rawData; } \
 KHealthCertificate::CertificateType K ## Class ## Certificate::type() const { return KHealthCertificate::Class; }
 
+// access to the private data from parsers, e.g. to set up lazily computed properties
+#define KHEALTHCERTIFICATE_MAKE_PRIVATE_GET(Class) \
+using Certificate = K ## Class ## Certificate; \
+static inline K ## Class ## CertificatePrivate* get(K ## Class ## Certificate &cert) \
+{ \
+    cert.d.detach(); \
+    return cert.d.data(); \
+} \
+static inline const K ## Class ## CertificatePrivate* get(const K ## Class ## Certificate &cert) \
+{ \
+    return cert.d.data(); \
+}
+
 #define KHEALTHCERTIFICATE_MAKE_PROPERTY(Class, Type, Getter, Setter) \
 Type K ## Class ## Certificate::Getter() const { return d->Getter; } \
 void K ## Class ## Certificate::Setter(KHealthCertificateInternal::parameter_type<Type>::type value) \
@@ -31,6 +164,14 @@ void K ## Class ## Certificate::Setter(KHealthCertificateInternal::parameter_typ
     d->Getter = value; \
 }
 
+#define KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Class, Type, Getter, Setter) \
+KHEALTHCERTIFICATE_MAKE_PROPERTY(Class, Type, Getter, Setter) \
+void K ## Class ## Certificate::Setter(Type &&value) \
+{ \
+    d.detach(); \
+    d->Getter = std::move(value); \
+}
+
 #endif // KHEALTHCERTIFICATETYPES_P_H
 
 
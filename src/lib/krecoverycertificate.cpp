@@ -4,37 +4,21 @@
  */
 
 #include "krecoverycertificate.h"
+#include "krecoverycertificate_p.h"
 #include "khealthcertificatetypes_p.h"
 
-class KRecoveryCertificatePrivate : public QSharedData
-{
-public:
-    QString name;
-    QDate dateOfBirth;
-    QDate dateOfPositiveTest;
-    QDate validFrom;
-    QDate validUntil;
-    QString disease;
-    QString certificateIssuer;
-    QString certificateId;
-    QDateTime certificateIssueDate;
-    QDateTime certificateExpiryDate;
-    QByteArray rawData;
-    KHealthCertificate::SignatureValidation signatureState = KHealthCertificate::UnknownSignature;
-};
-
 KHEALTHCERTIFICATE_MAKE_GADGET(Recovery)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, QString, name, setName)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Recovery, QString, name, setName)
 KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, QDate, dateOfBirth, setDateOfBirth)
 KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, QDate, dateOfPositiveTest, setDateOfPositiveTest)
 KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, QDate, validFrom, setValidFrom)
 KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, QDate, validUntil, setValidUntil)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, QString, disease, setDisease)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, QString, certificateId, setCertificateId)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, QString, certificateIssuer, setCertificateIssuer)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, QDateTime, certificateIssueDate, setCertificateIssueDate)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, QDateTime, certificateExpiryDate, setCertificateExpiryDate)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, QByteArray, rawData, setRawData)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Recovery, QString, disease, setDisease)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Recovery, QString, certificateId, setCertificateId)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Recovery, QString, certificateIssuer, setCertificateIssuer)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Recovery, QDateTime, certificateIssueDate, setCertificateIssueDate)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Recovery, QDateTime, certificateExpiryDate, setCertificateExpiryDate)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Recovery, QByteArray, rawData, setRawData)
 KHEALTHCERTIFICATE_MAKE_PROPERTY(Recovery, KHealthCertificate::SignatureValidation, signatureState, setSignatureState)
 
 KHealthCertificate::CertificateValidation KRecoveryCertificate::validationState() const
@@ -17,27 +17,27 @@ class KRecoveryCertificatePrivate;
 class KHEALTHCERTIFICATE_EXPORT KRecoveryCertificate
 {
     KHEALTHCERTIFICATE_GADGET(Recovery)
-    KHEALTHCERTIFICATE_PROPERTY(QString, name, setName)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, name, setName)
     KHEALTHCERTIFICATE_PROPERTY(QDate, dateOfBirth, setDateOfBirth)
     KHEALTHCERTIFICATE_PROPERTY(QDate, dateOfPositiveTest, setDateOfPositiveTest)
     KHEALTHCERTIFICATE_PROPERTY(QDate, validFrom, setValidFrom)
     KHEALTHCERTIFICATE_PROPERTY(QDate, validUntil, setValidUntil)
-    KHEALTHCERTIFICATE_PROPERTY(QString, disease, setDisease)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, disease, setDisease)
     /** The entity that issued this certificate. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, certificateIssuer, setCertificateIssuer)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, certificateIssuer, setCertificateIssuer)
     /** The unique identifier of this certificate. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, certificateId, setCertificateId)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, certificateId, setCertificateId)
     /** Date/time this certificate has been issued at. */
-    KHEALTHCERTIFICATE_PROPERTY(QDateTime, certificateIssueDate, setCertificateIssueDate)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QDateTime, certificateIssueDate, setCertificateIssueDate)
     /** Date/time this certificate expires. */
-    KHEALTHCERTIFICATE_PROPERTY(QDateTime, certificateExpiryDate, setCertificateExpiryDate)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QDateTime, certificateExpiryDate, setCertificateExpiryDate)
     /** Validation status of the cryptographic signature of this certificate. */
     KHEALTHCERTIFICATE_PROPERTY(KHealthCertificate::SignatureValidation, signatureState, setSignatureState)
 
     Q_PROPERTY(KHealthCertificate::CertificateValidation validationState READ validationState)
 
     /** Fully encoded data as represented in the barcode. */
-    KHEALTHCERTIFICATE_PROPERTY(QByteArray, rawData, setRawData)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QByteArray, rawData, setRawData)
 public:
     KHealthCertificate::CertificateValidation validationState() const;
 };
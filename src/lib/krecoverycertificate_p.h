@@ -0,0 +1,31 @@
+/*
+ * SPDX-FileCopyrightText: 2021 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KRECOVERYCERTIFICATE_P_H
+#define KRECOVERYCERTIFICATE_P_H
+
+#include "krecoverycertificate.h"
+#include "khealthcertificatetypes_p.h"
+
+class KRecoveryCertificatePrivate : public QSharedData
+{
+public:
+    KHEALTHCERTIFICATE_MAKE_PRIVATE_GET(Recovery)
+
+    QString name;
+    QDate dateOfBirth;
+    QDate dateOfPositiveTest;
+    QDate validFrom;
+    QDate validUntil;
+    QString disease;
+    QString certificateIssuer;
+    QString certificateId;
+    QDateTime certificateIssueDate;
+    QDateTime certificateExpiryDate;
+    KHealthCertificateInternal::Lazy<QByteArray> rawData;
+    KHealthCertificate::SignatureValidation signatureState = KHealthCertificate::UnknownSignature;
+};
+
+#endif // KRECOVERYCERTIFICATE_P_H
@@ -18,28 +18,28 @@ class KTestCertificatePrivate;
 class KHEALTHCERTIFICATE_EXPORT KTestCertificate
 {
     KHEALTHCERTIFICATE_GADGET(Test)
-    KHEALTHCERTIFICATE_PROPERTY(QString, name, setName)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, name, setName)
     KHEALTHCERTIFICATE_PROPERTY(QDate, dateOfBirth, setDateOfBirth)
     KHEALTHCERTIFICATE_PROPERTY(QDate, date, setDate)
-    KHEALTHCERTIFICATE_PROPERTY(QString, disease, setDisease)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, disease, setDisease)
     /** The type of test, such as PCR or antigen. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, testType, setTestType)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, testType, setTestType)
     /** The test manufacturer/product used. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, testName, setTestName)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, testName, setTestName)
     /** URL pointing to further information about the test product. */
-    KHEALTHCERTIFICATE_PROPERTY(QUrl, testUrl, setTestUrl)
-    KHEALTHCERTIFICATE_PROPERTY(QString, resultString, setResultString)
-    KHEALTHCERTIFICATE_PROPERTY(QString, testCenter, setTestCenter)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QUrl, testUrl, setTestUrl)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, resultString, setResultString)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, testCenter, setTestCenter)
     /** Country the certificate was issued in, as ISO 3166-1 alpha 2 code. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, country, setCountry)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, country, setCountry)
     /** The entity that issued this certificate. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, certificateIssuer, setCertificateIssuer)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, certificateIssuer, setCertificateIssuer)
     /** The unique identifier of this certificate. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, certificateId, setCertificateId)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, certificateId, setCertificateId)
     /** Date/time this certificate has been issued at. */
-    KHEALTHCERTIFICATE_PROPERTY(QDateTime, certificateIssueDate, setCertificateIssueDate)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QDateTime, certificateIssueDate, setCertificateIssueDate)
     /** Date/time this certificate expires. */
-    KHEALTHCERTIFICATE_PROPERTY(QDateTime, certificateExpiryDate, setCertificateExpiryDate)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QDateTime, certificateExpiryDate, setCertificateExpiryDate)
     /** Validation status of the cryptographic signature of this certificate. */
     KHEALTHCERTIFICATE_PROPERTY(KHealthCertificate::SignatureValidation, signatureState, setSignatureState)
 
@@ -57,7 +57,7 @@ class KHEALTHCERTIFICATE_EXPORT KTestCertificate
     Q_PROPERTY(bool isCurrent READ isCurrent)
 
     /** Fully encoded data as represented in the barcode. */
-    KHEALTHCERTIFICATE_PROPERTY(QByteArray, rawData, setRawData)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QByteArray, rawData, setRawData)
 public:
     KHealthCertificate::CertificateValidation validationState() const;
 
@@ -0,0 +1,36 @@
+/*
+ * SPDX-FileCopyrightText: 2021 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KTESTCERTIFICATE_P_H
+#define KTESTCERTIFICATE_P_H
+
+#include "ktestcertificate.h"
+#include "khealthcertificatetypes_p.h"
+
+class KTestCertificatePrivate : public QSharedData
+{
+public:
+    KHEALTHCERTIFICATE_MAKE_PRIVATE_GET(Test)
+
+    QString name;
+    QDate dateOfBirth;
+    QDate date;
+    QString disease;
+    QString testType;
+    QString testName;
+    KHealthCertificateInternal::Lazy<QUrl, QString> testUrl;
+    KTestCertificate::Result result = KTestCertificate::Unknown;
+    QString resultString;
+    QString testCenter;
+    QString country;
+    QString certificateIssuer;
+    QString certificateId;
+    QDateTime certificateIssueDate;
+    QDateTime certificateExpiryDate;
+    KHealthCertificateInternal::Lazy<QByteArray> rawData;
+    KHealthCertificate::SignatureValidation signatureState = KHealthCertificate::UnknownSignature;
+};
+
+#endif // KTESTCERTIFICATE_P_H
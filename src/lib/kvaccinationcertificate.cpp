@@ -4,47 +4,26 @@
  */
 
 #include "kvaccinationcertificate.h"
+#include "kvaccinationcertificate_p.h"
 #include "khealthcertificatetypes_p.h"
 
-class KVaccinationCertificatePrivate : public QSharedData
-{
-public:
-    QString name;
-    QDate dateOfBirth;
-    QDate date;
-    QString disease;
-    QString vaccineType;
-    QString vaccine;
-    QUrl vaccineUrl;
-    QString manufacturer;
-    int dose = 0;
-    int totalDoses = 0;
-    QString country;
-    QString certificateIssuer;
-    QString certificateId;
-    QDateTime certificateIssueDate;
-    QDateTime certificateExpiryDate;
-    QByteArray rawData;
-    KHealthCertificate::SignatureValidation signatureState = KHealthCertificate::UnknownSignature;
-};
-
 KHEALTHCERTIFICATE_MAKE_GADGET(Vaccination)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QString, name, setName)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QString, name, setName)
 KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QDate, dateOfBirth, setDateOfBirth)
 KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QDate, date, setDate)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QString, disease, setDisease)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QString, vaccineType, setVaccineType)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QString, vaccine, setVaccine)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QUrl, vaccineUrl, setVaccineUrl)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QString, manufacturer, setManufacturer)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QString, disease, setDisease)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QString, vaccineType, setVaccineType)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QString, vaccine, setVaccine)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QUrl, vaccineUrl, setVaccineUrl)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QString, manufacturer, setManufacturer)
 KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, int, dose, setDose)
 KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, int, totalDoses, setTotalDoses)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QString, country, setCountry)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QString, certificateIssuer, setCertificateIssuer)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QString, certificateId, setCertificateId)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QDateTime, certificateIssueDate, setCertificateIssueDate)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QDateTime, certificateExpiryDate, setCertificateExpiryDate)
-KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, QByteArray, rawData, setRawData)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QString, country, setCountry)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QString, certificateIssuer, setCertificateIssuer)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QString, certificateId, setCertificateId)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QDateTime, certificateIssueDate, setCertificateIssueDate)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QDateTime, certificateExpiryDate, setCertificateExpiryDate)
+KHEALTHCERTIFICATE_MAKE_MOVABLE_PROPERTY(Vaccination, QByteArray, rawData, setRawData)
 KHEALTHCERTIFICATE_MAKE_PROPERTY(Vaccination, KHealthCertificate::SignatureValidation, signatureState, setSignatureState)
 
 KHealthCertificate::CertificateValidation KVaccinationCertificate::validationState() const
@@ -18,37 +18,37 @@ class KVaccinationCertificatePrivate;
 class KHEALTHCERTIFICATE_EXPORT KVaccinationCertificate
 {
     KHEALTHCERTIFICATE_GADGET(Vaccination)
-    KHEALTHCERTIFICATE_PROPERTY(QString, name, setName)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, name, setName)
     KHEALTHCERTIFICATE_PROPERTY(QDate, dateOfBirth, setDateOfBirth)
     KHEALTHCERTIFICATE_PROPERTY(QDate, date, setDate)
-    KHEALTHCERTIFICATE_PROPERTY(QString, disease, setDisease)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, disease, setDisease)
     /** The vaccine type, such as mRNA or vector. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, vaccineType, setVaccineType)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, vaccineType, setVaccineType)
     /** The name of the vaccine as given by the manufacturer. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, vaccine, setVaccine)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, vaccine, setVaccine)
     /** URL to further details on the vaccine. */
-    KHEALTHCERTIFICATE_PROPERTY(QUrl, vaccineUrl, setVaccineUrl)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QUrl, vaccineUrl, setVaccineUrl)
     /** Name of the manufacturer of the vaccine. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, manufacturer, setManufacturer)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, manufacturer, setManufacturer)
     KHEALTHCERTIFICATE_PROPERTY(int, dose, setDose)
     KHEALTHCERTIFICATE_PROPERTY(int, totalDoses, setTotalDoses)
     /** Country the certificate was issued in, as ISO 3166-1 alpha 2 code. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, country, setCountry)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, country, setCountry)
     /** The entity that issued this certificate. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, certificateIssuer, setCertificateIssuer)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, certificateIssuer, setCertificateIssuer)
     /** The unique identifier of this certificate. */
-    KHEALTHCERTIFICATE_PROPERTY(QString, certificateId, setCertificateId)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QString, certificateId, setCertificateId)
     /** Date/time this certificate has been issued at. */
-    KHEALTHCERTIFICATE_PROPERTY(QDateTime, certificateIssueDate, setCertificateIssueDate)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QDateTime, certificateIssueDate, setCertificateIssueDate)
     /** Date/time this certificate expires. */
-    KHEALTHCERTIFICATE_PROPERTY(QDateTime, certificateExpiryDate, setCertificateExpiryDate)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QDateTime, certificateExpiryDate, setCertificateExpiryDate)
     /** Validation status of the cryptographic signature of this certificate. */
     KHEALTHCERTIFICATE_PROPERTY(KHealthCertificate::SignatureValidation, signatureState, setSignatureState)
 
     Q_PROPERTY(KHealthCertificate::CertificateValidation validationState READ validationState)
 
     /** Fully encoded data as represented in the barcode. */
-    KHEALTHCERTIFICATE_PROPERTY(QByteArray, rawData, setRawData)
+    KHEALTHCERTIFICATE_MOVABLE_PROPERTY(QByteArray, rawData, setRawData)
 public:
     KHealthCertificate::CertificateValidation validationState() const;
 
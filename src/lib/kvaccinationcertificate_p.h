@@ -0,0 +1,36 @@
+/*
+ * SPDX-FileCopyrightText: 2021 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KVACCINATIONCERTIFICATE_P_H
+#define KVACCINATIONCERTIFICATE_P_H
+
+#include "kvaccinationcertificate.h"
+#include "khealthcertificatetypes_p.h"
+
+class KVaccinationCertificatePrivate : public QSharedData
+{
+public:
+    KHEALTHCERTIFICATE_MAKE_PRIVATE_GET(Vaccination)
+
+    QString name;
+    QDate dateOfBirth;
+    QDate date;
+    QString disease;
+    QString vaccineType;
+    QString vaccine;
+    KHealthCertificateInternal::Lazy<QUrl, QString> vaccineUrl;
+    QString manufacturer;
+    int dose = 0;
+    int totalDoses = 0;
+    QString country;
+    QString certificateIssuer;
+    QString certificateId;
+    QDateTime certificateIssueDate;
+    QDateTime certificateExpiryDate;
+    KHealthCertificateInternal::Lazy<QByteArray> rawData;
+    KHealthCertificate::SignatureValidation signatureState = KHealthCertificate::UnknownSignature;
+};
+
+#endif // KVACCINATIONCERTIFICATE_P_H
@@ -4,13 +4,18 @@
  */
 
 #include "irmapublickey_p.h"
+#include "logging.h"
 
 #include "openssl/bignum_p.h"
 
 #include <QDebug>
+#include <QDirIterator>
 #include <QFile>
+#include <QFileInfo>
 #include <QXmlStreamReader>
 
+#include <unordered_map>
+
 // see https://pkg.go.dev/github.com/privacybydesign/gabi@v0.0.0-20210816093228-75a6590e506c/gabikeys#PublicKey
 
 IrmaPublicKey::IrmaPublicKey() = default;
@@ -72,13 +77,13 @@ int IrmaPublicKey::LmCommit() const
 }
 
 
-IrmaPublicKey IrmaPublicKeyLoader::load(const QString &keyId)
+static IrmaPublicKey loadKey(const QString &fileName)
 {
     IrmaPublicKey pk;
 
-    QFile pkFile(QLatin1String(":/org.kde.khealthcertificate/nl-coronacheck/keys/") + keyId + QLatin1String(".xml"));
+    QFile pkFile(fileName);
     if (!pkFile.open(QFile::ReadOnly)) {
-        qWarning() << "Failed to find IRMA public key:" << keyId;
+        qCWarning(Log) << "Failed to read IRMA public key:" << fileName << pkFile.errorString();
         return pk;
     }
 
@@ -105,3 +110,30 @@ IrmaPublicKey IrmaPublicKeyLoader::load(const QString &keyId)
 
     return pk;
 }
+
+// keys are stored as <key id>.xml
+static std::unordered_map<QString, IrmaPublicKey> loadKeys()
+{
+    std::unordered_map<QString, IrmaPublicKey> keys;
+    for (QDirIterator it(QStringLiteral(":/org.kde.khealthcertificate/nl-coronacheck/keys"), QDir::Files); it.hasNext();) {
+        const QFileInfo fi(it.next());
+        if (fi.suffix() == QLatin1String("xml")) {
+            keys.emplace(fi.completeBaseName(), loadKey(fi.filePath()));
+        }
+    }
+    return keys;
+}
+
+const IrmaPublicKey& IrmaPublicKeyLoader::load(const QString &keyId)
+{
+    // loaded once on first use and immutable afterwards, so safe for concurrent use
+    static const auto s_keys = loadKeys();
+    static const IrmaPublicKey s_invalidKey;
+
+    const auto it = s_keys.find(keyId);
+    if (it == s_keys.end()) {
+        qCDebug(Log) << "Failed to find IRMA public key:" << keyId;
+        return s_invalidKey;
+    }
+    return it->second;
+}
@@ -39,7 +39,10 @@ public:
 /** Loader for IRMA public keys. */
 namespace IrmaPublicKeyLoader
 {
-    IrmaPublicKey load(const QString &keyId);
+    /** Returns the public key with id @p keyId, or an invalid key if that isn't known.
+     *  All keys are parsed once on first use.
+     */
+    const IrmaPublicKey& load(const QString &keyId);
 }
 
 #endif // IRMAPUBLICKEY_H
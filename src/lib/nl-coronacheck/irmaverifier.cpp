@@ -5,8 +5,12 @@
 
 #include "irmaverifier_p.h"
 #include "irmapublickey_p.h"
+#include "khealthcertificateparsersession_p.h"
+#include "parsecontext_p.h"
+#include "tracepoints_p.h"
 
 #include "openssl/bignum_p.h"
+#include "openssl/verificationcache_p.h"
 
 #include <QCryptographicHash>
 #include <QDebug>
@@ -59,14 +63,21 @@ static openssl::bn_ptr bignum_sha256(const openssl::bn_ptr &in)
 // see https://github.com/privacybydesign/gabi/blob/master/proofs.go#L194
 static openssl::bn_ptr reconstructZ(const IrmaProof &proof, const IrmaPublicKey &pubKey)
 {
-    openssl::bn_ctx_ptr bnCtx(BN_CTX_new());
+    // use the context of the parser session if available, a new one otherwise
+    auto session = ParseContext::session();
+    openssl::bn_ctx_ptr ownBnCtx;
+    auto bnCtx = session ? session->bnContext() : nullptr;
+    if (!bnCtx) {
+        ownBnCtx.reset(BN_CTX_new());
+        bnCtx = ownBnCtx.get();
+    }
 
     openssl::bn_ptr numerator(BN_new()), tmp(BN_new());
     BN_one(numerator.get());
     BN_lshift(tmp.get(), numerator.get(), pubKey.Le() - 1);
     std::swap(tmp, numerator);
 
-    BN_mod_exp(tmp.get(), proof.A.get(), numerator.get(), pubKey.N.get(), bnCtx.get());
+    BN_mod_exp(tmp.get(), proof.A.get(), numerator.get(), pubKey.N.get(), bnCtx);
     std::swap(tmp, numerator);
 
     for (std::size_t i = 0; i < proof.ADisclosed.size(); ++i) {
@@ -75,41 +86,41 @@ static openssl::bn_ptr reconstructZ(const IrmaProof &proof, const IrmaPublicKey
             exp = bignum_sha256(proof.ADisclosed[i]);
         }
 
-        BN_mod_exp(tmp.get(), pubKey.R[i+1].get(), exp ? exp.get() : proof.ADisclosed[i].get(), pubKey.N.get(), bnCtx.get());
+        BN_mod_exp(tmp.get(), pubKey.R[i+1].get(), exp ? exp.get() : proof.ADisclosed[i].get(), pubKey.N.get(), bnCtx);
         openssl::bn_ptr tmp2(BN_new());
-        BN_mul(tmp2.get(), numerator.get(), tmp.get(), bnCtx.get());
+        BN_mul(tmp2.get(), numerator.get(), tmp.get(), bnCtx);
         std::swap(tmp2, numerator);
     }
 
     openssl::bn_ptr known(BN_new());
-    BN_mod_inverse(known.get(), numerator.get(), pubKey.N.get(), bnCtx.get());
-    BN_mul(tmp.get(), pubKey.Z.get(), known.get(), bnCtx.get());
+    BN_mod_inverse(known.get(), numerator.get(), pubKey.N.get(), bnCtx);
+    BN_mul(tmp.get(), pubKey.Z.get(), known.get(), bnCtx);
     std::swap(tmp, known);
 
     openssl::bn_ptr knownC(BN_new());
-    BN_mod_inverse(tmp.get(), known.get(), pubKey.N.get(), bnCtx.get());
-    BN_mod_exp(knownC.get(), tmp.get(), proof.C.get(), pubKey.N.get(), bnCtx.get());
+    BN_mod_inverse(tmp.get(), known.get(), pubKey.N.get(), bnCtx);
+    BN_mod_exp(knownC.get(), tmp.get(), proof.C.get(), pubKey.N.get(), bnCtx);
 
     openssl::bn_ptr Ae(BN_new());
-    BN_mod_exp(Ae.get(), proof.A.get(), proof.EResponse.get(), pubKey.N.get(), bnCtx.get());
+    BN_mod_exp(Ae.get(), proof.A.get(), proof.EResponse.get(), pubKey.N.get(), bnCtx);
     openssl::bn_ptr Sv(BN_new());
-    BN_mod_exp(Sv.get(), pubKey.S.get(), proof.VResponse.get(), pubKey.N.get(), bnCtx.get());
+    BN_mod_exp(Sv.get(), pubKey.S.get(), proof.VResponse.get(), pubKey.N.get(), bnCtx);
 
     openssl::bn_ptr Rs(BN_new());
     BN_one(Rs.get());
     for (std::size_t i = 0; i < proof.AResponses.size(); ++i) {
         openssl::bn_ptr tmp2(BN_new());
-        BN_mod_exp(tmp2.get(), pubKey.R[i].get(), proof.AResponses[i].get(), pubKey.N.get(), bnCtx.get());
-        BN_mul(tmp.get(), Rs.get(), tmp2.get(), bnCtx.get());
+        BN_mod_exp(tmp2.get(), pubKey.R[i].get(), proof.AResponses[i].get(), pubKey.N.get(), bnCtx);
+        BN_mul(tmp.get(), Rs.get(), tmp2.get(), bnCtx);
         std::swap(tmp, Rs);
     }
 
     openssl::bn_ptr Z(BN_new());
-    BN_mul(Z.get(), knownC.get(), Ae.get(), bnCtx.get());
+    BN_mul(Z.get(), knownC.get(), Ae.get(), bnCtx);
 
-    BN_mul(tmp.get(), Z.get(), Rs.get(), bnCtx.get());
+    BN_mul(tmp.get(), Z.get(), Rs.get(), bnCtx);
     std::swap(tmp, Z);
-    BN_mod_mul(tmp.get(), Z.get(), Sv.get(), pubKey.N.get(), bnCtx.get());
+    BN_mod_mul(tmp.get(), Z.get(), Sv.get(), pubKey.N.get(), bnCtx);
     std::swap(tmp, Z);
     return Z;
 }
@@ -137,13 +148,50 @@ static QByteArray asn1EncodeSequence(const std::vector<const BIGNUM*> &numbers)
     return result;
 }
 
+static void addToCacheKey(VerificationCache::Key &key, const openssl::bn_ptr &bn)
+{
+    key.add(bn ? Bignum::toByteArray(bn) : QByteArray());
+}
+
+// everything verify() depends on
+static QByteArray cacheKey(const IrmaProof &proof, const IrmaPublicKey &pubKey)
+{
+    VerificationCache::Key key("IRMA");
+    addToCacheKey(key, pubKey.N);
+    addToCacheKey(key, pubKey.Z);
+    addToCacheKey(key, pubKey.S);
+    for (const auto &r : pubKey.R) {
+        addToCacheKey(key, r);
+    }
+    key.add(QByteArray::number((qlonglong)proof.disclosureTime));
+    addToCacheKey(key, proof.C);
+    addToCacheKey(key, proof.A);
+    addToCacheKey(key, proof.EResponse);
+    addToCacheKey(key, proof.VResponse);
+    for (const auto &ares : proof.AResponses) {
+        addToCacheKey(key, ares);
+    }
+    for (const auto &adisc : proof.ADisclosed) {
+        addToCacheKey(key, adisc);
+    }
+    return key.result();
+}
+
 // see https://github.com/privacybydesign/gabi/blob/master/prooflist.go#L77
 bool IrmaVerifier::verify(const IrmaProof &proof, const IrmaPublicKey &pubKey)
 {
-    if (!checkResponseSize(proof, pubKey)) {
+    KHC_TRACEPOINT(irma_verify_begin, proof.ADisclosed.size());
+    if (!checkResponseSize(proof, pubKey) || !ParseContext::addCryptoOperation()) {
+        KHC_TRACEPOINT(irma_verify_end, false);
         return false;
     }
 
+    const auto key = cacheKey(proof, pubKey);
+    if (VerificationCache::contains(key)) {
+        KHC_TRACEPOINT(irma_verify_end, true);
+        return true;
+    }
+
     openssl::bn_ptr context(BN_new());
     BN_one(context.get());
 
@@ -158,5 +206,10 @@ bool IrmaVerifier::verify(const IrmaProof &proof, const IrmaPublicKey &pubKey)
     const auto challenge = QCryptographicHash::hash(encoded, QCryptographicHash::Sha256);
 
     const auto proofC = Bignum::toByteArray(proof.C);
-    return proofC == challenge;
+    const auto result = proofC == challenge;
+    if (result) {
+        VerificationCache::insert(key);
+    }
+    KHC_TRACEPOINT(irma_verify_end, result);
+    return result;
 }
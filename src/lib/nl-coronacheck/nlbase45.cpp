@@ -9,7 +9,6 @@
 #include "openssl/opensslpp_p.h"
 
 #include <QByteArray>
-#include <QDebug>
 
 #include <algorithm>
 
@@ -19,7 +18,6 @@ static int8_t nlBase45MapFromChar(char c)
 {
     const auto it = std::find(std::begin(nlBase45Table), std::end(nlBase45Table), c);
     if (it == std::end(nlBase45Table)) {
-        qWarning() << "invalid base45 character:" << c;
         return -1;
     }
     return std::distance(std::begin(nlBase45Table), it);
@@ -33,7 +31,7 @@ QByteArray NLBase45::decode(const char *begin, const char *end)
         BN_mul_word(bn.get(), 45);
         auto v = nlBase45MapFromChar(*it);
         if (v < 0) {
-            break;
+            return {};
         }
         BN_add_word(bn.get(), v);
     }
@@ -8,10 +8,13 @@
 #include "logging.h"
 #include "irmapublickey_p.h"
 #include "irmaverifier_p.h"
+#include "parsecontext_p.h"
+#include "tracepoints_p.h"
 
 #include "openssl/asn1_p.h"
 #include "openssl/bignum_p.h"
 
+#include <KHealthCertificatePipeline>
 #include <KTestCertificate>
 #include <KVaccinationCertificate>
 
@@ -24,39 +27,52 @@ void NLCoronaCheckParser::init()
     Q_INIT_RESOURCE(nl_public_keys);
 }
 
-static QByteArray nlDecodeAsn1ByteArray(const ASN1::Object &obj)
+// disclosed attributes are encoded as ASN.1 integers, shifted by one bit
+static QByteArray nlDecodeAttribute(const openssl::bn_ptr &value)
 {
-    auto it = obj.begin();
-    auto ai = openssl::asn1_integer_ptr(d2i_ASN1_INTEGER(nullptr, &it, obj.size()));
-    if (!ai) {
-        qWarning() << "invalid ASN.1 structure";
+    if (!value) {
         return {};
     }
-    auto bn = openssl::bn_ptr(BN_new());
-    BN_zero(bn.get());
-    for (auto i = 0; i < ai->length; ++i) {
-        BN_mul_word(bn.get(), 1 << 8);
-        BN_add_word(bn.get(), ai->data[i]);
-    }
+    const auto bn = openssl::bn_ptr(BN_dup(value.get()));
     BN_div_word(bn.get(), 2);
     return Bignum::toByteArray(bn);
 }
 
-QVariant NLCoronaCheckParser::parse(const QByteArray &data)
+// indexes into ADisclosed
+enum {
+    MetadataAttribute,
+    IsSpecimenAttribute,
+    IsPaperProofAttribute,
+    ValidFromAttribute,
+    ValidForHoursAttribute,
+    FirstNameInitialAttribute,
+    LastNameInitialAttribute,
+    BirthDayAttribute,
+    BirthMonthAttribute,
+    AttributeCount
+};
+
+QByteArray NLCoronaCheckParser::decodeTransport(const QByteArray &data)
 {
     if (!data.startsWith("NL2:") || data.size() < 5) {
         return {};
     }
-    const auto rawData = NLBase45::decode(data.begin() + 4, data.end());
+    if (!ParseContext::checkLimit(data.size() - 4, ParseContext::limits().maximumBignumDigits, "Base45 number size")) {
+        return {};
+    }
+    return NLBase45::decode(data.begin() + 4, data.end());
+}
 
-    const auto root = ASN1::Object(rawData.begin(), rawData.end());
+bool NLCoronaCheckParser::parseEnvelope(const QByteArray &data, NLCoronaCheckProof &result)
+{
+    const auto root = ASN1::Object(data.begin(), data.end());
     if (root.tag() != V_ASN1_SEQUENCE) {
-        qCWarning(Log) << "wrong ASN1 root node type" << root.tagName();
-        return {};
+        qCDebug(Log) << "wrong ASN1 root node type" << root.tagName();
+        return false;
     }
 
     // read outer ASN1 sequence
-    IrmaProof proof;
+    auto &proof = result.proof;
     auto outer = root.firstChild();
     proof.disclosureTime = outer.readInt64();
     outer = outer.next();
@@ -71,8 +87,8 @@ QVariant NLCoronaCheckParser::parse(const QByteArray &data)
     proof.AResponses.push_back(outer.readBignum());
     outer = outer.next();
     if (outer.tag() != V_ASN1_SEQUENCE) {
-        qCWarning(Log) << "wrong ADisclosed field type" << outer.tagName();
-        return {};
+        qCDebug(Log) << "wrong ADisclosed field type" << outer.tagName();
+        return false;
     }
 
     // metadata
@@ -85,101 +101,104 @@ QVariant NLCoronaCheckParser::parse(const QByteArray &data)
     // birthDay
     // birthMonth
     auto adisclosed = outer.firstChild();
-    proof.ADisclosed.push_back(adisclosed.readBignum());
+    for (int i = 0; i < AttributeCount; ++i) {
+        if (i > 0) {
+            if (!adisclosed.hasNext()) {
+                qCDebug(Log) << "ADisclosed sequence too short";
+                return false;
+            }
+            adisclosed = adisclosed.next();
+        }
+        proof.ADisclosed.push_back(adisclosed.readBignum());
+    }
+    if (proof.isNull()) {
+        return false;
+    }
 
     // metadata: byte array containing another ASN1 sequence
     // version: OCTET STRING
     // issuer key id: PRINTABLESTRING
-    const auto rawMetaData = nlDecodeAsn1ByteArray(adisclosed);
+    const auto rawMetaData = nlDecodeAttribute(proof.ADisclosed[MetadataAttribute]);
     const auto metadata = ASN1::Object(rawMetaData.begin(), rawMetaData.end());
     if (metadata.tag() != V_ASN1_SEQUENCE) {
-        qCWarning(Log) << "meta data is not a ASN.1 SEQUENCE:" << metadata.tagName();
-        return {};
+        qCDebug(Log) << "meta data is not a ASN.1 SEQUENCE:" << metadata.tagName();
+        return false;
     }
     auto metadataEntry = metadata.firstChild();
     const auto version = metadataEntry.readOctetString();
     if (version.size() != 1 || version[0] != 0x02) {
-        qCWarning(Log) << "unsupported version:" << version;
-        return {};
+        qCDebug(Log) << "unsupported version:" << version;
+        ParseContext::setReason(KHealthCertificatePipeline::UnsupportedVersion);
+        return false;
     }
     metadataEntry = metadataEntry.next();
-    const auto issuer = QString::fromUtf8(metadataEntry.readPrintableString());
+    result.issuer = QString::fromUtf8(metadataEntry.readPrintableString());
+    return true;
+}
 
-    // isSpecimen invalidate the certificate state
-    adisclosed = adisclosed.next();
-    proof.ADisclosed.push_back(adisclosed.readBignum());
-    const auto rawIsSpecimen = nlDecodeAsn1ByteArray(adisclosed);
-    const bool isSpecimen = rawIsSpecimen.size() != 1 || rawIsSpecimen[0] != '0';
-    adisclosed = adisclosed.next();
-    proof.ADisclosed.push_back(adisclosed.readBignum());
+// isSpecimen invalidates the certificate state
+static bool isSpecimen(const IrmaProof &proof)
+{
+    const auto rawIsSpecimen = nlDecodeAttribute(proof.ADisclosed[IsSpecimenAttribute]);
+    return rawIsSpecimen.size() != 1 || rawIsSpecimen[0] != '0';
+}
 
+template <typename Cert>
+static Cert parseCertificate(const IrmaProof &proof, const QByteArray &rawData)
+{
     // valid time range
-    adisclosed = adisclosed.next();
-    proof.ADisclosed.push_back(adisclosed.readBignum());
-    const auto validFrom = QDateTime::fromSecsSinceEpoch(nlDecodeAsn1ByteArray(adisclosed).toLongLong());
-    adisclosed = adisclosed.next();
-    proof.ADisclosed.push_back(adisclosed.readBignum());
-    const auto validTo = validFrom.addSecs(3600 * nlDecodeAsn1ByteArray(adisclosed).toInt());
+    const auto validFrom = QDateTime::fromSecsSinceEpoch(nlDecodeAttribute(proof.ADisclosed[ValidFromAttribute]).toLongLong());
+    const auto validTo = validFrom.addSecs(3600 * nlDecodeAttribute(proof.ADisclosed[ValidForHoursAttribute]).toInt());
 
     // name
-    adisclosed = adisclosed.next();
-    proof.ADisclosed.push_back(adisclosed.readBignum());
-    auto name = QString::fromUtf8(nlDecodeAsn1ByteArray(adisclosed));
-    adisclosed = adisclosed.next();
-    proof.ADisclosed.push_back(adisclosed.readBignum());
-    name += QLatin1Char(' ') + QString::fromUtf8(nlDecodeAsn1ByteArray(adisclosed));
+    auto name = QString::fromUtf8(nlDecodeAttribute(proof.ADisclosed[FirstNameInitialAttribute]));
+    name += QLatin1Char(' ') + QString::fromUtf8(nlDecodeAttribute(proof.ADisclosed[LastNameInitialAttribute]));
 
     // birthday
-    adisclosed = adisclosed.next();
-    proof.ADisclosed.push_back(adisclosed.readBignum());
-    auto bd = QString::fromUtf8(nlDecodeAsn1ByteArray(adisclosed));
-    if (!adisclosed.hasNext()) {
-        qCWarning(Log) << "ADisclosed sequence too short";
-        return {};
-    }
-    adisclosed = adisclosed.next();
-    proof.ADisclosed.push_back(adisclosed.readBignum());
-    bd += QLatin1Char(' ') + QString::fromUtf8(nlDecodeAsn1ByteArray(adisclosed));
+    auto bd = QString::fromUtf8(nlDecodeAttribute(proof.ADisclosed[BirthDayAttribute]));
+    bd += QLatin1Char(' ') + QString::fromUtf8(nlDecodeAttribute(proof.ADisclosed[BirthMonthAttribute]));
     const auto birthday = QDate::fromString(bd, QStringLiteral("d M"));
 
-    // signature
-    if (proof.isNull()) {
-        return {};
-    }
-    const auto publicKey = IrmaPublicKeyLoader::load(issuer);
-    auto sigState = KHealthCertificate::UnknownSignature;
-    if (publicKey.isValid()) {
-        const auto sigValid = IrmaVerifier::verify(proof, publicKey);
-        sigState = sigValid ? KHealthCertificate::ValidSignature : KHealthCertificate::InvalidSignature;
-    }
-
     // proof identifier (used in the revocation list)
     const auto proofId = QCryptographicHash::hash(Bignum::toByteArray(proof.C), QCryptographicHash::Sha256).left(16).toBase64();
 
-    if (validFrom.secsTo(validTo) > 48 * 3600) {
-        KVaccinationCertificate cert;
-        cert.setCountry(QStringLiteral("NL"));
-        cert.setDisease(QStringLiteral("COVID-19"));
-        cert.setName(name);
-        cert.setDateOfBirth(birthday);
-        cert.setCertificateIssueDate(validFrom);
-        cert.setCertificateExpiryDate(validTo);
-        cert.setRawData(data);
-        cert.setSignatureState(isSpecimen ? KHealthCertificate::InvalidSignature : sigState);
-        cert.setCertificateId(QString::fromLatin1(proofId));
-        return cert;
-    } else {
-        KTestCertificate cert;
-        cert.setCountry(QStringLiteral("NL"));
-        cert.setDisease(QStringLiteral("COVID-19"));
-        cert.setResult(KTestCertificate::Negative);
-        cert.setName(name);
-        cert.setDateOfBirth(birthday);
-        cert.setCertificateIssueDate(validFrom);
-        cert.setCertificateExpiryDate(validTo);
-        cert.setRawData(data);
-        cert.setSignatureState(isSpecimen ? KHealthCertificate::InvalidSignature : sigState);
-        cert.setCertificateId(QString::fromLatin1(proofId));
-        return cert;
+    Cert cert;
+    cert.setCountry(QStringLiteral("NL"));
+    cert.setDisease(QStringLiteral("COVID-19"));
+    cert.setName(name);
+    cert.setDateOfBirth(birthday);
+    cert.setCertificateIssueDate(validFrom);
+    cert.setCertificateExpiryDate(validTo);
+    cert.setRawData(rawData);
+    cert.setCertificateId(QString::fromLatin1(proofId));
+    return cert;
+}
+
+KHealthCertificateParser::Certificate NLCoronaCheckParser::parsePayload(const NLCoronaCheckProof &proof, const QByteArray &rawData)
+{
+    const auto validForHours = nlDecodeAttribute(proof.proof.ADisclosed[ValidForHoursAttribute]).toInt();
+    if (validForHours > 48) {
+        return parseCertificate<KVaccinationCertificate>(proof.proof, rawData);
+    }
+
+    auto cert = parseCertificate<KTestCertificate>(proof.proof, rawData);
+    cert.setResult(KTestCertificate::Negative);
+    return cert;
+}
+
+KHealthCertificate::SignatureValidation NLCoronaCheckParser::verifySignature(const NLCoronaCheckProof &proof)
+{
+    if (isSpecimen(proof.proof)) {
+        ParseContext::setReason(KHealthCertificatePipeline::SpecimenCertificate);
+        return KHealthCertificate::InvalidSignature;
+    }
+
+    KHC_TRACEPOINT(key_lookup_begin, int(KHealthCertificatePipeline::NLCoronaCheck));
+    const auto &publicKey = IrmaPublicKeyLoader::load(proof.issuer);
+    KHC_TRACEPOINT(key_lookup_end, int(KHealthCertificatePipeline::NLCoronaCheck), publicKey.isValid());
+    if (!publicKey.isValid()) {
+        ParseContext::setReason(KHealthCertificatePipeline::UnknownSigningKey);
+        return KHealthCertificate::UnknownSignature;
     }
+    return IrmaVerifier::verify(proof.proof, publicKey) ? KHealthCertificate::ValidSignature : KHealthCertificate::InvalidSignature;
 }
@@ -6,15 +6,43 @@
 #ifndef NLCORONACHECKPARSER_H
 #define NLCORONACHECKPARSER_H
 
+#include "irmaverifier_p.h"
+
+#include "khealthcertificate.h"
+#include "khealthcertificateparser.h"
+
+#include <QString>
+
 class QByteArray;
-class QVariant;
+
+/** The IRMA proof contained in a NL CoronaCheck code. */
+class NLCoronaCheckProof
+{
+public:
+    IrmaProof proof;
+    /** Key id of the issuer, from the proof metadata. */
+    QString issuer;
+};
 
 /** Parser for NL COVID-19 CoronaCheck codes. */
 class NLCoronaCheckParser
 {
 public:
     static void init();
-    static QVariant parse(const QByteArray &data);
+
+    /** Decode the modified base45 transport encoding, including the format prefix.
+     *  @returns the ASN.1 encoded proof, or an empty byte array for invalid input.
+     */
+    static QByteArray decodeTransport(const QByteArray &data);
+    /** Parse the ASN.1 encoded proof and its metadata. */
+    static bool parseEnvelope(const QByteArray &data, NLCoronaCheckProof &proof);
+    /** Map the disclosed attributes of @p proof to a certificate.
+     *  The signature state of the result is not set yet.
+     *  @param rawData The original encoded input, for storing on the resulting certificate.
+     */
+    static KHealthCertificateParser::Certificate parsePayload(const NLCoronaCheckProof &proof, const QByteArray &rawData);
+    /** Verify the IRMA proof. */
+    static KHealthCertificate::SignatureValidation verifySignature(const NLCoronaCheckProof &proof);
 };
 
 #endif // NLCORONACHECKPARSER_H
@@ -36,10 +36,13 @@ namespace openssl {
     using bn_ctx_ptr = std::unique_ptr<BN_CTX, detail::deleter<BN_CTX, &BN_CTX_free>>;
     using ec_key_ptr = std::unique_ptr<EC_KEY, detail::deleter<EC_KEY, &EC_KEY_free>>;
     using ecdsa_sig_ptr = std::unique_ptr<ECDSA_SIG, detail::deleter<ECDSA_SIG, &ECDSA_SIG_free>>;
+    using evp_md_ctx_ptr = std::unique_ptr<EVP_MD_CTX, detail::deleter<EVP_MD_CTX, &EVP_MD_CTX_free>>;
     using evp_pkey_ptr = std::unique_ptr<EVP_PKEY, detail::deleter<EVP_PKEY, &EVP_PKEY_free>>;
     using evp_pkey_ctx_ptr = std::unique_ptr<EVP_PKEY_CTX, detail::deleter<EVP_PKEY_CTX, &EVP_PKEY_CTX_free>>;
     using rsa_ptr = std::unique_ptr<RSA, detail::deleter<RSA, &RSA_free>>;
     using x509_ptr = std::unique_ptr<X509, detail::deleter<X509, &X509_free>>;
+    using x509_store_ptr = std::unique_ptr<X509_STORE, detail::deleter<X509_STORE, &X509_STORE_free>>;
+    using x509_store_ctx_ptr = std::unique_ptr<X509_STORE_CTX, detail::deleter<X509_STORE_CTX, &X509_STORE_CTX_free>>;
 }
 
 #endif
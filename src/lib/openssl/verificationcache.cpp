@@ -0,0 +1,262 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "verificationcache_p.h"
+#include "khealthcertificatemetrics_p.h"
+#include "khealthcertificateparser.h"
+#include "logging.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMessageAuthenticationCode>
+#include <QMutex>
+#include <QRandomGenerator>
+#include <QReadWriteLock>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#include <vector>
+
+// File layout: Magic, trust store version, followed by any number of TagSize entries.
+// Entries are HMACs over the trust store version and the cache key, keyed with a per-installation
+// secret stored outside of the cache directory, so the cache file can't be used to inject results.
+constexpr inline const char Magic[] = { 'K', 'H', 'C', 'V' };
+constexpr inline const qsizetype TagSize = 32;
+constexpr inline const qsizetype SecretSize = 32;
+// bounds memory use and load time, this is sufficient for a few thousand certificates
+constexpr inline const qsizetype MaximumEntries = 4096;
+
+VerificationCache::Key::Key(const char *algorithm)
+    : m_hash(QCryptographicHash::Sha256)
+{
+    add(QByteArrayView(algorithm));
+}
+
+VerificationCache::Key& VerificationCache::Key::add(QByteArrayView data)
+{
+    // length prefix, so that different splits of the same data don't collide
+    const auto size = qToLittleEndian<quint64>(data.size());
+    m_hash.addData(QByteArrayView(reinterpret_cast<const char*>(&size), sizeof(size)));
+    m_hash.addData(data);
+    return *this;
+}
+
+VerificationCache::Key& VerificationCache::Key::add(EVP_PKEY *pkey)
+{
+    uint8_t *der = nullptr;
+    const auto size = pkey ? i2d_PUBKEY(pkey, &der) : -1;
+    if (size < 0) {
+        return add(QByteArrayView());
+    }
+    add(QByteArrayView(der, size));
+    OPENSSL_free(der);
+    return *this;
+}
+
+QByteArray VerificationCache::Key::result() const
+{
+    return m_hash.result();
+}
+
+namespace {
+class Cache
+{
+public:
+    Cache();
+    QByteArray tag(const QByteArray &key) const;
+    void flush();
+
+    // immutable after construction
+    QByteArray secret;
+    QByteArray trustStoreVersion;
+    QString fileName;
+
+    QReadWriteLock lock;
+    QSet<QByteArray> entries;
+    std::vector<QByteArray> pending; // not yet written to the file
+
+    // file access happens outside of the above lock, guarded by this
+    QMutex fileMutex;
+    qsizetype fileEntries = 0;
+    bool rewrite = false;
+    bool writeFailed = false;
+};
+}
+
+static QByteArray randomSecret()
+{
+    QByteArray secret(SecretSize, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(secret.data()), SecretSize / sizeof(quint32));
+    return secret;
+}
+
+static QByteArray loadSecret()
+{
+    const auto path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (path.isEmpty()) {
+        return {};
+    }
+    const auto fileName = path + QLatin1String("/khealthcertificate/verification-key");
+    QFile file(fileName);
+    if (file.open(QFile::ReadOnly)) {
+        const auto secret = file.readAll();
+        if (secret.size() == SecretSize) {
+            return secret;
+        }
+    }
+
+    const auto secret = randomSecret();
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile out(fileName);
+    if (!out.open(QFile::WriteOnly) || !out.setPermissions(QFile::ReadOwner | QFile::WriteOwner) || out.write(secret) != secret.size() || !out.commit()) {
+        qCDebug(Log) << "failed to store signature verification cache key:" << out.errorString();
+        return {};
+    }
+    return secret;
+}
+
+Cache::Cache()
+    : trustStoreVersion(KHealthCertificateParser::trustStoreVersion())
+{
+    // without an application there is no application specific storage location, stay in memory only then
+    if (QCoreApplication::instance() && !QCoreApplication::applicationName().isEmpty()) {
+        secret = loadSecret();
+    }
+    const auto path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (secret.isEmpty() || path.isEmpty()) {
+        secret = randomSecret();
+        return;
+    }
+    fileName = path + QLatin1String("/khealthcertificate/verification-cache");
+
+    rewrite = true;
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly)) {
+        return;
+    }
+    const auto header = file.read(sizeof(Magic) + trustStoreVersion.size());
+    if (!header.startsWith(QByteArrayView(Magic, sizeof(Magic))) || !header.endsWith(trustStoreVersion)) {
+        qCDebug(Log) << "discarding outdated signature verification cache";
+        return;
+    }
+    rewrite = false;
+    while (true) {
+        const auto t = file.read(TagSize);
+        if (t.size() != TagSize) {
+            break;
+        }
+        entries.insert(t);
+        ++fileEntries;
+    }
+    while (entries.size() > MaximumEntries) {
+        entries.erase(entries.cbegin());
+    }
+}
+
+QByteArray Cache::tag(const QByteArray &key) const
+{
+    QMessageAuthenticationCode mac(QCryptographicHash::Sha256, secret);
+    mac.addData(trustStoreVersion);
+    mac.addData(key);
+    return mac.result();
+}
+
+void Cache::flush()
+{
+    QMutexLocker fileLocker(&fileMutex);
+    std::vector<QByteArray> newEntries;
+    QList<QByteArray> allEntries;
+    {
+        QWriteLocker locker(&lock);
+        newEntries.swap(pending);
+        // evicted entries remain in the file until it is rewritten, this bounds the file size
+        rewrite = rewrite || fileEntries + qsizetype(newEntries.size()) > 2 * MaximumEntries;
+        if (rewrite && !writeFailed) {
+            allEntries = entries.values();
+        }
+    }
+    if (writeFailed || (newEntries.empty() && !rewrite)) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    if (rewrite) {
+        QSaveFile file(fileName);
+        if (file.open(QFile::WriteOnly)) {
+            file.write(Magic, sizeof(Magic));
+            file.write(trustStoreVersion);
+            for (const auto &t : allEntries) {
+                file.write(t);
+            }
+        }
+        if (!file.commit()) {
+            qCDebug(Log) << "failed to write signature verification cache:" << file.errorString();
+            writeFailed = true;
+            return;
+        }
+        fileEntries = allEntries.size();
+        rewrite = false;
+        return;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QFile::WriteOnly | QFile::Append)) {
+        qCDebug(Log) << "failed to write signature verification cache:" << file.errorString();
+        writeFailed = true;
+        return;
+    }
+    if (file.size() == 0) {
+        file.write(Magic, sizeof(Magic));
+        file.write(trustStoreVersion);
+    }
+    for (const auto &t : newEntries) {
+        file.write(t);
+    }
+    fileEntries += newEntries.size();
+}
+
+static Cache& cache()
+{
+    static Cache s_cache;
+    return s_cache;
+}
+
+bool VerificationCache::contains(const QByteArray &key)
+{
+    auto &c = cache();
+    const auto t = c.tag(key);
+    bool found = false;
+    {
+        QReadLocker locker(&c.lock);
+        found = c.entries.contains(t);
+    }
+    KHealthCertificateMetrics::recordVerificationCacheLookup(found);
+    return found;
+}
+
+void VerificationCache::insert(const QByteArray &key)
+{
+    auto &c = cache();
+    const auto t = c.tag(key);
+    {
+        QWriteLocker locker(&c.lock);
+        if (c.entries.contains(t)) {
+            return;
+        }
+        if (c.entries.size() >= MaximumEntries) {
+            // tags are MACs, so the first entry in hash order is effectively a random one
+            c.entries.erase(c.entries.cbegin());
+        }
+        c.entries.insert(t);
+        if (!c.fileName.isEmpty()) {
+            c.pending.push_back(t);
+        }
+    }
+    c.flush();
+}
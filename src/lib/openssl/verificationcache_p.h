@@ -0,0 +1,49 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef VERIFICATIONCACHE_P_H
+#define VERIFICATIONCACHE_P_H
+
+#include "opensslpp_p.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QCryptographicHash>
+
+/** Persistent cache of successful signature verifications.
+ *
+ *  Entries are identified by a digest over everything that determines the result:
+ *  the algorithm, the public key, the signed data (or its digest) and the signature,
+ *  combined with KHealthCertificateParser::trustStoreVersion().
+ *  Entries are kept across process restarts in the application's cache directory,
+ *  authenticated with a per-installation secret kept in the application's data directory.
+ *  When full, a random entry is evicted.
+ *
+ *  Failed verifications are not cached, as those can be caused by transient errors.
+ *  This is safe to use from multiple threads.
+ */
+namespace VerificationCache
+{
+    /** Computes the cache key for one verification. */
+    class Key
+    {
+    public:
+        explicit Key(const char *algorithm);
+        Key& add(QByteArrayView data);
+        /** Adds the DER encoded public key of @p pkey. */
+        Key& add(EVP_PKEY *pkey);
+        QByteArray result() const;
+
+    private:
+        QCryptographicHash m_hash;
+    };
+
+    /** Returns @c true if verification with @p key succeeded previously. */
+    bool contains(const QByteArray &key);
+    /** Record a successful verification with @p key. */
+    void insert(const QByteArray &key);
+}
+
+#endif // VERIFICATIONCACHE_P_H
@@ -5,29 +5,55 @@
 
 #include "verify_p.h"
 #include "logging.h"
+#include "parsecontext_p.h"
 
 #include "openssl/bignum_p.h"
+#include "openssl/verificationcache_p.h"
 
 #include <openssl/err.h>
 
 bool Verify::verifyECDSA(
-    const openssl::evp_pkey_ptr &pkey, const EVP_MD *digest,
+    EVP_PKEY *pkey, const EVP_MD *digest,
     const char *data, std::size_t dataSize,
     const char *signature, std::size_t signatureSize)
 {
     if (!pkey) {
-        qCWarning(Log) << "no key provided";
+        qCDebug(Log) << "no key provided";
         return false;
     }
 
-    const openssl::ec_key_ptr ecKey(EVP_PKEY_get1_EC_KEY(pkey.get()));
-
     // compute hash of the signed data
     uint8_t digestData[EVP_MAX_MD_SIZE];
     uint32_t  digestSize = 0;
     EVP_Digest(reinterpret_cast<const uint8_t*>(data), dataSize, digestData, &digestSize, digest, nullptr);
-    if (digestSize * 2 != signatureSize || EVP_PKEY_bits(pkey.get()) != 4 * (int)signatureSize) {
-        qCWarning(Log) << "digest size mismatch!?" << digestSize << signatureSize;
+    return verifyECDSADigest(pkey, digestData, digestSize, signature, signatureSize);
+}
+
+bool Verify::verifyECDSADigest(
+    EVP_PKEY *pkey,
+    const uint8_t *digestData, std::size_t digestSize,
+    const char *signature, std::size_t signatureSize)
+{
+    if (!pkey) {
+        qCDebug(Log) << "no key provided";
+        return false;
+    }
+    if (!ParseContext::addCryptoOperation()) {
+        return false;
+    }
+
+    const auto cacheKey = VerificationCache::Key("ECDSA")
+        .add(pkey)
+        .add(QByteArrayView(digestData, digestSize))
+        .add(QByteArrayView(signature, signatureSize))
+        .result();
+    if (VerificationCache::contains(cacheKey)) {
+        return true;
+    }
+
+    const openssl::ec_key_ptr ecKey(EVP_PKEY_get1_EC_KEY(pkey));
+    if (digestSize * 2 != signatureSize || EVP_PKEY_bits(pkey) != 4 * (int)signatureSize) {
+        qCDebug(Log) << "digest size mismatch!?" << digestSize << signatureSize;
         return false;
     }
 
@@ -41,11 +67,12 @@ bool Verify::verifyECDSA(
     const auto verifyResult = ECDSA_do_verify(digestData, digestSize, sig.get(), ecKey.get());
     switch (verifyResult) {
         case -1: // technical issue
-            qCWarning(Log) << "Failed to verify signature:" << ERR_error_string(ERR_get_error(), nullptr);
+            qCDebug(Log) << "Failed to verify signature:" << ERR_error_string(ERR_get_error(), nullptr);
             return false;
         case 0: // invalid signature
             return false;
         case 1: // valid signature;
+            VerificationCache::insert(cacheKey);
             return true;
     }
 
@@ -12,8 +12,23 @@
 namespace Verify
 {
     bool verifyECDSA(
+        EVP_PKEY *pkey, const EVP_MD *digest,
+        const char *data, std::size_t dataSize,
+        const char *signature, std::size_t signatureSize);
+    inline bool verifyECDSA(
         const openssl::evp_pkey_ptr &pkey, const EVP_MD *digest,
         const char *data, std::size_t dataSize,
+        const char *signature, std::size_t signatureSize)
+    {
+        return verifyECDSA(pkey.get(), digest, data, dataSize, signature, signatureSize);
+    }
+
+    /** Verify an ECDSA signature over already digested data.
+     *  This is useful if the signed data is produced incrementally.
+     */
+    bool verifyECDSADigest(
+        EVP_PKEY *pkey,
+        const uint8_t *digestData, std::size_t digestSize,
         const char *signature, std::size_t signatureSize);
 }
 
@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "x509validationcache_p.h"
+
+#include <QTimeZone>
+
+#include <ctime>
+
+// bounds memory use per thread, a certificate scanner typically only ever sees a handful of signers
+constexpr inline const qsizetype MaximumEntries = 1024;
+
+std::optional<KHealthCertificate::SignatureValidation> X509ValidationCache::lookup(X509 *cert) const
+{
+    const auto key = digest(cert);
+    if (key.isEmpty()) {
+        return {};
+    }
+
+    const auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd() || it.value().expiry <= QDateTime::currentDateTimeUtc()) {
+        return {};
+    }
+    return it.value().result;
+}
+
+void X509ValidationCache::insert(X509 *cert, KHealthCertificate::SignatureValidation result, const QDateTime &expiry)
+{
+    const auto key = digest(cert);
+    if (key.isEmpty() || !expiry.isValid()) {
+        return;
+    }
+
+    if (m_entries.size() >= MaximumEntries) {
+        const auto now = QDateTime::currentDateTimeUtc();
+        m_entries.removeIf([&now](const auto &it) { return it.value().expiry <= now; });
+        if (m_entries.size() >= MaximumEntries) {
+            m_entries.clear();
+        }
+    }
+    m_entries.insert(key, { result, expiry });
+}
+
+QDateTime X509ValidationCache::expiryTime(const X509 *cert)
+{
+    std::tm t{};
+    if (!cert || ASN1_TIME_to_tm(X509_get0_notAfter(cert), &t) != 1) {
+        return {};
+    }
+    return QDateTime(QDate(t.tm_year + 1900, t.tm_mon + 1, t.tm_mday), QTime(t.tm_hour, t.tm_min, t.tm_sec), QTimeZone::utc());
+}
+
+QByteArray X509ValidationCache::digest(X509 *cert)
+{
+    QByteArray result(EVP_MAX_MD_SIZE, Qt::Uninitialized);
+    unsigned int size = 0;
+    if (!cert || X509_digest(cert, EVP_sha256(), reinterpret_cast<unsigned char*>(result.data()), &size) != 1) {
+        return {};
+    }
+    result.truncate(size);
+    return result;
+}
@@ -0,0 +1,44 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef X509VALIDATIONCACHE_P_H
+#define X509VALIDATIONCACHE_P_H
+
+#include "khealthcertificate.h"
+#include "opensslpp_p.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+
+#include <optional>
+
+/** Cache for X.509 certificate validation results.
+ *  Entries are keyed by the SHA-256 digest of the DER encoded certificate,
+ *  and expire together with the first certificate of the validated chain.
+ *  This isn't thread-safe, use one instance per thread.
+ */
+class X509ValidationCache
+{
+public:
+    /** Returns the cached result for @p cert, if there is one and it hasn't expired yet. */
+    std::optional<KHealthCertificate::SignatureValidation> lookup(X509 *cert) const;
+    /** Store the validation result for @p cert, valid until @p expiry. */
+    void insert(X509 *cert, KHealthCertificate::SignatureValidation result, const QDateTime &expiry);
+
+    /** Expiry time of @p cert. */
+    static QDateTime expiryTime(const X509 *cert);
+
+private:
+    static QByteArray digest(X509 *cert);
+
+    struct Entry {
+        KHealthCertificate::SignatureValidation result;
+        QDateTime expiry;
+    };
+    QHash<QByteArray, Entry> m_entries;
+};
+
+#endif // X509VALIDATIONCACHE_P_H
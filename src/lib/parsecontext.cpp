@@ -0,0 +1,100 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "parsecontext_p.h"
+#include "khealthcertificateparsersession_p.h"
+#include "logging.h"
+
+static thread_local ParseContext *s_currentContext = nullptr;
+
+ParseContext::ParseContext(const KHealthCertificateParser::ParseLimits &limits)
+    : m_limits(limits)
+    , m_previous(s_currentContext)
+    , m_session(s_currentContext ? s_currentContext->m_session : nullptr)
+{
+    s_currentContext = this;
+}
+
+ParseContext::ParseContext(KHealthCertificateParserSessionPrivate *session)
+    : m_limits(session->limits)
+    , m_previous(s_currentContext)
+    , m_session(session)
+{
+    s_currentContext = this;
+}
+
+ParseContext::~ParseContext()
+{
+    s_currentContext = m_previous;
+}
+
+const KHealthCertificateParser::ParseLimits& ParseContext::limits()
+{
+    static const KHealthCertificateParser::ParseLimits s_defaultLimits;
+    return s_currentContext ? s_currentContext->m_limits : s_defaultLimits;
+}
+
+bool ParseContext::checkLimit(qsizetype value, qsizetype limit, const char *what)
+{
+    if (value <= limit) {
+        return true;
+    }
+    setLimitExceeded(what);
+    return false;
+}
+
+void ParseContext::setLimitExceeded(const char *what)
+{
+    qCDebug(Log) << "parse limit exceeded:" << what;
+    if (s_currentContext) {
+        s_currentContext->m_limitExceeded = true;
+    }
+    setReason(KHealthCertificatePipeline::ResourceLimitExceeded);
+}
+
+bool ParseContext::addCryptoOperation()
+{
+    if (!s_currentContext) {
+        return true;
+    }
+    return checkLimit(++s_currentContext->m_cryptoOperations, s_currentContext->m_limits.maximumCryptoOperations, "crypto operations");
+}
+
+KHealthCertificateParserSessionPrivate* ParseContext::session()
+{
+    return s_currentContext ? s_currentContext->m_session : nullptr;
+}
+
+void ParseContext::setReason(KHealthCertificatePipeline::Reason reason)
+{
+    if (s_currentContext && s_currentContext->m_reason == KHealthCertificatePipeline::NoReason) {
+        s_currentContext->m_reason = reason;
+    }
+}
+
+bool ParseContext::limitExceeded() const
+{
+    return m_limitExceeded;
+}
+
+KHealthCertificatePipeline::Reason ParseContext::reason() const
+{
+    return m_reason;
+}
+
+void ParseContext::clearReason()
+{
+    m_reason = KHealthCertificatePipeline::NoReason;
+}
+
+int ParseContext::cryptoOperations() const
+{
+    return m_cryptoOperations;
+}
+
+void ParseContext::setCryptoOperations(int count)
+{
+    m_cryptoOperations = count;
+}
@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef PARSECONTEXT_P_H
+#define PARSECONTEXT_P_H
+
+#include "khealthcertificateparser.h"
+#include "khealthcertificatepipeline.h"
+
+class KHealthCertificateParserSessionPrivate;
+
+/** State of the parse operation running in the current thread.
+ *  This carries the resource limits to all parser stages, without having
+ *  to pass them through every internal API.
+ *
+ *  A context is active for the lifetime of the object, in the thread it was
+ *  created in. Without an active context the default limits apply.
+ *
+ *  Nested contexts inherit the parser session of their enclosing context.
+ */
+class ParseContext
+{
+public:
+    explicit ParseContext(const KHealthCertificateParser::ParseLimits &limits);
+    /** Context for a parse operation using the resources of @p session. */
+    explicit ParseContext(KHealthCertificateParserSessionPrivate *session);
+    ~ParseContext();
+
+    /** Resource limits of the current parse operation. */
+    static const KHealthCertificateParser::ParseLimits &limits();
+
+    /** Checks @p value against @p limit.
+     *  If it exceeds the limit, the current parse operation is flagged accordingly
+     *  and @c false is returned.
+     */
+    static bool checkLimit(qsizetype value, qsizetype limit, const char *what);
+    /** Flag the current parse operation as having exceeded its limits. */
+    static void setLimitExceeded(const char *what);
+    /** Account for one signature or certificate chain verification.
+     *  Returns @c false if the budget for this is exhausted.
+     */
+    static bool addCryptoOperation();
+
+    /** Reusable resources of the current parse operation.
+     *  Returns @c nullptr if the current operation isn't part of a parser session.
+     */
+    static KHealthCertificateParserSessionPrivate* session();
+
+    /** Record the reason for a problem found in the current parse operation.
+     *  Only the first reason is kept, as that is usually the most specific one.
+     */
+    static void setReason(KHealthCertificatePipeline::Reason reason);
+
+    /** Whether any limit was hit in this context. */
+    bool limitExceeded() const;
+    /** The first reason recorded in this context. */
+    KHealthCertificatePipeline::Reason reason() const;
+    /** Forget the recorded reason, e.g. when continuing with the next parser stage. */
+    void clearReason();
+
+    /** Number of crypto operations performed so far. */
+    int cryptoOperations() const;
+    /** Continue from @p count previously performed crypto operations,
+     *  for parse operations spanning multiple contexts.
+     */
+    void setCryptoOperations(int count);
+
+private:
+    Q_DISABLE_COPY_MOVE(ParseContext)
+
+    KHealthCertificateParser::ParseLimits m_limits;
+    ParseContext *m_previous = nullptr;
+    KHealthCertificateParserSessionPrivate *m_session = nullptr;
+    int m_cryptoOperations = 0;
+    KHealthCertificatePipeline::Reason m_reason = KHealthCertificatePipeline::NoReason;
+    bool m_limitExceeded = false;
+};
+
+#endif // PARSECONTEXT_P_H
@@ -4,62 +4,92 @@
  */
 
 #include "jwtparser_p.h"
-#include "jwkloader_p.h"
 #include "logging.h"
+#include "parsecontext_p.h"
+#include "shckeyregistry_p.h"
+#include "tracepoints_p.h"
 #include "openssl/verify_p.h"
 #include "zlib/zlib_p.h"
 
+#include <KHealthCertificatePipeline>
+
 #include <QJsonDocument>
 #include <QJsonObject>
 
 JwtParser::JwtParser() = default;
 JwtParser::~JwtParser() = default;
 
+// decodes a base64url encoded JWS segment, without copying the encoded data first
+static QByteArray decodeSegment(const QByteArray &data, qsizetype begin, qsizetype end, bool &ok)
+{
+    auto result = QByteArray::fromBase64Encoding(QByteArray::fromRawData(data.constData() + begin, end - begin),
+                                                 QByteArray::Base64UrlEncoding | QByteArray::AbortOnBase64DecodingErrors);
+    ok = ok && result;
+    return std::move(*result);
+}
+
 void JwtParser::parse(const QByteArray &data)
 {
     const auto idx1 = data.indexOf('.');
-    if (idx1 < 0) {
+    const auto idx2 = idx1 < 0 ? -1 : data.indexOf('.', idx1 + 1);
+    if (idx2 < 0) {
+        return;
+    }
+
+    bool ok = true;
+    m_header = QJsonDocument::fromJson(decodeSegment(data, 0, idx1, ok)).object();
+    m_payload = decodeSegment(data, idx1 + 1, idx2, ok);
+    m_signature = decodeSegment(data, idx2 + 1, data.size(), ok);
+    if (!ok) {
+        qCDebug(Log) << "invalid base64url encoding in JWS";
+        m_payload.clear();
         return;
     }
-    const auto header = QJsonDocument::fromJson(QByteArray::fromBase64(data.left(idx1), QByteArray::Base64UrlEncoding)).object();
 
-    const auto idx2 = data.indexOf('.', idx1 + 1);
-    auto rawPayload = QByteArray::fromBase64(data.mid(idx1 + 1, idx2 - idx1 - 1), QByteArray::Base64UrlEncoding);
-    if (header.value(QLatin1String("zip")).toString() == QLatin1String("DEF")) {
-        rawPayload = Zlib::decompressDeflate(rawPayload);
+    if (m_header.value(QLatin1String("zip")).toString() == QLatin1String("DEF")) {
+        m_payload = Zlib::decompressDeflate(m_payload);
+    }
+    m_data = data;
+    m_signedSize = idx2;
+}
+
+QByteArray JwtParser::payload() const
+{
+    return m_payload;
+}
+
+QByteArray JwtParser::keyId() const
+{
+    return m_header.value(QLatin1String("kid")).toString().toUtf8();
+}
+
+KHealthCertificate::SignatureValidation JwtParser::verifySignature(const QString &issuer) const
+{
+    if (m_data.isEmpty()) {
+        return KHealthCertificate::InvalidSignature;
     }
-    m_payload = QJsonDocument::fromJson(rawPayload).object();
 
-    // signature verification
-    const auto signature = QByteArray::fromBase64(data.mid(idx2 + 1), QByteArray::Base64UrlEncoding);
-    const auto kid = header.value(QLatin1String("kid")).toString();
-    const auto evp = JwkLoader::loadPublicKey(QLatin1String(":/org.kde.khealthcertificate/shc/certs/") + kid + QLatin1String(".jwk"));
+    const auto kid = m_header.value(QLatin1String("kid")).toString();
+    KHC_TRACEPOINT(key_lookup_begin, int(KHealthCertificatePipeline::SmartHealthCard));
+    const auto evp = ShcKeyRegistry::publicKey(issuer, kid);
+    KHC_TRACEPOINT(key_lookup_end, int(KHealthCertificatePipeline::SmartHealthCard), evp != nullptr);
     if (!evp) {
-        qCWarning(Log) << "no key found for kid:" << kid;
-        m_signatureState = KHealthCertificate::UnknownSignature;
-        return;
+        qCDebug(Log) << "no key found for kid:" << kid << issuer;
+        ParseContext::setReason(KHealthCertificatePipeline::UnknownSigningKey);
+        return KHealthCertificate::UnknownSignature;
     }
-    const auto alg = header.value(QLatin1String("alg")).toString();
+    const auto alg = m_header.value(QLatin1String("alg")).toString();
     bool valid = false;
     if (alg == QLatin1String("ES256")) {
-        valid = Verify::verifyECDSA(evp, EVP_sha256(), data.constData(), idx2, signature.constData(), signature.size());
+        valid = Verify::verifyECDSA(evp, EVP_sha256(), m_data.constData(), m_signedSize, m_signature.constData(), m_signature.size());
     } else if (alg == QLatin1String("ES384")) {
-        valid = Verify::verifyECDSA(evp, EVP_sha384(), data.constData(), idx2, signature.constData(), signature.size());
+        valid = Verify::verifyECDSA(evp, EVP_sha384(), m_data.constData(), m_signedSize, m_signature.constData(), m_signature.size());
     } else if (alg == QLatin1String("ES512")) {
-        valid = Verify::verifyECDSA(evp, EVP_sha512(), data.constData(), idx2, signature.constData(), signature.size());
+        valid = Verify::verifyECDSA(evp, EVP_sha512(), m_data.constData(), m_signedSize, m_signature.constData(), m_signature.size());
     } else {
-        qCWarning(Log) << "signature algorithm not supported:" << alg;
+        qCDebug(Log) << "signature algorithm not supported:" << alg;
+        ParseContext::setReason(KHealthCertificatePipeline::UnsupportedSignatureAlgorithm);
     }
 
-    m_signatureState = valid ? KHealthCertificate::ValidSignature : KHealthCertificate::InvalidSignature;
-}
-
-QJsonObject JwtParser::payload() const
-{
-    return m_payload;
-}
-
-KHealthCertificate::SignatureValidation JwtParser::signatureState() const
-{
-    return m_signatureState;
+    return valid ? KHealthCertificate::ValidSignature : KHealthCertificate::InvalidSignature;
 }
@@ -8,6 +8,7 @@
 
 #include "khealthcertificate.h"
 
+#include <QByteArray>
 #include <QJsonObject>
 
 /** Decoding of JSON Web Tokens (JWT). */
@@ -19,12 +20,20 @@ public:
 
     void parse(const QByteArray &data);
 
-    QJsonObject payload() const;
-    KHealthCertificate::SignatureValidation signatureState() const;
+    /** The decoded (and if necessary decompressed) JSON payload. */
+    QByteArray payload() const;
+    /** The key id from the JWS header. */
+    QByteArray keyId() const;
+    /** Verify the signature using the key with the header's key id from @p issuer. */
+    KHealthCertificate::SignatureValidation verifySignature(const QString &issuer) const;
 
 private:
-    QJsonObject m_payload;
-    KHealthCertificate::SignatureValidation m_signatureState = KHealthCertificate::InvalidSignature;
+    QByteArray m_data;
+    QJsonObject m_header;
+    QByteArray m_payload;
+    QByteArray m_signature;
+    // size of the signed part of m_data
+    qsizetype m_signedSize = 0;
 };
 
 #endif // JWTPARSER_P_H
@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "shckeyregistry_p.h"
+#include "jwkloader_p.h"
+#include "logging.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrl>
+
+// Key sets are stored as <percent-encoded issuer URL>.jwks, in the format served
+// by issuers at <iss>/.well-known/jwks.json, see update-shc-certs.py.
+// Individual keys from before that (<kid>.jwk) have no issuer information, those are
+// indexed by key id only and consulted for issuers without a key set.
+// ### the bundled keys are all still in the legacy format, so issuer binding is not in
+// effect until they are regenerated with update-shc-certs.py
+ShcKeyRegistry::ShcKeyRegistry()
+{
+    for (QDirIterator it(QStringLiteral(":/org.kde.khealthcertificate/shc/certs"), QDir::Files); it.hasNext();) {
+        const QFileInfo fi(it.next());
+        if (fi.suffix() == QLatin1String("jwks")) {
+            loadKeySet(QUrl::fromPercentEncoding(fi.completeBaseName().toUtf8()), fi.filePath());
+        } else if (fi.suffix() == QLatin1String("jwk")) {
+            loadKey(fi.filePath());
+        }
+    }
+    qCDebug(Log) << m_keys.size() << "SHC keys loaded," << m_issuers.size() << "issuers with key sets";
+}
+
+const ShcKeyRegistry& ShcKeyRegistry::instance()
+{
+    static const ShcKeyRegistry s_registry;
+    return s_registry;
+}
+
+void ShcKeyRegistry::loadKeySet(const QString &iss, const QString &fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QFile::ReadOnly)) {
+        qCWarning(Log) << f.errorString();
+        return;
+    }
+
+    const auto keys = QJsonDocument::fromJson(f.readAll()).object().value(QLatin1String("keys")).toArray();
+    for (const auto &keyV : keys) {
+        const auto keyObj = keyV.toObject();
+        const auto kid = keyObj.value(QLatin1String("kid")).toString();
+        auto key = JwkLoader::loadPublicKey(keyObj);
+        if (!key || kid.isEmpty()) {
+            continue;
+        }
+        m_issuers.insert(iss);
+        const auto id = std::make_pair(iss, kid);
+        if (!m_keyIndex.contains(id)) {
+            m_keyIndex.insert(id, key.get());
+            m_keys.push_back(std::move(key));
+        }
+    }
+}
+
+void ShcKeyRegistry::loadKey(const QString &fileName)
+{
+    const auto kid = QFileInfo(fileName).completeBaseName();
+    auto key = JwkLoader::loadPublicKey(fileName);
+    if (!key || kid.isEmpty() || m_legacyKeyIndex.contains(kid)) {
+        return;
+    }
+    m_legacyKeyIndex.insert(kid, key.get());
+    m_keys.push_back(std::move(key));
+}
+
+EVP_PKEY* ShcKeyRegistry::publicKey(const QString &iss, const QString &kid)
+{
+    const auto &registry = instance();
+    // keys of issuers with a key set are bound to that issuer
+    if (!registry.m_issuers.isEmpty() && registry.m_issuers.contains(iss)) {
+        return registry.m_keyIndex.value(std::make_pair(iss, kid));
+    }
+    return registry.m_legacyKeyIndex.value(kid);
+}
@@ -0,0 +1,44 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef SHCKEYREGISTRY_P_H
+#define SHCKEYREGISTRY_P_H
+
+#include "openssl/opensslpp_p.h"
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+#include <utility>
+#include <vector>
+
+/** Public keys of known SMART Health Card issuers.
+ *  Keys are read from the JSON Web Key Sets (JWKS) published by each issuer,
+ *  and are indexed by issuer and key id. Keys in the older single key format
+ *  carry no issuer, those are only indexed by key id and are used for issuers
+ *  without a key set. All keys are loaded once on first use.
+ */
+class ShcKeyRegistry
+{
+public:
+    /** Returns the public key @p kid of issuer @p iss, @c nullptr if not known.
+     *  The returned key is owned by the registry.
+     */
+    static EVP_PKEY* publicKey(const QString &iss, const QString &kid);
+
+private:
+    explicit ShcKeyRegistry();
+    static const ShcKeyRegistry& instance();
+    void loadKeySet(const QString &iss, const QString &fileName);
+    void loadKey(const QString &fileName);
+
+    std::vector<openssl::evp_pkey_ptr> m_keys;
+    QHash<std::pair<QString, QString>, EVP_PKEY*> m_keyIndex;
+    QSet<QString> m_issuers; // issuers with a key set
+    QHash<QString, EVP_PKEY*> m_legacyKeyIndex;
+};
+
+#endif // SHCKEYREGISTRY_P_H
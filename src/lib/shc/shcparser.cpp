@@ -5,17 +5,21 @@
 
 #include "shcparser_p.h"
 #include "jwtparser_p.h"
-#include "kvaccinationcertificate.h"
+#include "json/jsonstreamreader_p.h"
+#include "kvaccinationcertificate_p.h"
 #include "logging.h"
+#include "stringpool_p.h"
 
 #include <QByteArray>
 #include <QDebug>
 #include <QFile>
-#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QStringList>
 #include <QVariant>
 
+#include <iterator>
+
 void ShcParser::init()
 {
     Q_INIT_RESOURCE(shc_certs);
@@ -23,106 +27,332 @@ void ShcParser::init()
     Q_INIT_RESOURCE(shc_data);
 }
 
-QVariant ShcParser::parse(const QByteArray &data)
+QByteArray ShcParser::decodeTransport(const QByteArray &data)
 {
     if (!data.startsWith("shc:/")) {
         return {};
     }
 
     if (data.indexOf('/', 5) > 0) {
-        qCWarning(Log) << "SHC chunked data not supported yet!";
+        qCDebug(Log) << "SHC chunk, needs to be reassembled first";
         return {};
     }
 
-    QByteArray unpacked;
-    unpacked.reserve(data.size() / 2);
-    for (int i = 5; i < data.size() - 1; i += 2) {
-        unpacked.push_back((data[i] - '0') * 10 + (data[i + 1] - '0') + 45);
+    return decodeNumeric(data.constData() + 5, data.constData() + data.size());
+}
+
+QByteArray ShcParser::decodeNumeric(const char *begin, const char *end)
+{
+    const auto size = std::distance(begin, end);
+    if (size == 0 || size % 2 != 0) {
+        qCDebug(Log) << "invalid SHC numeric data size:" << size;
+        return {};
     }
 
+    QByteArray unpacked(size / 2, Qt::Uninitialized);
+    auto out = reinterpret_cast<unsigned char*>(unpacked.data());
+    auto in = reinterpret_cast<const unsigned char*>(begin);
+
+    // each digit pair encodes one character in the range [45, 122]
+    // validation errors are accumulated rather than handled per pair, so the loop has no branches and can be vectorized
+    unsigned char error = 0;
+    for (qsizetype i = 0; i < unpacked.size(); ++i) {
+        const unsigned char high = in[2 * i] - '0';
+        const unsigned char low = in[2 * i + 1] - '0';
+        const unsigned char value = high * 10 + low;
+        error |= (high > 9) | (low > 9) | (value > 77);
+        out[i] = value + 45;
+    }
+
+    if (error) {
+        qCDebug(Log) << "invalid SHC numeric data";
+        return {};
+    }
+    return unpacked;
+}
+
+KHealthCertificateParser::Certificate ShcParser::parseJws(const QByteArray &jws, const QByteArray &rawData)
+{
     JwtParser jwt;
-    jwt.parse(unpacked);
-
-    const auto nbf = QDateTime::fromSecsSinceEpoch(jwt.payload().value(QLatin1String("nbf")).toDouble());
-    const auto vc = jwt.payload().value(QLatin1String("vc")).toObject();
-    const auto types = vc.value(QLatin1String("type")).toArray();
-    //qDebug().noquote() << QJsonDocument(vc).toJson();
-    for (const auto &type : types) {
-        if (type.toString() == QLatin1String("https://smarthealth.cards#immunization")) {
-            auto cert = parseImmunization(vc.value(QLatin1String("credentialSubject")).toObject());
-            cert.setCertificateIssueDate(nbf);
-            cert.setCertificateIssuer(jwt.payload().value(QLatin1String("iss")).toString());
-            cert.setRawData(data);
-            cert.setSignatureState(jwt.signatureState());
-            return cert;
+    jwt.parse(jws);
+    auto result = parsePayload(jwt.payload(), rawData);
+    if (auto cert = std::get_if<KVaccinationCertificate>(&result)) {
+        cert->setSignatureState(jwt.verifySignature(cert->certificateIssuer()));
+    }
+    return result;
+}
+
+KHealthCertificateParser::Certificate ShcParser::parsePayload(const QByteArray &payload, const QByteArray &rawData)
+{
+    // the payload is read in a streaming fashion, as FHIR bundles can contain many resources we don't need
+    JsonStreamReader reader(payload);
+    if (!reader.isObject()) {
+        return {};
+    }
+    reader.enterContainer();
+
+    QString issuer;
+    QDateTime nbf;
+    bool isImmunization = false;
+    KVaccinationCertificate cert;
+    while (reader.hasNext()) {
+        const auto name = reader.readName();
+        if (name == "iss") {
+            issuer = reader.readString();
+        } else if (name == "nbf") {
+            nbf = QDateTime::fromSecsSinceEpoch(reader.readDouble());
+        } else if (name == "vc") {
+            isImmunization = parseVerifiableCredential(reader, cert);
+        } else {
+            reader.next();
         }
     }
+    reader.leaveContainer();
+    if (reader.hasError() || !isImmunization) {
+        return {};
+    }
 
-    return {};
+    cert.setCertificateIssueDate(std::move(nbf));
+    cert.setCertificateIssuer(issuer);
+    cert.setRawData(rawData);
+    return cert;
 }
 
-KVaccinationCertificate ShcParser::parseImmunization(const QJsonObject &obj)
+bool ShcParser::parseVerifiableCredential(JsonStreamReader &reader, KVaccinationCertificate &cert)
 {
-    const auto entries = obj.value(QLatin1String("fhirBundle")).toObject().value(QLatin1String("entry")).toArray();
-    KVaccinationCertificate cert;
-    for (const auto &entryV : entries) {
-        const auto res = entryV.toObject().value(QLatin1String("resource")).toObject();
-        const auto resourceType = res.value(QLatin1String("resourceType")).toString();
-        if (resourceType == QLatin1String("Patient")) {
-            cert.setDateOfBirth(QDate::fromString(res.value(QLatin1String("birthDate")).toString(), Qt::ISODate));
-            const auto nameArray = res.value(QLatin1String("name")).toArray();
-            if (nameArray.size() != 1) {
-                return {};
-            }
-            const auto nameObj = nameArray.at(0).toObject();
-            const auto given = nameObj.value(QLatin1String("given")).toArray();
-            QStringList nameParts;
-            nameParts.reserve(given.size() + 1);
-            for (const auto &givenV : given) {
-                nameParts.push_back(givenV.toString());
+    if (!reader.isObject()) {
+        reader.next();
+        return false;
+    }
+    reader.enterContainer();
+
+    bool isImmunization = false;
+    while (reader.hasNext()) {
+        const auto name = reader.readName();
+        if (name == "type" && reader.isArray()) {
+            reader.enterContainer();
+            while (reader.hasNext()) {
+                isImmunization |= reader.readString() == QLatin1String("https://smarthealth.cards#immunization");
             }
-            nameParts.push_back(nameObj.value(QLatin1String("family")).toString());
-            cert.setName(nameParts.join(QLatin1Char(' ')));
+            reader.leaveContainer();
+        } else if (name == "credentialSubject") {
+            // type and credentialSubject can come in any order, so this is parsed in any case
+            cert = parseImmunization(reader);
+        } else {
+            reader.next();
         }
-        else if (resourceType == QLatin1String("Immunization")) {
-            if (res.value(QLatin1String("status")).toString() != QLatin1String("completed")) {
-                continue;
-            }
-            const auto dt = QDate::fromString(res.value(QLatin1String("occurrenceDateTime")).toString(), Qt::ISODate);
-            if (cert.date().isValid() && cert.date() > dt) { // TODO alternatively, emit two certs, one for each dose?
-                cert.setDose(cert.dose() + 1);
-                continue;
-            }
+    }
+    reader.leaveContainer();
+    return isImmunization;
+}
 
-            cert.setDate(dt);
-            cert.setDose(std::max(1, cert.dose() + 1));
+using VaccinationCertificateBuilder = KHealthCertificateInternal::CertificateBuilder<KVaccinationCertificatePrivate>;
 
-            const auto vacCode = res.value(QLatin1String("vaccineCode")).toObject().value(QLatin1String("coding")).toArray();
-            if (vacCode.size() != 1) {
-                continue;
-            }
-            const auto vacObj = vacCode.at(0).toObject();
-            QJsonObject cvxData;
-            if (vacObj.value(QLatin1String("system")).toString() == QLatin1String("http://hl7.org/fhir/sid/cvx")) {
-                QFile cvxFile(QStringLiteral(":/org.kde.khealthcertificate/shc/hl7-cvx-codes.json"));
-                if (!cvxFile.open(QFile::ReadOnly)) {
-                    qCWarning(Log) << cvxFile.errorString();
+namespace {
+/** The fields of a FHIR resource we are interested in. */
+struct FhirResource {
+    QString resourceType;
+
+    // Patient
+    QString birthDate;
+    int nameCount = 0;
+    QStringList givenNames;
+    QString familyName;
+
+    // Immunization
+    QString status;
+    QString occurrenceDateTime;
+    int vaccineCodingCount = 0;
+    QString vaccineCodeSystem;
+    QString vaccineCode;
+};
+}
+
+// iterates over the elements of the array at the current position
+template <typename Func>
+static void forEachElement(JsonStreamReader &reader, Func &&func)
+{
+    if (!reader.isArray()) {
+        reader.next();
+        return;
+    }
+    reader.enterContainer();
+    while (reader.hasNext()) {
+        func();
+    }
+    reader.leaveContainer();
+}
+
+// iterates over the members of the object at the current position
+template <typename Func>
+static void forEachMember(JsonStreamReader &reader, Func &&func)
+{
+    if (!reader.isObject()) {
+        reader.next();
+        return;
+    }
+    reader.enterContainer();
+    while (reader.hasNext()) {
+        func(reader.readName());
+    }
+    reader.leaveContainer();
+}
+
+static void readHumanName(JsonStreamReader &reader, FhirResource &res)
+{
+    forEachMember(reader, [&](QByteArrayView name) {
+        if (name == "given") {
+            forEachElement(reader, [&]() { res.givenNames.push_back(reader.readString()); });
+        } else if (name == "family") {
+            res.familyName = reader.readString();
+        } else {
+            reader.next();
+        }
+    });
+}
+
+static void readCoding(JsonStreamReader &reader, FhirResource &res)
+{
+    forEachMember(reader, [&](QByteArrayView name) {
+        if (name == "system") {
+            res.vaccineCodeSystem = reader.readString();
+        } else if (name == "code") {
+            res.vaccineCode = reader.readString();
+        } else {
+            reader.next();
+        }
+    });
+}
+
+static void readResource(JsonStreamReader &reader, FhirResource &res)
+{
+    forEachMember(reader, [&](QByteArrayView name) {
+        if (name == "resourceType") {
+            res.resourceType = reader.readString();
+        } else if (name == "birthDate") {
+            res.birthDate = reader.readString();
+        } else if (name == "name") {
+            forEachElement(reader, [&]() {
+                if (res.nameCount++ == 0) {
+                    readHumanName(reader, res);
+                } else {
+                    reader.next();
                 }
-                const auto cvxDb = QJsonDocument::fromJson(cvxFile.readAll()).object();
-                cvxData = cvxDb.value(vacObj.value(QLatin1String("code")).toString()).toObject();
-            }
+            });
+        } else if (name == "status") {
+            res.status = reader.readString();
+        } else if (name == "occurrenceDateTime") {
+            res.occurrenceDateTime = reader.readString();
+        } else if (name == "vaccineCode") {
+            forEachMember(reader, [&](QByteArrayView codeName) {
+                if (codeName != "coding") {
+                    reader.next();
+                    return;
+                }
+                forEachElement(reader, [&]() {
+                    if (res.vaccineCodingCount++ == 0) {
+                        readCoding(reader, res);
+                    } else {
+                        reader.next();
+                    }
+                });
+            });
+        } else {
+            reader.next();
+        }
+    });
+}
 
-            if (cvxData.isEmpty()) {
-                cert.setVaccine(vacObj.value(QLatin1String("system")).toString() + QLatin1Char('/') + vacObj.value(QLatin1String("code")).toString());
-            } else {
-                cert.setVaccine(cvxData.value(QLatin1String("n")).toString());
-                cert.setDisease(cvxData.value(QLatin1String("d")).toString());
-                cert.setManufacturer(cvxData.value(QLatin1String("m")).toString());
-            }
+static QJsonObject cvxData(const QString &code)
+{
+    static const auto cvxDb = []() {
+        QFile cvxFile(QStringLiteral(":/org.kde.khealthcertificate/shc/hl7-cvx-codes.json"));
+        if (!cvxFile.open(QFile::ReadOnly)) {
+            qCWarning(Log) << cvxFile.errorString();
         }
-        else {
-            qCDebug(Log) << "unhandled resource type:" << resourceType << res;
+        return QJsonDocument::fromJson(cvxFile.readAll()).object();
+    }();
+    return cvxDb.value(code).toObject();
+}
+
+// returns false if the certificate is invalid
+static bool applyResource(const FhirResource &res, VaccinationCertificateBuilder &cert)
+{
+    if (res.resourceType == QLatin1String("Patient")) {
+        cert->dateOfBirth = QDate::fromString(res.birthDate, Qt::ISODate);
+        if (res.nameCount != 1) {
+            return false;
         }
+        auto nameParts = res.givenNames;
+        nameParts.push_back(res.familyName);
+        cert->name = nameParts.join(QLatin1Char(' '));
     }
-    return cert;
+    else if (res.resourceType == QLatin1String("Immunization")) {
+        if (res.status != QLatin1String("completed")) {
+            return true;
+        }
+        const auto dt = QDate::fromString(res.occurrenceDateTime, Qt::ISODate);
+        if (cert->date.isValid() && cert->date > dt) { // TODO alternatively, emit two certs, one for each dose?
+            ++cert->dose;
+            return true;
+        }
+
+        cert->date = dt;
+        cert->dose = std::max(1, cert->dose + 1);
+
+        if (res.vaccineCodingCount != 1) {
+            return true;
+        }
+        QJsonObject cvx;
+        if (res.vaccineCodeSystem == QLatin1String("http://hl7.org/fhir/sid/cvx")) {
+            cvx = cvxData(res.vaccineCode);
+        }
+
+        if (cvx.isEmpty()) {
+            cert->vaccine = res.vaccineCodeSystem + QLatin1Char('/') + res.vaccineCode;
+        } else {
+            cert->vaccine = StringPool::intern(cvx.value(QLatin1String("n")).toString());
+            cert->disease = StringPool::intern(cvx.value(QLatin1String("d")).toString());
+            cert->manufacturer = StringPool::intern(cvx.value(QLatin1String("m")).toString());
+        }
+    }
+    else {
+        qCDebug(Log) << "unhandled resource type:" << res.resourceType;
+    }
+    return true;
+}
+
+KVaccinationCertificate ShcParser::parseImmunization(JsonStreamReader &reader)
+{
+    VaccinationCertificateBuilder cert;
+    bool valid = true;
+    // only one resource is held in memory at a time, so this doesn't grow with the size of the bundle
+    FhirResource res;
+    forEachMember(reader, [&](QByteArrayView subjectName) {
+        if (subjectName != "fhirBundle") {
+            reader.next();
+            return;
+        }
+        forEachMember(reader, [&](QByteArrayView bundleName) {
+            if (bundleName != "entry") {
+                reader.next();
+                return;
+            }
+            forEachElement(reader, [&]() {
+                forEachMember(reader, [&](QByteArrayView entryName) {
+                    if (entryName != "resource" || !valid) {
+                        reader.next();
+                        return;
+                    }
+                    res = {};
+                    readResource(reader, res);
+                    valid = applyResource(res, cert);
+                });
+            });
+        });
+    });
+    if (!valid) {
+        return {};
+    }
+    return cert.build();
 }
@@ -6,11 +6,11 @@
 #ifndef SHCPARSER_P_H
 #define SHCPARSER_P_H
 
-class KVaccinationCertificate;
+#include "khealthcertificateparser.h"
+
+class JsonStreamReader;
 
 class QByteArray;
-class QJsonObject;
-class QVariant;
 
 /** Parser for Smart Health Cards
  *  @see https://spec.smarthealth.cards/
@@ -19,10 +19,28 @@ class ShcParser
 {
 public:
     static void init();
-    static QVariant parse(const QByteArray &data);
+
+    /** Decode the numeric transport encoding of a SHC QR code, including the format prefix.
+     *  @returns the JWS, or an empty byte array for invalid input or chunked certificates.
+     */
+    static QByteArray decodeTransport(const QByteArray &data);
+    /** Decodes the numeric encoding used in SHC QR codes into a (partial) JWS.
+     *  @returns an empty byte array for invalid input.
+     */
+    static QByteArray decodeNumeric(const char *begin, const char *end);
+    /** Parse and verify an already decoded JWS.
+     *  @param rawData The original encoded input, for storing on the resulting certificate.
+     */
+    static KHealthCertificateParser::Certificate parseJws(const QByteArray &jws, const QByteArray &rawData);
+    /** Map the JWS payload to a certificate.
+     *  The signature state of the result is not set yet.
+     *  @param rawData The original encoded input, for storing on the resulting certificate.
+     */
+    static KHealthCertificateParser::Certificate parsePayload(const QByteArray &payload, const QByteArray &rawData);
 
 private:
-    static KVaccinationCertificate parseImmunization(const QJsonObject &obj);
+    static bool parseVerifiableCredential(JsonStreamReader &reader, KVaccinationCertificate &cert);
+    static KVaccinationCertificate parseImmunization(JsonStreamReader &reader);
 };
 
 #endif // SHCPARSER_P_H
@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "stringpool_p.h"
+#include "khealthcertificateparser_p.h"
+#include "logging.h"
+
+#include <KCountry>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+
+// all string values in these are pooled
+static constexpr const char* const valueSetTables[] = {
+    ":/org.kde.khealthcertificate/eu-dgc/ma.json",
+    ":/org.kde.khealthcertificate/eu-dgc/mp.json",
+    ":/org.kde.khealthcertificate/eu-dgc/tcMa.json",
+    ":/org.kde.khealthcertificate/eu-dgc/tcTr.json",
+    ":/org.kde.khealthcertificate/eu-dgc/tcTt.json",
+    ":/org.kde.khealthcertificate/eu-dgc/tg.json",
+    ":/org.kde.khealthcertificate/eu-dgc/vp.json",
+    ":/org.kde.khealthcertificate/icao/data/diseases.json",
+    ":/org.kde.khealthcertificate/icao/data/vaccines.json",
+    ":/org.kde.khealthcertificate/shc/hl7-cvx-codes.json",
+};
+
+static void addValues(QSet<QString> &strings, const QJsonValue &value)
+{
+    if (value.isString()) {
+        strings.insert(value.toString());
+    } else if (value.isObject()) {
+        const auto obj = value.toObject();
+        for (auto it = obj.begin(); it != obj.end(); ++it) {
+            addValues(strings, it.value());
+        }
+    } else if (value.isArray()) {
+        const auto array = value.toArray();
+        for (const auto &v : array) {
+            addValues(strings, v);
+        }
+    }
+}
+
+static QSet<QString> loadPool()
+{
+    KHealthCertificateParser::initResources();
+
+    QSet<QString> strings;
+    for (const auto fileName : valueSetTables) {
+        QFile f(QLatin1String(fileName));
+        if (!f.open(QFile::ReadOnly)) {
+            qCWarning(Log) << f.fileName() << f.errorString();
+            continue;
+        }
+        addValues(strings, QJsonDocument::fromJson(f.readAll()).object());
+    }
+
+    const auto countries = KCountry::allCountries();
+    for (const auto &country : countries) {
+        strings.insert(country.alpha2());
+    }
+    return strings;
+}
+
+QString StringPool::intern(const QString &s)
+{
+    static const auto s_pool = loadPool();
+
+    if (s.isEmpty()) {
+        return s;
+    }
+    const auto it = s_pool.constFind(s);
+    return it != s_pool.constEnd() ? *it : s;
+}
@@ -0,0 +1,28 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef STRINGPOOL_P_H
+#define STRINGPOOL_P_H
+
+#include <QString>
+
+/** Process-wide pool for frequently repeated certificate field values.
+ *  Values such as vaccine names, manufacturers, diseases or countries only come
+ *  from a small set of distinct strings, interning them lets all certificates
+ *  share a single QString instance for each of those.
+ *
+ *  The pool is built once on first use from the built-in value set tables and
+ *  the ISO 3166-1 country codes, and is immutable afterwards. It therefore is safe
+ *  to use from multiple threads without locking, and can't be filled with input data.
+ */
+namespace StringPool
+{
+    /** Returns a string equal to @p s, sharing its data with all other results for the same value.
+     *  Strings not in the pool are returned unchanged.
+     */
+    QString intern(const QString &s);
+}
+
+#endif // STRINGPOOL_P_H
@@ -0,0 +1,34 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef TRACEPOINTS_P_H
+#define TRACEPOINTS_P_H
+
+#include "config-tracepoints_p.h"
+
+/** Static user-space tracepoints (USDT), for use with perf, bpftrace, SystemTap, etc.
+ *  Enabled with the ENABLE_TRACEPOINTS build option, otherwise this expands to nothing
+ *  and the arguments aren't evaluated.
+ *
+ *  All probes are in the "khealthcertificate" provider. Format arguments are
+ *  KHealthCertificatePipeline::Format values, sizes are in bytes.
+ *
+ *  - parse_begin(size), parse_end(format, outcome)
+ *  - stage_begin(format, stage, size), stage_end(format, stage, success)
+ *  - key_lookup_begin(format), key_lookup_end(format, found)
+ *  - cose_verify_begin(algorithm, size), cose_verify_end(algorithm, state)
+ *  - irma_verify_begin(attributes), irma_verify_end(result)
+ *  - jws_canonical_rdf_begin(members), jws_canonical_rdf_end(size)
+ *
+ *  Example: bpftrace -e 'usdt:libKHealthCertificate.so:khealthcertificate:stage_begin { ... }'
+ */
+#if HAVE_TRACEPOINTS
+#include <sys/sdt.h>
+#define KHC_TRACEPOINT(name, ...) STAP_PROBEV(khealthcertificate, name, __VA_ARGS__)
+#else
+#define KHC_TRACEPOINT(name, ...) do {} while (false)
+#endif
+
+#endif // TRACEPOINTS_P_H
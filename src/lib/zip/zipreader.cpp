@@ -0,0 +1,198 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "zipreader_p.h"
+#include "logging.h"
+#include "parsecontext_p.h"
+#include "zlib/zlib_p.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+
+#include <zlib.h>
+
+// see https://pkware.cachefly.net/webdocs/casestudies/APPNOTE.TXT
+enum : quint32 {
+    LocalFileHeaderSignature = 0x04034b50,
+    CentralDirectoryHeaderSignature = 0x02014b50,
+    EndOfCentralDirectorySignature = 0x06054b50,
+};
+
+enum : qsizetype {
+    LocalFileHeaderSize = 30,
+    CentralDirectoryHeaderSize = 46,
+    EndOfCentralDirectorySize = 22,
+    MaximumCommentSize = 0xffff,
+};
+
+enum : quint16 {
+    MethodStored = 0,
+    MethodDeflated = 8,
+    FlagEncrypted = 0x0001,
+};
+
+// certificate archives contain a single JSON file, anything beyond this isn't one
+constexpr inline const qsizetype MaximumEntryCount = 16;
+
+template <typename T>
+static T readLE(const char *data)
+{
+    return qFromLittleEndian<T>(data);
+}
+
+ZipReader::ZipReader(const QByteArray &data)
+    : m_data(data)
+{
+    m_valid = readCentralDirectory();
+    if (!m_valid) {
+        m_entries.clear();
+    }
+}
+
+bool ZipReader::isZip(const QByteArray &data)
+{
+    return data.size() >= LocalFileHeaderSize + EndOfCentralDirectorySize && readLE<quint32>(data.constData()) == LocalFileHeaderSignature;
+}
+
+bool ZipReader::isValid() const
+{
+    return m_valid;
+}
+
+bool ZipReader::readCentralDirectory()
+{
+    if (!isZip(m_data)) {
+        return false;
+    }
+
+    // the end of central directory record is at the very end, possibly followed by a comment
+    const auto begin = m_data.constData();
+    const auto minEocdOffset = std::max<qsizetype>(0, m_data.size() - EndOfCentralDirectorySize - MaximumCommentSize);
+    qsizetype eocdOffset = m_data.size() - EndOfCentralDirectorySize;
+    for (; eocdOffset >= minEocdOffset; --eocdOffset) {
+        if (readLE<quint32>(begin + eocdOffset) == EndOfCentralDirectorySignature
+         && eocdOffset + EndOfCentralDirectorySize + readLE<quint16>(begin + eocdOffset + 20) == m_data.size()) {
+            break;
+        }
+    }
+    if (eocdOffset < minEocdOffset) {
+        qCDebug(Log) << "ZIP end of central directory not found";
+        return false;
+    }
+
+    const auto eocd = begin + eocdOffset;
+    const auto diskNumber = readLE<quint16>(eocd + 4);
+    const auto cdDiskNumber = readLE<quint16>(eocd + 6);
+    const auto diskEntryCount = readLE<quint16>(eocd + 8);
+    const auto entryCount = readLE<quint16>(eocd + 10);
+    const qsizetype cdSize = readLE<quint32>(eocd + 12);
+    const qsizetype cdOffset = readLE<quint32>(eocd + 16);
+    if (diskNumber != 0 || cdDiskNumber != 0 || diskEntryCount != entryCount) {
+        qCDebug(Log) << "multi-volume ZIP files are not supported";
+        return false;
+    }
+    if (!ParseContext::checkLimit(entryCount, MaximumEntryCount, "ZIP entry count")) {
+        return false;
+    }
+    if (cdOffset + cdSize > eocdOffset) {
+        return false;
+    }
+
+    m_entries.reserve(entryCount);
+    auto it = begin + cdOffset;
+    const auto cdEnd = it + cdSize;
+    for (int i = 0; i < entryCount; ++i) {
+        if (cdEnd - it < CentralDirectoryHeaderSize || readLE<quint32>(it) != CentralDirectoryHeaderSignature) {
+            return false;
+        }
+        const auto flags = readLE<quint16>(it + 8);
+        const auto nameSize = readLE<quint16>(it + 28);
+        const auto extraSize = readLE<quint16>(it + 30);
+        const auto commentSize = readLE<quint16>(it + 32);
+        const auto headerSize = CentralDirectoryHeaderSize + nameSize + extraSize + commentSize;
+        if (cdEnd - it < headerSize) {
+            return false;
+        }
+
+        Entry entry;
+        entry.name = QByteArrayView(it + CentralDirectoryHeaderSize, nameSize);
+        entry.method = readLE<quint16>(it + 10);
+        entry.crc = readLE<quint32>(it + 16);
+        entry.compressedSize = readLE<quint32>(it + 20);
+        entry.size = readLE<quint32>(it + 24);
+        entry.localHeaderOffset = readLE<quint32>(it + 42);
+        it += headerSize;
+
+        if (entry.name.endsWith('/')) {
+            continue; // directory
+        }
+        if (flags & FlagEncrypted) {
+            qCDebug(Log) << "encrypted ZIP entry" << entry.name;
+            return false;
+        }
+        if (!ParseContext::checkLimit(std::max(entry.size, entry.compressedSize), ParseContext::limits().maximumDecompressedSize, "ZIP entry size")) {
+            return false;
+        }
+        m_entries.push_back(entry);
+    }
+
+    return true;
+}
+
+qsizetype ZipReader::entryCount() const
+{
+    return (qsizetype)m_entries.size();
+}
+
+QByteArrayView ZipReader::entryName(qsizetype index) const
+{
+    return m_entries[index].name;
+}
+
+qsizetype ZipReader::entrySize(qsizetype index) const
+{
+    return m_entries[index].size;
+}
+
+QByteArray ZipReader::entryData(qsizetype index) const
+{
+    const auto &entry = m_entries[index];
+
+    // the local header repeats name and extra field, but not necessarily with the same size
+    const qsizetype headerOffset = entry.localHeaderOffset;
+    if (headerOffset + LocalFileHeaderSize > m_data.size() || readLE<quint32>(m_data.constData() + headerOffset) != LocalFileHeaderSignature) {
+        return {};
+    }
+    const auto dataOffset = headerOffset + LocalFileHeaderSize
+        + readLE<quint16>(m_data.constData() + headerOffset + 26)
+        + readLE<quint16>(m_data.constData() + headerOffset + 28);
+    if (dataOffset + (qsizetype)entry.compressedSize > m_data.size()) {
+        return {};
+    }
+
+    const auto rawData = QByteArray::fromRawData(m_data.constData() + dataOffset, entry.compressedSize);
+    QByteArray result;
+    switch (entry.method) {
+        case MethodStored:
+            if (entry.size != entry.compressedSize) {
+                return {};
+            }
+            result = rawData;
+            break;
+        case MethodDeflated:
+            result = Zlib::decompressDeflate(rawData, entry.size);
+            break;
+        default:
+            qCDebug(Log) << "unsupported ZIP compression method" << entry.method;
+            return {};
+    }
+
+    if (result.isNull() || crc32(0, reinterpret_cast<const Bytef*>(result.constData()), result.size()) != entry.crc) {
+        qCDebug(Log) << "invalid ZIP entry" << entry.name;
+        return {};
+    }
+    return result;
+}
@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef ZIPREADER_P_H
+#define ZIPREADER_P_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include <vector>
+
+/** Minimal in-memory ZIP file reader.
+ *  This only covers what is needed for certificates packaged as ZIP files (such as
+ *  DIVOC), ie. single volume archives with stored or deflated entries, without
+ *  encryption or ZIP64 extensions.
+ *
+ *  No data is copied for stored entries, the input data therefore must outlive
+ *  this and any data returned from it.
+ */
+class ZipReader
+{
+public:
+    explicit ZipReader(const QByteArray &data);
+
+    /** Checks whether @p data looks like a ZIP file. */
+    static bool isZip(const QByteArray &data);
+
+    /** Whether the central directory has been read successfully. */
+    bool isValid() const;
+
+    /** Number of file entries, directories are skipped. */
+    qsizetype entryCount() const;
+    /** File name of entry @p index, including its path. */
+    QByteArrayView entryName(qsizetype index) const;
+    /** Uncompressed size of entry @p index. */
+    qsizetype entrySize(qsizetype index) const;
+    /** Content of entry @p index.
+     *  For stored entries this references the input data, deflated entries
+     *  are decompressed. Returns a null QByteArray on error.
+     */
+    QByteArray entryData(qsizetype index) const;
+
+private:
+    bool readCentralDirectory();
+
+    struct Entry {
+        QByteArrayView name;
+        quint32 crc;
+        quint32 compressedSize;
+        quint32 size;
+        quint32 localHeaderOffset;
+        quint16 method;
+    };
+
+    QByteArray m_data;
+    std::vector<Entry> m_entries;
+    bool m_valid = false;
+};
+
+#endif // ZIPREADER_P_H
@@ -4,46 +4,109 @@
  */
 
 #include "zlib_p.h"
+#include "khealthcertificateparsersession_p.h"
 #include "logging.h"
+#include "parsecontext_p.h"
 
 #include <QByteArray>
 
 #include <zlib.h>
 
-static QByteArray decompress(const QByteArray &data, int windowBits)
+#include <algorithm>
+
+// inflates @p data using an already initialized @p stream into @p out
+// returns at most @p maximumSize bytes, callers can detect truncation by allowing one extra byte
+static bool inflateData(z_stream &stream, const QByteArray &data, QByteArray &out, qsizetype maximumSize)
 {
-    QByteArray out;
-    out.resize(4096);
-    z_stream stream;
-    stream.zalloc = nullptr;
-    stream.zfree = nullptr;
-    stream.opaque = nullptr;
     stream.avail_in = data.size();
     stream.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(data.data()));
-    stream.avail_out = out.size();
-    stream.next_out = reinterpret_cast<unsigned char*>(out.data());
 
-    inflateInit2(&stream, windowBits);
-    const auto res = inflate(&stream, Z_NO_FLUSH);
+    qsizetype outSize = 0;
+    int res = Z_OK;
+    while (res == Z_OK) {
+        if (outSize == out.size()) {
+            if (out.size() >= maximumSize) {
+                break;
+            }
+            out.resize(std::min(maximumSize, std::max<qsizetype>(256, out.size() * 2)));
+        }
+        stream.avail_out = out.size() - outSize;
+        stream.next_out = reinterpret_cast<unsigned char*>(out.data() + outSize);
+        res = inflate(&stream, Z_NO_FLUSH);
+        outSize = out.size() - stream.avail_out;
+    }
+
     switch (res) {
-        case Z_OK:
+        case Z_OK: // output limit reached
         case Z_STREAM_END:
             break; // all good
+        case Z_BUF_ERROR:
+            if (stream.avail_in == 0 && outSize < out.size()) {
+                break; // input ended without an end marker, same as before
+            }
+            [[fallthrough]];
         default:
-            qCWarning(Log) << "zlib decompression failed" << stream.msg;
+            qCDebug(Log) << "zlib decompression failed" << stream.msg;
+            return false;
+    }
+    out.truncate(outSize);
+    return true;
+}
+
+static QByteArray decompress(const QByteArray &data, int windowBits, qsizetype initialSize, qsizetype maximumSize)
+{
+    // reuse the stream and output buffer of the parser session, if there is one
+    if (auto session = ParseContext::session()) {
+        auto stream = session->inflateStream(windowBits);
+        if (!stream) {
+            return {};
+        }
+        auto &out = session->inflateBuffer();
+        out.resize(std::min(maximumSize, std::max(initialSize, out.capacity())));
+        if (!inflateData(*stream, data, out, maximumSize)) {
             return {};
+        }
+        return out;
     }
+
+    z_stream stream;
+    stream.zalloc = nullptr;
+    stream.zfree = nullptr;
+    stream.opaque = nullptr;
+    stream.avail_in = 0;
+    stream.next_in = nullptr;
+    if (inflateInit2(&stream, windowBits) != Z_OK) {
+        qCWarning(Log) << "zlib initialization failed" << stream.msg;
+        return {};
+    }
+
+    QByteArray out(initialSize, Qt::Uninitialized);
+    const auto success = inflateData(stream, data, out, maximumSize);
     inflateEnd(&stream);
-    out.truncate(out.size() - stream.avail_out);
-    return out;
+    return success ? out : QByteArray();
 }
 
 QByteArray Zlib::decompressZlib(const QByteArray &data)
 {
-    return decompress(data, MAX_WBITS);
+    const auto maximumSize = ParseContext::limits().maximumDecompressedSize;
+    auto out = decompress(data, MAX_WBITS, std::min<qsizetype>(4096, maximumSize), maximumSize + 1);
+    return ParseContext::checkLimit(out.size(), maximumSize, "decompressed size") ? out : QByteArray();
 }
 
 QByteArray Zlib::decompressDeflate(const QByteArray &data)
 {
-    return decompress(data, -MAX_WBITS);
+    const auto maximumSize = ParseContext::limits().maximumDecompressedSize;
+    auto out = decompress(data, -MAX_WBITS, std::min<qsizetype>(4096, maximumSize), maximumSize + 1);
+    return ParseContext::checkLimit(out.size(), maximumSize, "decompressed size") ? out : QByteArray();
+}
+
+QByteArray Zlib::decompressDeflate(const QByteArray &data, qsizetype size)
+{
+    // one spare byte so we notice when the data is larger than announced
+    auto out = decompress(data, -MAX_WBITS, size + 1, size + 1);
+    if (out.size() != size) {
+        qCDebug(Log) << "unexpected decompressed size" << out.size() << size;
+        return {};
+    }
+    return out;
 }
@@ -6,6 +6,8 @@
 #ifndef ZLIB_P_H
 #define ZLIB_P_H
 
+#include <QtGlobal>
+
 class QByteArray;
 
 /** Zlib convenience methods. */
@@ -13,6 +15,10 @@ namespace  Zlib
 {
 QByteArray decompressZlib(const QByteArray &data);
 QByteArray decompressDeflate(const QByteArray &data);
+/** Decompress raw deflate data of a known decompressed @p size,
+ *  such as found in ZIP files. Fails if the output size doesn't match.
+ */
+QByteArray decompressDeflate(const QByteArray &data, qsizetype size);
 }
 
 #endif // ZLIB_P_H
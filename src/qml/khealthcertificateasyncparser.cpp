@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include "khealthcertificateasyncparser.h"
+
+#include <KHealthCertificateParser>
+
+#include <utility>
+
+KHealthCertificateAsyncParser::KHealthCertificateAsyncParser(QObject *parent)
+    : QObject(parent)
+{
+    m_threadPool.setMaxThreadCount(1);
+}
+
+KHealthCertificateAsyncParser::~KHealthCertificateAsyncParser()
+{
+    // the running request accesses our session
+    m_threadPool.waitForDone();
+}
+
+bool KHealthCertificateAsyncParser::isBusy() const
+{
+    return m_currentRequest.isValid();
+}
+
+void KHealthCertificateAsyncParser::parse(const QVariant &data)
+{
+    if (!m_currentRequest.isValid()) {
+        start(data);
+        Q_EMIT busyChanged();
+        return;
+    }
+
+    // newer input replaces whatever is waiting, unless it's what we are working on already
+    if (data == m_currentRequest) {
+        m_pendingRequest.clear();
+    } else {
+        m_pendingRequest = data;
+    }
+}
+
+void KHealthCertificateAsyncParser::start(const QVariant &data)
+{
+    m_currentRequest = data;
+    m_threadPool.start([this, data]() {
+        const auto input = data.userType() == QMetaType::QString ? data.toString().toUtf8() : data.toByteArray();
+        const auto certificate = KHealthCertificateParser::parse(m_session, input);
+        QMetaObject::invokeMethod(this, [this, certificate]() { requestFinished(certificate); }, Qt::QueuedConnection);
+    });
+}
+
+void KHealthCertificateAsyncParser::requestFinished(const QVariant &certificate)
+{
+    m_currentRequest.clear();
+
+    // superseded while running, the result is stale
+    if (m_pendingRequest.isValid()) {
+        start(std::exchange(m_pendingRequest, {}));
+        return;
+    }
+
+    Q_EMIT busyChanged();
+    Q_EMIT finished(certificate);
+}
+
+#include "moc_khealthcertificateasyncparser.cpp"
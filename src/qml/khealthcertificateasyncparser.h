@@ -0,0 +1,57 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef KHEALTHCERTIFICATEASYNCPARSER_H
+#define KHEALTHCERTIFICATEASYNCPARSER_H
+
+#include <KHealthCertificateParserSession>
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVariant>
+
+/** Parses health certificates in a background thread.
+ *  This is meant for feeding in barcode scanner results for every camera frame,
+ *  without parsing and signature verification blocking the UI.
+ *
+ *  Only one request is processed at a time. A request that is superseded by
+ *  a newer one is dropped, while waiting as well as while already being processed.
+ */
+class KHealthCertificateAsyncParser : public QObject
+{
+    Q_OBJECT
+    /** @c true while a request is being processed. */
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+public:
+    explicit KHealthCertificateAsyncParser(QObject *parent = nullptr);
+    ~KHealthCertificateAsyncParser() override;
+
+    bool isBusy() const;
+
+    /** Parse @p data.
+     *  @param data Barcode content as QByteArray, or as QString.
+     *  Byte arrays are passed on to the parser as-is, strings are converted in the background.
+     *  Repeating the request currently being processed has no effect.
+     */
+    Q_INVOKABLE void parse(const QVariant &data);
+
+Q_SIGNALS:
+    /** Emitted when parsing the most recent request finished.
+     *  @param certificate The same as KHealthCertificateParser::parse() returns.
+     */
+    void finished(const QVariant &certificate);
+    void busyChanged();
+
+private:
+    void start(const QVariant &data);
+    void requestFinished(const QVariant &certificate);
+
+    KHealthCertificateParserSession m_session; // only used by the one request running at a time
+    QThreadPool m_threadPool;
+    QVariant m_currentRequest;
+    QVariant m_pendingRequest;
+};
+
+#endif // KHEALTHCERTIFICATEASYNCPARSER_H
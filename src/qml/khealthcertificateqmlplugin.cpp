@@ -4,7 +4,10 @@
     SPDX-License-Identifier: LGPL-2.0-or-later
 */
 
+#include "khealthcertificateasyncparser.h"
+
 #include <KHealthCertificate>
+#include <KHealthCertificateModel>
 #include <KHealthCertificateParser>
 #include <KRecoveryCertificate>
 #include <KTestCertificate>
@@ -50,6 +53,8 @@ void KHealthCertificateQmlPlugin::registerTypes(const char*)
     qmlRegisterUncreatableMetaObject(KHealthCertificate::staticMetaObject, "org.kde.khealthcertificate", 1, 0, "HealthCertificate", {});
     qmlRegisterUncreatableMetaObject(KTestCertificate::staticMetaObject, "org.kde.khealthcertificate", 1, 0, "TestCertificate", {});
     qmlRegisterUncreatableMetaObject(KVaccinationCertificate::staticMetaObject, "org.kde.khealthcertificate", 1, 0, "VaccinationCertificate", {});
+    qmlRegisterType<KHealthCertificateModel>("org.kde.khealthcertificate", 1, 0, "HealthCertificateModel");
+    qmlRegisterType<KHealthCertificateAsyncParser>("org.kde.khealthcertificate", 1, 0, "AsyncHealthCertificateParser");
 
     // HACK qmlplugindump chokes on gadget singletons, to the point of breaking ecm_find_qmlmodule()
     if (QCoreApplication::applicationName() != QLatin1String("qmlplugindump")) {
@@ -6,6 +6,7 @@ import argparse
 import json
 import os
 import requests
+import urllib.parse
 
 parser = argparse.ArgumentParser(description='Download certificates for validating SHCs')
 parser.add_argument('--output', type=str, required=True, help='Path to which the output should be written to')
@@ -21,7 +22,7 @@ issuerUrls = []
 for issuer in vciDirectory['participating_issuers']:
     issuerUrls.append(issuer['iss'])
 
-jwkFileNames = []
+jwksFileNames = []
 for issuer in issuerUrls:
     print(f"Downloading {issuer}...")
     try:
@@ -38,15 +39,14 @@ for issuer in issuerUrls:
         print(f"    exception: {ex} - {req.text}")
         continue
     if not jwks or 'keys' not in jwks:
-        print(f"    invalid JWKS:" << req.text)
+        print(f"    invalid JWKS: {req.text}")
         continue
-    for key in jwks['keys']:
-        jwkFileName = key['kid'] + '.jwk'
-        jwkPath = os.path.join(arguments.output, jwkFileName)
-        jwkFile = open(jwkPath, 'w')
-        jwkFile.write(json.dumps(key))
-        jwkFile.close()
-        jwkFileNames.append(jwkFileName)
+    # key sets are stored as published, the file name is the percent-encoded issuer URL
+    jwksFileName = urllib.parse.quote(issuer, safe='') + '.jwks'
+    jwksFile = open(os.path.join(arguments.output, jwksFileName), 'w')
+    jwksFile.write(json.dumps(jwks))
+    jwksFile.close()
+    jwksFileNames.append(jwksFileName)
 
 qrcFile = open(os.path.join(arguments.output, 'shc-certs.qrc'), 'w')
 qrcFile.write("""<!--
@@ -56,8 +56,8 @@ qrcFile.write("""<!--
 <RCC>
   <qresource prefix="/org.kde.khealthcertificate/shc/certs">
 """)
-for jwkFileName in jwkFileNames:
-    qrcFile.write(f"    <file>{jwkFileName}</file>\n")
+for jwksFileName in jwksFileNames:
+    qrcFile.write(f"    <file>{jwksFileName}</file>\n")
 qrcFile.write("""  </qresource>
 </RCC>""")
 qrcFile.close()
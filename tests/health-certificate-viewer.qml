@@ -38,7 +38,15 @@ Kirigami.ApplicationWindow {
             title: "Health Certificate Viewer"
 
             function showCertificate(rawData) {
-                var cert = HealthCertificateParser.parse(rawData);
+                parser.parse(rawData);
+            }
+
+            AsyncHealthCertificateParser {
+                id: parser
+                onFinished: (cert) => showParsedCertificate(cert)
+            }
+
+            function showParsedCertificate(cert) {
                 switch (cert.type) {
                     case HealthCertificate.Vaccination:
                         applicationWindow().pageStack.push(vaccinationPage, {"cert": cert});
@@ -0,0 +1,126 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include <KHealthCertificateParser>
+#include <KHealthCertificateParserSession>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+#include <QVariant>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// multi-threaded parser stress test and scaling benchmark
+// parses a corpus of certificates from N threads concurrently and reports the throughput
+
+static std::vector<QByteArray> loadCorpus(const QString &path)
+{
+    std::vector<QByteArray> corpus;
+    QDirIterator it(path, { QStringLiteral("*.txt"), QStringLiteral("*.json"), QStringLiteral("*.bin") }, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile f(it.next());
+        if (f.open(QFile::ReadOnly)) {
+            corpus.push_back(f.readAll().trimmed());
+        }
+    }
+    return corpus;
+}
+
+// returns the number of successfully parsed certificates
+static qint64 parseCorpus(const std::vector<QByteArray> &corpus, int iterations, bool useSession)
+{
+    KHealthCertificateParserSession session;
+    qint64 parsed = 0;
+    for (int i = 0; i < iterations; ++i) {
+        for (const auto &data : corpus) {
+            const auto cert = useSession ? KHealthCertificateParser::parse(session, data) : KHealthCertificateParser::parse(data);
+            if (!cert.isNull()) {
+                ++parsed;
+            }
+        }
+    }
+    return parsed;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption iterationsOpt(QStringLiteral("iterations"), QStringLiteral("Number of passes over the corpus per thread."), QStringLiteral("count"), QStringLiteral("20"));
+    parser.addOption(iterationsOpt);
+    QCommandLineOption threadsOpt(QStringLiteral("threads"), QStringLiteral("Maximum number of threads."), QStringLiteral("count"), QString::number(QThread::idealThreadCount()));
+    parser.addOption(threadsOpt);
+    QCommandLineOption sessionOpt(QStringLiteral("session"), QStringLiteral("Use one parser session per thread."));
+    parser.addOption(sessionOpt);
+    parser.addPositionalArgument(QStringLiteral("corpus"), QStringLiteral("Directory containing certificates, defaults to the autotest data."));
+    parser.process(app);
+
+    const auto corpusPath = parser.positionalArguments().isEmpty() ? QStringLiteral(CORPUS_DIR) : parser.positionalArguments().at(0);
+    const auto corpus = loadCorpus(corpusPath);
+    if (corpus.empty()) {
+        fprintf(stderr, "no certificates found in %s\n", qPrintable(corpusPath));
+        return 1;
+    }
+    const auto iterations = std::max(1, parser.value(iterationsOpt).toInt());
+    const auto maxThreads = std::max(1, parser.value(threadsOpt).toInt());
+    const auto useSession = parser.isSet(sessionOpt);
+
+    // warm-up, so one-time initialization doesn't count against the first run
+    const auto expected = parseCorpus(corpus, 1, useSession);
+    printf("corpus: %d certificates, %lld parse successfully\n", (int)corpus.size(), (long long)expected);
+    printf("%8s %12s %14s %14s %10s\n", "threads", "parses", "parses/s", "parses/s/thr", "scaling");
+
+    // powers of two up to the maximum, and the maximum itself
+    std::vector<int> threadCounts;
+    for (int n = 1; n < maxThreads; n *= 2) {
+        threadCounts.push_back(n);
+    }
+    threadCounts.push_back(maxThreads);
+
+    double singleThreadRate = 0.0;
+    for (const auto threadCount : threadCounts) {
+        std::atomic<bool> mismatch = false;
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount);
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&]() {
+                // results must not depend on concurrently running parsers
+                if (parseCorpus(corpus, iterations, useSession) != expected * iterations) {
+                    mismatch = true;
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        const auto elapsed = std::max<qint64>(1, timer.nsecsElapsed());
+
+        const auto parses = (qint64)corpus.size() * iterations * threadCount;
+        const auto rate = parses * 1.0e9 / elapsed;
+        if (threadCount == 1) {
+            singleThreadRate = rate;
+        }
+        printf("%8d %12lld %14.1f %14.1f %9.0f%%\n", threadCount, (long long)parses, rate, rate / threadCount, 100.0 * rate / (singleThreadRate * threadCount));
+
+        if (mismatch) {
+            fprintf(stderr, "inconsistent results with %d threads!\n", threadCount);
+            return 1;
+        }
+    }
+
+    return 0;
+}